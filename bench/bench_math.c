@@ -0,0 +1,298 @@
+// Microbenchmarks for the math kernels in Vectors.c and matrix.c. Links no GL,
+// so it runs on headless machines.
+//
+//   bench_math            table of ns/op on stdout
+//   bench_math --json     the same results as JSON on stdout
+//   bench_math --quick    fewer trials and smaller arrays, for smoke tests
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L  // clock_gettime under strict C11
+#endif
+
+#include "matrix.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MAX_RESULTS 64
+
+typedef struct {
+    const char* name;
+    int count;          // Elements per call, 1 for single-value routines
+    double nsPerOp;     // Best trial, per element
+    double medianNs;    // Median trial, per element
+} BenchResult;
+
+static BenchResult results[MAX_RESULTS];
+static int resultCount = 0;
+static int trialCount = 15;
+
+// Results feed this so the compiler cannot drop the timed loops
+static volatile float sink;
+
+static double nowNs() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+static float randomFloat() {
+    return (float)rand() / (float)RAND_MAX * 4.0f - 2.0f;
+}
+
+static Vector3 randomVector() {
+    return vector(randomFloat(), randomFloat(), randomFloat());
+}
+
+static Matrix4x4 randomMatrix() {
+    Matrix4x4 m;
+    for (int i = 0; i < 16; i++) {
+        m.data[i / 4][i % 4] = randomFloat();
+    }
+    return m;
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// One benchmark body: performs `reps` calls over `count` elements each
+typedef void (*BenchFn)(int reps, int count);
+
+static void runBench(const char* name, BenchFn fn, int count, long long elementsPerTrial) {
+    int reps = (int)(elementsPerTrial / count);
+    if (reps < 1) reps = 1;
+
+    fn(reps > 16 ? 16 : reps, count);  // Warm caches and page in the arrays
+
+    double trials[64];
+    int trialsRun = trialCount < 64 ? trialCount : 64;
+    for (int t = 0; t < trialsRun; t++) {
+        double start = nowNs();
+        fn(reps, count);
+        trials[t] = (nowNs() - start) / ((double)reps * count);
+    }
+    qsort(trials, trialsRun, sizeof(double), compareDoubles);
+
+    if (resultCount < MAX_RESULTS) {
+        BenchResult* r = &results[resultCount++];
+        r->name = name;
+        r->count = count;
+        r->nsPerOp = trials[0];
+        r->medianNs = trials[trialsRun / 2];
+    }
+}
+
+// Inputs shared by the benchmarks, sized for the largest array
+static Matrix4x4 matrices[2];
+static Vector3* inputs;
+static Vector3* outputs;
+
+static void benchMatrixMultiply(int reps, int count) {
+    Matrix4x4 m = matrices[0];
+    for (int r = 0; r < reps; r++) {
+        m = matrixMultiply(m, matrices[1]);
+        m.data[3][3] = 1.0f;  // Keep the chain from overflowing
+    }
+    sink = m.data[0][0];
+    (void)count;
+}
+
+static void benchMatrixMultiplyInto(int reps, int count) {
+    Matrix4x4 m = matrices[0];
+    for (int r = 0; r < reps; r++) {
+        matrixMultiplyInto(&m, &matrices[1], &m);
+        m.data[3][3] = 1.0f;
+    }
+    sink = m.data[0][0];
+    (void)count;
+}
+
+static void benchLookAt(int reps, int count) {
+    float acc = 0.0f;
+    for (int r = 0; r < reps; r++) {
+        Matrix4x4 m = lookAt(inputs[r & 1023], vector(0.0f, 0.0f, 0.0f), vector(0.0f, 1.0f, 0.0f));
+        acc += m.data[3][2];
+    }
+    sink = acc;
+    (void)count;
+}
+
+static void benchRotateMatrix(int reps, int count) {
+    float acc = 0.0f;
+    for (int r = 0; r < reps; r++) {
+        Matrix4x4 m = rotateMatrix((float)(r & 359), inputs[r & 1023]);
+        acc += m.data[1][2];
+    }
+    sink = acc;
+    (void)count;
+}
+
+static void benchComposeTransform(int reps, int count) {
+    float acc = 0.0f;
+    for (int r = 0; r < reps; r++) {
+        Vector3 v = inputs[r & 1023];
+        Matrix4x4 m = composeTransform(v, vector_scale(v, 90.0f), vector(1.0f, 2.0f, 1.0f));
+        acc += m.data[3][0];
+    }
+    sink = acc;
+    (void)count;
+}
+
+static void benchVectorNormalize(int reps, int count) {
+    float acc = 0.0f;
+    for (int r = 0; r < reps; r++) {
+        acc += vector_normalize(inputs[r & 1023]).x;
+    }
+    sink = acc;
+    (void)count;
+}
+
+// Per-element calls through the single-value entry points, as a baseline
+static void benchTransformPointLoop(int reps, int count) {
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            outputs[i] = transformPoint(&matrices[0], inputs[i]);
+        }
+    }
+    sink = outputs[count - 1].x;
+}
+
+static void benchTransformPoints(int reps, int count) {
+    for (int r = 0; r < reps; r++) {
+        transformPoints(&matrices[0], inputs, outputs, count);
+    }
+    sink = outputs[count - 1].x;
+}
+
+static void benchTransformDirections(int reps, int count) {
+    for (int r = 0; r < reps; r++) {
+        transformDirections(&matrices[0], inputs, outputs, count);
+    }
+    sink = outputs[count - 1].x;
+}
+
+static void benchNormalizeLoop(int reps, int count) {
+    for (int r = 0; r < reps; r++) {
+        for (int i = 0; i < count; i++) {
+            outputs[i] = vector_normalize(inputs[i]);
+        }
+    }
+    sink = outputs[count - 1].x;
+}
+
+static void benchNormalizeArray(int reps, int count) {
+    for (int r = 0; r < reps; r++) {
+        vector_normalize_array(inputs, outputs, count);
+    }
+    sink = outputs[count - 1].x;
+}
+
+static void benchCrossArray(int reps, int count) {
+    for (int r = 0; r < reps; r++) {
+        vector_cross_array(inputs, inputs + 1, outputs, count);
+    }
+    sink = outputs[count - 1].x;
+}
+
+static const char* simdName() {
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+    return "sse+fma";
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
+static void printTable() {
+    printf("bench_math (%s kernels)\n", simdName());
+    printf("%-24s %10s %12s %12s\n", "benchmark", "elements", "best ns/op", "median ns/op");
+    for (int i = 0; i < resultCount; i++) {
+        printf("%-24s %10d %12.3f %12.3f\n", results[i].name, results[i].count, results[i].nsPerOp, results[i].medianNs);
+    }
+}
+
+static void printJson() {
+    printf("{\n  \"benchmark\": \"bench_math\",\n  \"simd\": \"%s\",\n  \"trials\": %d,\n  \"results\": [\n", simdName(), trialCount);
+    for (int i = 0; i < resultCount; i++) {
+        printf("    {\"name\": \"%s\", \"elements\": %d, \"ns_per_op\": %.4f, \"median_ns_per_op\": %.4f}%s\n",
+            results[i].name, results[i].count, results[i].nsPerOp, results[i].medianNs,
+            i + 1 < resultCount ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    bool quick = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) json = true;
+        else if (strcmp(argv[i], "--quick") == 0) quick = true;
+        else {
+            fprintf(stderr, "Usage: %s [--json] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const int sizes[] = { 16, 256, 4096, 65536, 1048576 };
+    int sizeCount = quick ? 3 : (int)(sizeof(sizes) / sizeof(sizes[0]));
+    long long elementsPerTrial = quick ? 100000 : 2000000;
+    if (quick) trialCount = 5;
+
+    int maxCount = sizes[sizeCount - 1] + 1;
+    if (maxCount < 1024) maxCount = 1024;
+    inputs = (Vector3*)malloc(maxCount * sizeof(Vector3));
+    outputs = (Vector3*)malloc(maxCount * sizeof(Vector3));
+    if (!inputs || !outputs) {
+        fprintf(stderr, "Failed to allocate benchmark arrays.\n");
+        return 1;
+    }
+
+    srand(1234);
+    for (int i = 0; i < maxCount; i++) {
+        inputs[i] = randomVector();
+    }
+    matrices[0] = randomMatrix();
+    matrices[1] = composeTransform(vector(1.0f, 2.0f, 3.0f), vector(10.0f, 20.0f, 30.0f), vector(1.0f, 1.0f, 1.0f));
+
+    runBench("matrixMultiply", benchMatrixMultiply, 1, elementsPerTrial);
+    runBench("matrixMultiplyInto", benchMatrixMultiplyInto, 1, elementsPerTrial);
+    runBench("lookAt", benchLookAt, 1, elementsPerTrial);
+    runBench("rotateMatrix", benchRotateMatrix, 1, elementsPerTrial);
+    runBench("composeTransform", benchComposeTransform, 1, elementsPerTrial);
+    runBench("vector_normalize", benchVectorNormalize, 1, elementsPerTrial);
+
+    for (int s = 0; s < sizeCount; s++) {
+        int count = sizes[s];
+        runBench("transformPoint_loop", benchTransformPointLoop, count, elementsPerTrial);
+        runBench("transformPoints", benchTransformPoints, count, elementsPerTrial);
+        runBench("transformDirections", benchTransformDirections, count, elementsPerTrial);
+        runBench("vector_normalize_loop", benchNormalizeLoop, count, elementsPerTrial);
+        runBench("vector_normalize_array", benchNormalizeArray, count, elementsPerTrial);
+        runBench("vector_cross_array", benchCrossArray, count, elementsPerTrial);
+    }
+
+    if (json) printJson();
+    else printTable();
+
+    free(inputs);
+    free(outputs);
+    return 0;
+}
@@ -0,0 +1,437 @@
+// Scripted render benchmark. Renders a scene headless along a fixed camera
+// path and reports per-frame timings, so runs can be compared between builds.
+// There is no window, so vsync never throttles a frame.
+//
+//   bench_render [options]
+//     --scene project.json   scene written by save_project (default: generated grid)
+//     --grid N               N x N objects in the generated scene (default 16)
+//     --frames N             measured frames (default 600)
+//     --warmup N             unmeasured frames first (default 30)
+//     --size WxH             framebuffer size (default 1280x720)
+//     --csv path             per-frame results as CSV
+//     --json path            summary and per-frame results as JSON
+//     --trace path           Chrome trace of the CPU scopes in the last frames
+//     --no-pipeline          build each frame's draw lists before drawing it
+//     --depth-prepass        lay down opaque depth before shading
+//     --deferred             shade opaque objects through the G-buffer
+//     --governor MS          let the frame budget governor hold MS per frame
+//
+// The camera position depends only on the frame index, never on elapsed time.
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L  // clock_gettime under strict C11
+#endif
+
+#include "rendering.h"
+#include "globals.h"
+#include "Screen.h"
+#include "ObjectManager.h"
+#include "file_operations.h"
+#include "resource_loader.h"
+#include "materials.h"
+#include "lightshading.h"
+#include "background.h"
+#include "glstate.h"
+#include "gputimers.h"
+#include "profiler.h"
+#include "jobs.h"
+#include "governor.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+typedef struct {
+    double cpuMs;      // Submitting the frame: render() on the calling thread
+    double gpuMs;      // Sum of the timed passes (gputimers.h), negative when unresolved
+    double gpuPassMs[GPU_PASS_COUNT];
+    double frameMs;    // Submission plus waiting for the GPU to finish
+    unsigned int drawCalls;
+    unsigned int triangles;
+    int visible;
+    float renderScale;
+} FrameSample;
+
+typedef struct {
+    double mean, min, max, p50, p95, p99;
+} Summary;
+
+// cpu, gpu, one per GPU pass, frame
+#define MAX_SUMMARIES (3 + GPU_PASS_COUNT)
+
+typedef struct {
+    char name[32];
+    Summary summary;
+} NamedSummary;
+
+static double nowMs() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e3 / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+#endif
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentiles over the samples at the given field offset
+static Summary summarize(const FrameSample* samples, int count, size_t field) {
+    Summary s = { 0 };
+    double* values = (double*)malloc(count * sizeof(double));
+    if (!values || count == 0) {
+        free(values);
+        return s;
+    }
+    for (int i = 0; i < count; i++) {
+        values[i] = *(const double*)((const char*)&samples[i] + field);
+        s.mean += values[i];
+    }
+    qsort(values, count, sizeof(double), compareDoubles);
+    s.mean /= count;
+    s.min = values[0];
+    s.max = values[count - 1];
+    s.p50 = values[(int)ceil(0.50 * count) - 1];
+    s.p95 = values[(int)ceil(0.95 * count) - 1];
+    s.p99 = values[(int)ceil(0.99 * count) - 1];
+    free(values);
+    return s;
+}
+
+// Same hash for the same index, so generated scenes match between runs
+static float hashUnit(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return (float)(x & 0xffffff) / (float)0xffffff;
+}
+
+static void createGridScene(int gridSize) {
+    static const ObjectType types[] = { OBJ_CUBE, OBJ_SPHERE, OBJ_PYRAMID, OBJ_CYLINDER };
+    PBRMaterial material = *getMaterial("peacockOre");
+    float spacing = 2.5f;
+    float offset = (gridSize - 1) * spacing * 0.5f;
+
+    int ground = getObjectIndex(addObject(&camera, OBJ_PLANE, false, 0, true, NULL, material, false));
+    if (ground >= 0) {
+        objectManager.objects[ground].position = vector(0.0f, 0.0f, 0.0f);
+        syncObject(ground);
+    }
+
+    for (int z = 0; z < gridSize; z++) {
+        for (int x = 0; x < gridSize; x++) {
+            unsigned int id = (unsigned int)(z * gridSize + x);
+            ObjectType type = types[id % 4];
+            // Every fourth object is PBR so both shading paths get measured
+            bool pbr = (id / 4) % 4 == 0;
+            int index = getObjectIndex(addObject(&camera, type, false, 0, true, NULL, material, pbr));
+            if (index < 0) continue;
+
+            SceneObject* object = &objectManager.objects[index];
+            object->position = vector(x * spacing - offset, 1.0f, z * spacing - offset);
+            object->rotation = vector(0.0f, hashUnit(id) * 360.0f, 0.0f);
+            object->color = (Vector4){ 0.3f + 0.7f * hashUnit(id * 3 + 1), 0.3f + 0.7f * hashUnit(id * 3 + 2),
+                0.3f + 0.7f * hashUnit(id * 3 + 3), 1.0f };
+            syncObject(index);
+        }
+    }
+
+    int lights = gridSize < 4 ? 1 : gridSize / 2;
+    for (int i = 0; i < lights; i++) {
+        Vector3 position = vector((hashUnit(1000 + i) * 2.0f - 1.0f) * offset, 3.0f,
+            (hashUnit(2000 + i) * 2.0f - 1.0f) * offset);
+        Vector3 color = vector(0.5f + 0.5f * hashUnit(3000 + i), 0.5f + 0.5f * hashUnit(4000 + i), 0.5f + 0.5f * hashUnit(5000 + i));
+        createLight(position, vector(0.0f, -1.0f, 0.0f), color, 1.5f, LIGHT_POINT);
+    }
+}
+
+// Planes are left out: they span far beyond the objects standing on them
+static AABB sceneBounds() {
+    updateTransforms();
+    AABB bounds = emptyAABB();
+    for (int i = 0; i < objectManager.count; i++) {
+        if (objectManager.renderStates[i].type == OBJ_PLANE) continue;
+        bounds = mergeAABB(bounds, objectManager.worldBounds[i]);
+    }
+    if (isAABBEmpty(bounds)) {
+        bounds = makeAABB(vector(-1.0f, -1.0f, -1.0f), vector(1.0f, 1.0f, 1.0f));
+    }
+    return bounds;
+}
+
+// One orbit around the scene while dollying in and out twice, so objects
+// cross LOD thresholds and leave and re-enter the frustum
+static void placeCamera(AABB bounds, int frame, int frameCount) {
+    float t = (float)frame / (float)frameCount;
+    Vector3 center = aabbCenter(bounds);
+    float radius = vector_length(aabbExtents(bounds));
+    float angle = t * 2.0f * (float)M_PI;
+    float distance = radius * (0.6f + 0.5f * sinf(2.0f * angle));
+    float height = radius * (0.25f + 0.15f * sinf(3.0f * angle));
+
+    camera.Position = vector(center.x + cosf(angle) * distance, center.y + height, center.z + sinf(angle) * distance);
+    Vector3 toCenter = vector_normalize(vector_sub(center, camera.Position));
+    camera.Yaw = atan2f(toCenter.z, toCenter.x) * 180.0f / (float)M_PI;
+    camera.Pitch = asinf(toCenter.y) * 180.0f / (float)M_PI;
+    updateCameraVectors(&camera);
+}
+
+static void printSummaryRow(const char* name, Summary s) {
+    printf("%-16s %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, s.mean, s.min, s.p50, s.p95, s.p99, s.max);
+}
+
+static bool writeCsv(const char* path, const FrameSample* samples, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        return false;
+    }
+    fprintf(file, "frame,cpu_ms,gpu_ms,frame_ms,draw_calls,triangles,visible,render_scale");
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+        fprintf(file, ",gpu_%s_ms", gpuPassNames[pass]);
+    }
+    fprintf(file, "\n");
+    for (int i = 0; i < count; i++) {
+        const FrameSample* s = &samples[i];
+        fprintf(file, "%d,%.4f,%.4f,%.4f,%u,%u,%d,%.2f", i, s->cpuMs, s->gpuMs, s->frameMs, s->drawCalls, s->triangles,
+            s->visible, s->renderScale);
+        for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+            fprintf(file, ",%.4f", s->gpuPassMs[pass]);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    return true;
+}
+
+// Paths may contain backslashes on Windows
+static void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+static void writeJsonSummary(FILE* file, const char* name, Summary s, bool last) {
+    fprintf(file, "    \"%s_ms\": {\"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+        name, s.mean, s.min, s.p50, s.p95, s.p99, s.max, last ? "" : ",");
+}
+
+static bool writeJson(const char* path, const char* scene, const FrameSample* samples, int count,
+    const NamedSummary* summaries, int summaryCount) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        return false;
+    }
+    fprintf(file, "{\n  \"benchmark\": \"bench_render\",\n  \"scene\": ");
+    writeJsonString(file, scene);
+    fprintf(file, ",\n  \"renderer\": ");
+    writeJsonString(file, (const char*)glGetString(GL_RENDERER));
+    fprintf(file, ",\n");
+    fprintf(file, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n", screen.width, screen.height, count);
+    fprintf(file, "  \"summary\": {\n");
+    for (int i = 0; i < summaryCount; i++) {
+        writeJsonSummary(file, summaries[i].name, summaries[i].summary, i + 1 == summaryCount);
+    }
+    fprintf(file, "  },\n  \"samples\": [\n");
+    for (int i = 0; i < count; i++) {
+        const FrameSample* s = &samples[i];
+        fprintf(file, "    {\"cpu_ms\": %.4f, \"gpu_ms\": %.4f, \"frame_ms\": %.4f, \"draw_calls\": %u, \"triangles\": %u, \"visible\": %d, \"render_scale\": %.2f",
+            s->cpuMs, s->gpuMs, s->frameMs, s->drawCalls, s->triangles, s->visible, s->renderScale);
+        for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+            fprintf(file, ", \"gpu_%s_ms\": %.4f", gpuPassNames[pass], s->gpuPassMs[pass]);
+        }
+        fprintf(file, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "Usage: %s [--scene project.json] [--grid N] [--frames N] [--warmup N] [--size WxH] [--csv path] [--json path] [--trace path] [--no-pipeline] [--depth-prepass] [--deferred] [--governor ms]\n", program);
+}
+
+int main(int argc, char** argv) {
+    const char* scenePath = NULL;
+    const char* csvPath = NULL;
+    const char* jsonPath = NULL;
+    const char* tracePath = NULL;
+    int gridSize = 16;
+    int frameCount = 600;
+    int warmupCount = 30;
+    int width = 1280;
+    int height = 720;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--scene") == 0 && hasValue) scenePath = argv[++i];
+        else if (strcmp(argv[i], "--grid") == 0 && hasValue) gridSize = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue) frameCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue) warmupCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--csv") == 0 && hasValue) csvPath = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && hasValue) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue) tracePath = argv[++i];
+        else if (strcmp(argv[i], "--no-pipeline") == 0) pipelineEnabled = false;
+        else if (strcmp(argv[i], "--depth-prepass") == 0) depthPrepassEnabled = true;
+        else if (strcmp(argv[i], "--deferred") == 0) deferredEnabled = true;
+        else if (strcmp(argv[i], "--governor") == 0 && hasValue) {
+            governorEnabled = true;
+            governorTargetMs = (float)atof(argv[++i]);
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (gridSize < 1 || frameCount < 1 || warmupCount < 0 || width <= 0 || height <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    srand(1234);
+    initProfiler();
+    if (!setupHeadless(width, height)) {
+        shutdownProfiler();
+        return 1;
+    }
+    load_texture();
+    load_material();
+    initSkybox(1);
+    initLightingSystem();
+
+    if (scenePath) {
+        if (!load_project_from_file(scenePath)) {
+            end();
+            return 1;
+        }
+    }
+    else {
+        createGridScene(gridSize);
+    }
+    AABB bounds = sceneBounds();
+
+    FrameSample* samples = (FrameSample*)calloc(frameCount, sizeof(FrameSample));
+    if (!samples) {
+        fprintf(stderr, "Failed to allocate %d frame samples\n", frameCount);
+        end();
+        return 1;
+    }
+
+    printf("bench_render: %s, %d objects, %dx%d, %d frames (+%d warmup) on %s, %d job workers%s%s%s%s\n",
+        scenePath ? scenePath : "generated grid", objectManager.count, width, height,
+        frameCount, warmupCount, (const char*)glGetString(GL_RENDERER), getJobWorkerCount(),
+        pipelineEnabled && getJobWorkerCount() > 0 ? ", pipelined" : "",
+        depthPrepassEnabled ? ", depth pre-pass" : "",
+        deferredEnabled ? ", deferred" : "",
+        governorEnabled ? ", governed" : "");
+
+    for (int frame = -warmupCount; frame < frameCount; frame++) {
+        int pathFrame = frame < 0 ? frame + frameCount : frame;
+        placeCamera(bounds, pathFrame, frameCount);
+
+        profilerBeginFrame();
+        PROFILE_BEGIN("frame");
+        double start = nowMs();
+        render();
+        double submitted = nowMs();
+        PROFILE_BEGIN("finish");
+        glFinish();
+        PROFILE_END();
+        double finished = nowMs();
+        PROFILE_END();
+        float renderScale = getRenderScale();
+        updateGovernor((float)(finished - start));
+        // The frame has finished, so its pass timers resolve without waiting
+        unsigned int resolvedBefore = getGpuTimerStats().framesResolved;
+        collectGpuTimers();
+        GpuTimerStats gpuStats = getGpuTimerStats();
+
+        if (frame < 0) continue;
+        FrameSample* sample = &samples[frame];
+        sample->cpuMs = submitted - start;
+        sample->frameMs = finished - start;
+        sample->gpuMs = -1.0;
+        if (gpuStats.framesResolved != resolvedBefore) {
+            sample->gpuMs = gpuStats.lastTotalMs;
+            for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+                sample->gpuPassMs[pass] = gpuStats.lastMs[pass];
+            }
+        }
+        // Stats roll over at the start of the next frame, so read them from the current one by hand
+        beginStateFrame();
+        GLStateStats stats = getStateStats();
+        sample->drawCalls = stats.drawCalls;
+        sample->triangles = stats.triangles;
+        sample->visible = getCullStats().visible;
+        sample->renderScale = renderScale;
+    }
+
+    NamedSummary summaries[MAX_SUMMARIES];
+    int summaryCount = 0;
+    snprintf(summaries[summaryCount].name, sizeof(summaries[0].name), "cpu");
+    summaries[summaryCount++].summary = summarize(samples, frameCount, offsetof(FrameSample, cpuMs));
+    // Left out when any frame's timers failed to resolve
+    bool gpuTimed = true;
+    for (int i = 0; i < frameCount; i++) {
+        if (samples[i].gpuMs < 0.0) gpuTimed = false;
+    }
+    if (gpuTimed) {
+        snprintf(summaries[summaryCount].name, sizeof(summaries[0].name), "gpu");
+        summaries[summaryCount++].summary = summarize(samples, frameCount, offsetof(FrameSample, gpuMs));
+        for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+            snprintf(summaries[summaryCount].name, sizeof(summaries[0].name), "gpu_%s", gpuPassNames[pass]);
+            summaries[summaryCount++].summary = summarize(samples, frameCount,
+                offsetof(FrameSample, gpuPassMs) + pass * sizeof(double));
+        }
+    }
+    snprintf(summaries[summaryCount].name, sizeof(summaries[0].name), "frame");
+    summaries[summaryCount++].summary = summarize(samples, frameCount, offsetof(FrameSample, frameMs));
+
+    printf("%-16s %9s %9s %9s %9s %9s %9s\n", "ms", "mean", "min", "p50", "p95", "p99", "max");
+    for (int i = 0; i < summaryCount; i++) {
+        printSummaryRow(summaries[i].name, summaries[i].summary);
+    }
+    if (governorEnabled) {
+        printf("governor: %.1f ms target, ended at level %d (render scale %.2f, detail %.2f)\n",
+            governorTargetMs, getGovernorLevel(), getRenderScale(), getLODDetailScale());
+    }
+
+    int status = 0;
+    if (csvPath && !writeCsv(csvPath, samples, frameCount)) status = 1;
+    if (jsonPath && !writeJson(jsonPath, scenePath ? scenePath : "grid", samples, frameCount, summaries, summaryCount)) status = 1;
+    if (tracePath && !writeChromeTrace(tracePath)) status = 1;
+
+    free(samples);
+    cleanupObjects();
+    end();
+    shutdownProfiler();
+    return status;
+}
@@ -3,12 +3,15 @@
 #include <GLFW/glfw3.h>
 #include <stdbool.h>
 #include "Vectors.h"
+#include "bounds.h"
+#include "lod.h"
 typedef struct {
     GLuint vao; // Vertex Array Object ID
     GLuint vbo; // Vertex Buffer Object ID
     GLuint ebo; // Element Buffer Object ID
     Vector3 position; // Position of the cube
     Vector4 color;     // Color of the cube
+    AABB bounds;       // Local-space bounds
 } Cube;
 
 
@@ -28,6 +31,8 @@ typedef struct {
     SphereSettings settings;  
     int numVertices;
     int numIndices;
+    AABB bounds;
+    LODChain lods;  // Coarser tessellations packed after the full-detail sphere
 } Sphere;
 
 typedef struct {
@@ -36,6 +41,7 @@ typedef struct {
     GLuint ebo; 
     Vector3 position; 
     Vector4 color;    
+    AABB bounds;
 } Pyramid;
 
 typedef struct {
@@ -47,6 +53,8 @@ typedef struct {
     float radius;
     float height;
     int sectorCount;
+    AABB bounds;
+    LODChain lods;  // Fewer sectors per level, packed after the full-detail cylinder
 } Cylinder;
 
 typedef struct {
@@ -55,30 +63,31 @@ typedef struct {
     GLuint ebo; // Element Buffer Object ID
     Vector3 position; // Position of the plane
     Vector4 color;    // Color of the plane
+    AABB bounds;      // Local-space bounds
 } Plane;
 
 
 // Cube
 Cube createCube(Vector3 position, Vector4 color, float size);
-void drawCube(const Cube* cube, Matrix4x4 viewMatrix, Matrix4x4 projMatrix);
+void drawCube(const Cube* cube);
 void destroyCube(Cube* cube);
 
 // Sphere
 Sphere createSphere(float radius, int sectorCount, int stackCount, Vector3 position, Vector4 color);
-void drawSphere(const Sphere* sphere, Matrix4x4 viewMatrix, Matrix4x4 projMatrix);
+void drawSphere(const Sphere* sphere);
 void destroySphere(Sphere* sphere);
 
 // Pyramid
 Pyramid createPyramid(Vector3 position, Vector4 color, float baseSize, float height);
-void drawPyramid(const Pyramid* pyramid, Matrix4x4 viewMatrix, Matrix4x4 projMatrix);
+void drawPyramid(const Pyramid* pyramid);
 void destroyPyramid(Pyramid* pyramid);
 
 // Cylinder
 Cylinder createCylinder(float radius, float height, int sectorCount, Vector3 position, Vector4 color);
-void drawCylinder(const Cylinder* cylinder, Matrix4x4 viewMatrix, Matrix4x4 projMatrix);
+void drawCylinder(const Cylinder* cylinder);
 void destroyCylinder(Cylinder* cylinder);
 
 // Plane
 Plane createPlane(Vector3 position, Vector4 color);
-void drawPlane(const Plane* plane, Matrix4x4 viewMatrix, Matrix4x4 projMatrix);
+void drawPlane(const Plane* plane);
 void destroyPlane(Plane* plane);
\ No newline at end of file
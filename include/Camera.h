@@ -2,6 +2,7 @@
 #define CAMERA_H
 
 #include "Vectors.h"
+#include "matrix.h"
 #include <stdbool.h>
 #include "types.h"
 #include <glad/glad.h>  
@@ -52,11 +53,4 @@ void processMouseScroll(Camera* camera, float yoffset);
 void processMousePan(Camera* camera, float xoffset, float yoffset);
 Matrix4x4 getViewMatrix(Camera* camera);
 Matrix4x4 getProjectionMatrix(float fov, float aspectRatio, float nearPlane, float farPlane);
-Matrix4x4 translateMatrix(Vector3 position);
-Matrix4x4 matrixMultiply(Matrix4x4 a, Matrix4x4 b);
-Matrix4x4 lookAt(Vector3 eye, Vector3 center, Vector3 up);
-Matrix4x4 perspective(float fov, float aspect, float znear, float zfar);
-Matrix4x4 rotateMatrix(float angle, Vector3 axis);
-Matrix4x4 scaleMatrix(Vector3 scale);
-Matrix4x4 identityMatrix();
 #endif 
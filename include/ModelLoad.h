@@ -2,6 +2,9 @@
 #define MODELLOAD_H
 
 #include "Vectors.h"
+#include "bounds.h"
+#include "meshbvh.h"
+#include "lod.h"
 #include <assimp/cimport.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -10,24 +13,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// Post-processing applied by loadModel
+#define MODEL_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_FlipUVs)
+
 typedef struct {
     GLuint VAO;
     GLuint VBO;
     GLuint EBO;
     Vertex* vertices;
-    unsigned int* indices;
+    unsigned int* indices;   // Full detail first, then the simplified levels
     unsigned int numVertices;
-    unsigned int numIndices;
+    unsigned int numIndices; // Full detail only
+    AABB bounds;  // Local-space bounds of the vertex positions
+    Vector3* positions;  // CPU copy of the positions, kept for picking
+    MeshBVH bvh;         // Triangle hierarchy over positions/indices
+    LODChain lods;       // Ranges of indices, all drawn through VAO
 } Mesh;
 
 typedef struct {
     Mesh* meshes;
     unsigned int meshCount;
     char path[256];
+    AABB bounds;  // Union of the mesh bounds
 } Model;
 
 Mesh processMesh(struct aiMesh* mesh, const struct aiScene* scene);
 Model* loadModel(const char* path);
+Model* loadModelWithFlags(const char* path, unsigned int importFlags);
 void freeModel(Model* model);
 
 #endif 
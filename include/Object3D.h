@@ -32,6 +32,7 @@ typedef struct {
     bool useLighting;
     PBRMaterial material;
     bool usePBR;
+    int geometry;  // Registry handle the data above was taken from
 } Object3D;
 
 #endif 
@@ -7,23 +7,80 @@
 #include "materials.h"
 #include "Vectors.h"
 #include "SceneObject.h"
+#include "spatial.h"
 
-#define MAX_OBJECTS 1000 
+// Bits of ObjectRenderState.flags
+#define OBJECT_FLAG_TEXTURE (1u << 0)
+#define OBJECT_FLAG_COLOR   (1u << 1)
+#define OBJECT_FLAG_PBR     (1u << 2)
 
+// What the render loop needs to sort, batch and draw an object
 typedef struct {
-    SceneObject objects[MAX_OBJECTS];
+    GLuint vao;           // First vertex array, used for sorting and batching
+    GLuint textureID;
+    int indexCount;       // 0 for models, which draw mesh by mesh
+    unsigned char type;   // ObjectType
+    unsigned char flags;  // OBJECT_FLAG_*
+    unsigned char lodCount;  // Detail levels the geometry has, at least 1
+} ObjectRenderState;
+
+// Objects are stored as parallel arrays sharing one dense index. SceneObject keeps
+// the editor-facing record; the other arrays are dense copies of the data the
+// per-frame loops read, re-derived by syncObject() whenever the record changes.
+// Removal swaps the last object into the hole, so dense indices are only valid
+// until the next removal; anything kept across frames should hold a handle.
+typedef struct {
+    SceneObject* objects;             // Editor metadata: names, geometry, full materials
+    ObjectHandle* handles;
+    Matrix4x4* worldMatrices;         // Parent's world matrix times the local transform
+    Matrix3x3* normalMatrices;        // Inverse transpose of the world matrix
+    AABB* worldBounds;                // Local bounds after the world matrix
+    unsigned char* transformDirty;    // World data is stale until updateTransforms()
+    ObjectRenderState* renderStates;
+    Vector4* colors;
+    int* materialRefs;                // Index into materials[], -1 when unregistered
+    unsigned char* lodLevels;         // Detail level drawn last frame, 0 is full detail
     int count;
     int capacity;
+    unsigned int revision;            // Bumped by every removal, which can move dense indices
+
+    // Objects whose world transform needs recomposing, with their descendants
+    ObjectHandle* dirtyObjects;
+    int dirtyCount;
+    int dirtyCapacity;
+
+    // Handle slot -> dense index map
+    int* slotIndices;                 // -1 while the slot is free
+    unsigned int* slotGenerations;
+    int* freeSlots;
+    int freeSlotCount;
+    int slotCount;
+    int slotCapacity;
 } ObjectManager;
 
 extern ObjectManager objectManager;
+extern SpatialTree sceneTree;
 
 void initObjectManager();
-void addObjectToManager(SceneObject newObject);
-void addObject(Camera* camera, ObjectType type, bool useTexture, int textureIndex, bool colorCreation, Model* model, PBRMaterial material, bool usePBR);
+ObjectHandle addObjectToManager(SceneObject newObject);
+ObjectHandle addObject(Camera* camera, ObjectType type, bool useTexture, int textureIndex, bool colorCreation, Model* model, PBRMaterial material, bool usePBR);
 void removeObject(int index);
 void cleanupObjects();
-void updateObjectInManager(SceneObject* updatedObject);
-void drawObject(const SceneObject* obj, const Matrix4x4 viewMatrix, const Matrix4x4 projMatrix);
+void removeObjectByHandle(ObjectHandle handle);
+void updateObjectInManager(const SceneObject* updatedObject);
+int getObjectIndex(ObjectHandle handle);
+SceneObject* getObject(ObjectHandle handle);
+void syncObject(int index);
+void updateTransforms();
+bool setObjectParent(ObjectHandle child, ObjectHandle parent);
+int findObjectsInBox(AABB box, int* indices, int maxCount);
+int findObjectsNear(Vector3 point, float radius, int* indices, int maxCount);
+GLuint getObjectVAO(const SceneObject* obj);
+AABB getObjectLocalBounds(const SceneObject* obj);
+const LODChain* getObjectLODChain(const SceneObject* obj);
+Matrix4x4 getObjectModelMatrix(const SceneObject* obj);
+void drawObject(int index);
+// Draws with the given transform and detail level instead of the stored ones
+void drawObjectAt(int index, const Matrix4x4* world, const Matrix3x3* normal, int lod);
 
 #endif 
\ No newline at end of file
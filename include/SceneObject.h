@@ -5,6 +5,14 @@
 #include "Vectors.h"
 #include "materials.h"
 #include "Object3D.h"
+#include <stdint.h>
+
+// Stable reference to a scene object: slot in the low 32 bits, generation in the
+// high 32. Removing an object bumps its slot's generation, so stale handles
+// resolve to nothing instead of whichever object moved into the slot. Zero is
+// never issued.
+typedef uint64_t ObjectHandle;
+#define INVALID_OBJECT_HANDLE 0
 
 typedef struct SceneObject {
     Object3D object;  // Base object
@@ -14,6 +22,11 @@ typedef struct SceneObject {
     Vector4 color;    // Color of the object
     bool selected;    // Selection flag
     int id;           // Unique ID
+    ObjectHandle handle; // Assigned by the object manager
+    ObjectHandle parent; // Position, rotation and scale are relative to this object
+    ObjectHandle firstChild;  // Child links, maintained by setObjectParent
+    ObjectHandle nextSibling;
+    int proxy;        // Leaf in the scene's spatial tree
 } SceneObject;
 
 #endif 
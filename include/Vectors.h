@@ -18,6 +18,10 @@ typedef struct {
 	float data[4][4];
 } Matrix4x4;
 
+typedef struct {
+	float data[3][3]; // Column-major like Matrix4x4
+} Matrix3x3;
+
 typedef struct {
 	float position[3]; // x, y, z
 	float normal[3];   // nx, ny, nz
@@ -45,4 +49,11 @@ Vector3 vector_negate(Vector3 v);
 
 Vector3 reflect(Vector3 I, Vector3 N);
 
-float vector_length(Vector3 v);
\ No newline at end of file
+float vector_length(Vector3 v);
+
+// Batched variants over arrays of count elements; out may alias an input
+void vector_normalize_array(const Vector3* in, Vector3* out, int count);
+
+void vector_dot_array(const Vector3* a, const Vector3* b, float* out, int count);
+
+void vector_cross_array(const Vector3* a, const Vector3* b, Vector3* out, int count);
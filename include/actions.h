@@ -17,17 +17,20 @@ typedef struct {
     ActionType type;
     SceneObject previousState;
     SceneObject newState;
-    int objectIndex;
+    ObjectHandle object;  // Re-pointed when undo or redo re-creates the object
     char description[256];
 } Action;
 
 extern Action actionHistory[MAX_ACTIONS];
 extern int historyCount;
 
-void pushUndoAction(Action action);
+// Pushes return false when the stack is full and the action was dropped
+bool pushUndoAction(Action action);
 Action popUndoAction();
-void pushRedoAction(Action action);
+bool pushRedoAction(Action action);
 Action popRedoAction();
+// Drops both stacks, releasing the geometry their snapshots hold
+void clearActionStacks();
 void addToHistory(Action action);
 void undo_last_action();
 void redo_last_action();
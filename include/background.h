@@ -9,7 +9,7 @@ extern Matrix4x4 projMatrix;  // If the projMatrix is globally accessible
 extern const char* backgroundNames[];
 extern const int backgroundCount;
 void initSkybox(int skyboxIndex);
-void drawSkybox(const Camera* camera, const Matrix4x4* projMatrix);
+void drawSkybox();
 GLuint loadCubemap(const char* faceFiles[6]);
 
 #endif
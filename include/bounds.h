@@ -0,0 +1,30 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <stdbool.h>
+#include "Vectors.h"
+
+// Axis-aligned bounding box
+typedef struct {
+    Vector3 min;
+    Vector3 max;
+} AABB;
+
+typedef struct {
+    Vector3 origin;
+    Vector3 direction;     // Not required to be normalized; hit distances are in units of it
+    Vector3 invDirection;  // Component-wise reciprocal, for slab tests
+} Ray;
+
+AABB emptyAABB();
+AABB makeAABB(Vector3 min, Vector3 max);
+bool isAABBEmpty(AABB box);
+void expandAABB(AABB* box, Vector3 point);
+AABB mergeAABB(AABB a, AABB b);
+AABB transformAABB(AABB box, const Matrix4x4* transform);
+Vector3 aabbCenter(AABB box);
+Vector3 aabbExtents(AABB box);
+Ray makeRay(Vector3 origin, Vector3 direction);
+bool intersectRayAABB(const Ray* ray, AABB box, float maxDistance, float* hitDistance);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "Vectors.h"
+#include "bounds.h"
+
+// Plane equations (xyz = normal pointing inside, w = distance), normalized
+typedef struct {
+    Vector4 planes[6];
+} Frustum;
+
+// World-space boxes as center/extents in structure-of-arrays layout, so the
+// frustum test can load four or eight boxes per instruction
+typedef struct {
+    float* centerX;
+    float* centerY;
+    float* centerZ;
+    float* extentX;
+    float* extentY;
+    float* extentZ;
+    int count;
+    int capacity;
+} BoundsSoA;
+
+typedef enum {
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECTS,
+    FRUSTUM_INSIDE
+} FrustumTest;
+
+typedef struct {
+    int tested;
+    int visible;
+} CullStats;
+
+Frustum extractFrustum(const Matrix4x4* viewProj);
+FrustumTest classifyAABB(const Frustum* frustum, AABB box);
+void reserveBoundsSoA(BoundsSoA* bounds, int capacity);
+void freeBoundsSoA(BoundsSoA* bounds);
+void setBoundsSoA(BoundsSoA* bounds, int index, AABB box);
+int cullBounds(const Frustum* frustum, const BoundsSoA* bounds, unsigned char* visible);
+
+#endif
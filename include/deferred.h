@@ -0,0 +1,36 @@
+#ifndef DEFERRED_H
+#define DEFERRED_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+
+// Deferred shading for opaque objects. The object shader writes surface
+// attributes into a G-buffer instead of lighting them, then one fullscreen
+// pass lights every covered pixel with the lights of its cluster. Lighting
+// then costs per lit pixel, not per object and light.
+//
+// G-buffer layout:
+//   albedo    RGBA8    base color, ambient occlusion already applied
+//   normal    RGBA16F  xyz unit normal
+//   material  RGBA8    metallic, roughness, ambient occlusion (as the forward path lights them)
+//   depth     D24S8    view position is rebuilt from it
+
+// Texture units the lighting shader samples the G-buffer from
+#define DEFERRED_UNIT_ALBEDO 0
+#define DEFERRED_UNIT_NORMAL 1
+#define DEFERRED_UNIT_MATERIAL 2
+#define DEFERRED_UNIT_DEPTH 3
+
+bool initDeferred();
+void cleanupDeferred();
+
+// Sizes the G-buffer to the scene, clears it and binds it for drawing.
+// Returns false when it is unusable; the caller should draw forward instead.
+bool beginGBufferPass(int width, int height);
+
+// Back on the scene framebuffer: copies the G-buffer depth over, so later
+// passes test against the opaque surfaces, and lights every covered pixel
+void endGBufferPass();
+
+#endif
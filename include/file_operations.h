@@ -1,9 +1,11 @@
 #ifndef FILE_OPERATIONS_H
 #define FILE_OPERATIONS_H
+#include <stdbool.h>
 #include "cJSON/cJSON.h"
 #include "file_operations/tinyfiledialogs.h"
 void save_project();
 void load_project();
+bool load_project_from_file(const char* path);
 void new_project();
 
 #ifdef __cplusplus
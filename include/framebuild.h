@@ -0,0 +1,66 @@
+#ifndef FRAMEBUILD_H
+#define FRAMEBUILD_H
+
+#include "Vectors.h"
+#include "culling.h"
+#include "renderqueue.h"
+#include "instancing.h"
+#include <stdbool.h>
+
+// Candidates handed to one job while building
+#define FRAME_BUILD_CHUNK 512
+
+// Transparent draw with its camera distance, sorted farthest first when the
+// build is for the sorted fallback. The OIT pass draws them in any order.
+typedef struct {
+    int object;
+    float distance;
+} TransparentDraw;
+
+// Everything submission needs for one frame, built from the scene as it was
+// when the build started. Per-object arrays are indexed by dense object index
+// and only filled for the objects that made it into a queue, so they stay
+// valid while the scene changes, up to the next object removal.
+typedef struct {
+    // Set by the caller before startFrameBuild
+    Matrix4x4 view;
+    Matrix4x4 projection;
+    Vector3 eye;
+    Vector3 front;
+    float nearPlane;
+    float farPlane;
+    float lodScale;               // Scales projected sizes for LOD selection, 1 for full detail
+    bool sortTransparent;         // The sorted fallback draws this build; OIT skips distances and sorting
+
+    RenderQueue opaque;
+    TransparentDraw* transparent;
+    int transparentCount;
+    int transparentCapacity;
+    InstanceData* instances;      // World and normal matrices and color
+    unsigned char* lodLevels;
+    int objectCapacity;
+    CullStats cullStats;
+    unsigned int revision;        // objectManager.revision the indices belong to
+    bool ready;
+
+    // Working set of the build
+    BoundsSoA bounds;
+    int* candidates;
+    unsigned char* visible;
+    unsigned char* queued;        // FRAME_QUEUE_* per candidate
+    uint64_t* keys;               // Opaque sort keys
+    float* distances;             // Transparent camera distances, only with sortTransparent
+    int candidateCount;
+    int candidateCapacity;
+} FrameBuild;
+
+// Culls, picks detail levels and fills and sorts both queues on the job
+// workers. Transforms must be up to date, and the scene must not change until
+// finishFrameBuild returns.
+void startFrameBuild(FrameBuild* build);
+void finishFrameBuild(FrameBuild* build);
+// False once an object removal may have moved the build's object indices
+bool isFrameBuildCurrent(const FrameBuild* build);
+void freeFrameBuild(FrameBuild* build);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdbool.h>
+#include "Object3D.h"
+
+#define INVALID_GEOMETRY -1
+
+// Parameters that identify a generated primitive mesh
+typedef struct {
+    ObjectType type;
+    float size;      // Cube size, sphere/cylinder radius, pyramid base
+    float height;    // Pyramid and cylinder height
+    int sectors;     // Sphere and cylinder segments around the axis
+    int stacks;      // Sphere segments along the axis
+} PrimitiveParams;
+
+// One unique mesh shared by every object that references it
+typedef struct {
+    bool used;
+    int refCount;
+    PrimitiveParams params;        // Key for primitives
+    char path[256];                // Key for models, together with importFlags
+    unsigned int importFlags;
+    union {
+        Cube cube;
+        Sphere sphere;
+        Pyramid pyramid;
+        Cylinder cylinder;
+        Plane plane;
+        Model model;
+    } data;
+} GeometryEntry;
+
+PrimitiveParams defaultPrimitiveParams(ObjectType type);
+
+// Acquire functions return a handle holding one reference, or INVALID_GEOMETRY on failure
+int acquirePrimitiveGeometry(PrimitiveParams params);
+int acquireModelGeometry(const char* path, unsigned int importFlags);
+void retainGeometry(int handle);
+void releaseGeometry(int handle);
+const GeometryEntry* getGeometry(int handle);
+void cleanupGeometry();
+
+#endif
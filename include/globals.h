@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include "Vectors.h"
 #include "Screen.h"
+#include "SceneObject.h"
 
 #ifdef _WIN32
     #include <Windows.h> // Windows-specific
@@ -12,11 +13,11 @@
     #include <stdlib.h>  // Standard library for Linux/macOS
 #endif
 
-// Forward declaration to break circular dependency
-struct SceneObject;
+// Currently selected scene object, INVALID_OBJECT_HANDLE when nothing is
+extern ObjectHandle selected_handle;
+
 struct nk_context;
 // Nuklear GUI context
-extern struct SceneObject* selected_object;
 extern struct nk_context* ctx;
 
 #include "loading.h"
@@ -24,19 +25,15 @@ extern struct nk_context* ctx;
 #include "Camera.h"
 #include "types.h"
 #include "gui.h"
-
-#define MAX_OBJECTS 1000
+#include "shaders.h"
 
 // Screen and rendering
 extern Screen screen;
-extern unsigned int shaderProgram;
+extern ShaderProgram shaderProgram;
 extern int screen_width;
 extern int screen_height;
 extern Camera camera;
 
-extern int viewLoc;
-extern int projLoc;
-
 // Indexes and flags for texture and color
 extern int textureIndex;
 extern int colorCreation;
@@ -61,6 +58,13 @@ extern bool modelPressed;
 extern bool usePBR;
 extern bool pbrTogglePressed;
 extern bool backgroundEnabled;
+extern bool oitEnabled;
+extern bool pipelineEnabled;
+extern bool depthPrepassEnabled;
+extern bool deferredEnabled;
+extern bool vsyncEnabled;
+extern bool governorEnabled;
+extern float governorTargetMs;
 extern bool cameraEnabled;
 
 // Model and rendering data
@@ -0,0 +1,33 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+
+#define STATE_MAX_TEXTURE_UNITS 16
+
+// Per-frame counters of state changes requested through the cache, and of the
+// draws submitted between them
+typedef struct {
+    unsigned int issued;     // Calls forwarded to the driver
+    unsigned int skipped;    // Calls dropped because the state was already set
+    unsigned int drawCalls;
+    unsigned int triangles;  // Across all instances
+} GLStateStats;
+
+void invalidateStateCache();
+void beginStateFrame();
+GLStateStats getStateStats();
+void stateCountDraw(GLsizei vertexCount, GLsizei instanceCount);
+
+void stateUseProgram(GLuint program);
+void stateBindVertexArray(GLuint vao);
+void stateBindTexture(GLuint unit, GLenum target, GLuint texture);
+void stateEnable(GLenum cap);
+void stateDisable(GLenum cap);
+void stateDepthFunc(GLenum func);
+void stateDepthMask(GLboolean flag);
+void stateBlendFunc(GLenum sfactor, GLenum dfactor);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <stdbool.h>
+
+// Frame budget controller. Watches the measured frame time and walks a ladder
+// of quality levels, each a scene render scale and a detail scale for LOD
+// selection, to hold governorTargetMs. Level 0 is full quality.
+//
+// Hysteresis keeps it from oscillating: quality drops once the smoothed time
+// has stayed over budget for a short while, and only comes back once it has
+// stayed well under budget for much longer. Every change is followed by a
+// settling period in which measurements are ignored.
+
+// Over this fraction of the target counts as over budget
+#define GOVERNOR_OVER_BUDGET 1.05f
+// Under this fraction counts as headroom, enough for one level up not to overshoot
+#define GOVERNOR_HEADROOM 0.75f
+// Consecutive frames over budget before dropping a level
+#define GOVERNOR_DROP_FRAMES 10
+// Consecutive frames with headroom before raising a level
+#define GOVERNOR_RAISE_FRAMES 90
+// Frames ignored after a change, while the new level's timings arrive
+#define GOVERNOR_SETTLE_FRAMES 15
+
+// Back to full quality with no history; also what disabling the governor does
+void resetGovernor();
+
+// Once per frame with the frame's cost: the larger of CPU and GPU time, not
+// counting time spent blocked on vsync
+void updateGovernor(float frameMs);
+
+int getGovernorLevel();
+int getGovernorLevelCount();
+float getGovernorFrameMs();  // Smoothed, as the controller sees it
+
+// Fraction of the framebuffer size the scene is rendered at
+float getRenderScale();
+// Multiplies projected sizes before LOD selection; below 1 picks coarser levels sooner
+float getLODDetailScale();
+
+#endif
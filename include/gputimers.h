@@ -0,0 +1,50 @@
+#ifndef GPUTIMERS_H
+#define GPUTIMERS_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+
+// Render passes timed with GL_TIME_ELAPSED. Elapsed queries cannot nest, so
+// passes must not overlap.
+typedef enum {
+    GPU_PASS_PREPASS,
+    GPU_PASS_SKYBOX,
+    GPU_PASS_OPAQUE,
+    GPU_PASS_LIGHTING,
+    GPU_PASS_TRANSPARENT,
+    GPU_PASS_GUI,
+    GPU_PASS_COUNT
+} GpuPass;
+
+// Frames of queries kept in flight; results are read once the GPU has caught up
+#define GPU_TIMER_FRAMES 4
+// Resolved frames in the rolling average
+#define GPU_TIMER_HISTORY 64
+
+extern const char* gpuPassNames[GPU_PASS_COUNT];
+
+// Times in milliseconds. Passes skipped in a frame count as zero.
+typedef struct {
+    float lastMs[GPU_PASS_COUNT];     // Most recently resolved frame
+    float averageMs[GPU_PASS_COUNT];  // Over the last GPU_TIMER_HISTORY resolved frames
+    float lastTotalMs;
+    float averageTotalMs;
+    unsigned int framesResolved;
+    unsigned int framesDropped;       // Reused before their results arrived
+    bool available;                   // False until the first frame resolves
+} GpuTimerStats;
+
+void initGpuTimers();
+void cleanupGpuTimers();
+
+// Moves to the next slot of the ring, collecting whatever has finished
+void beginGpuTimerFrame();
+void beginGpuPass(GpuPass pass);
+void endGpuPass();
+
+// Reads back every finished frame without waiting on the GPU. After glFinish
+// this includes the frame just submitted.
+void collectGpuTimers();
+GpuTimerStats getGpuTimerStats();
+
+#endif
@@ -1,10 +1,6 @@
 #ifndef GUI_H
 #define GUI_H
 
-#ifndef MAX_OBJECTS
-#define MAX_OBJECTS 1000
-#endif
-
 #include "ObjectManager.h"
 
 #define GLFW_INCLUDE_NONE 
@@ -22,8 +18,6 @@
 // ImGui forward declarations
 struct ImGuiContext;
 
-extern SceneObject scene_objects[MAX_OBJECTS];
-extern int num_scene_objects;
 extern GLuint textureColorbuffer;
 const char* objectTypeName(ObjectType type);
 
@@ -44,6 +38,7 @@ void main_gui();
 void resize_callback(GLFWwindow* window, int width, int height);
 void teardown_imgui();  // Changed from teardown_nuklear
 void toggle_object_property(SceneObject* obj, const char* property);
+void pick_object_at_cursor(double x, double y);
 void render_imgui();  // Changed from render_nuklear
 void run_loading_screen(GLFWwindow* window);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -0,0 +1,22 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+
+// Offscreen rendering without a window, monitor or display server. An EGL
+// surfaceless context renders into a framebuffer object of a fixed size, which
+// works on Mesa's llvmpipe in containers without a GPU. Needs a build with
+// STELLAI_HEADLESS_EGL; otherwise initHeadlessContext always fails.
+
+bool initHeadlessContext(int width, int height);
+void destroyHeadlessContext();
+bool isHeadless();
+
+// Framebuffer a frame ends up in: the offscreen target when headless, else the window's
+GLuint getDefaultFramebuffer();
+
+// Writes the last rendered frame as a binary PPM
+bool saveHeadlessFrame(const char* path);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "Object3D.h"
+
+// Per-instance attributes streamed alongside the shared primitive geometry
+typedef struct {
+    Matrix4x4 model;   // Attribute locations 3-6
+    Vector4 color;     // Attribute location 7
+    Matrix3x3 normal;  // Attribute locations 8-10
+} InstanceData;
+
+// lod selects one of the primitive's detail levels for every instance in the batch
+void beginInstanceBatch(ObjectType type, int lod);
+void addInstance(const Matrix4x4* model, const Matrix3x3* normal, Vector4 color);
+void flushInstanceBatch();
+void cleanupInstancing();
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+// Minimal fork-join worker pool. parallelFor hands out indices one at a time,
+// so each index should be a reasonably large chunk of work.
+typedef void (*JobFunc)(int index, void* context);
+typedef void (*JobDoneFunc)(void* context);
+
+// workerCount <= 0 picks one worker per hardware thread, minus the caller
+void initJobSystem(int workerCount);
+void shutdownJobSystem();
+int getJobWorkerCount();
+
+// Runs func(i, context) for every i in [0, count) and returns once all are
+// done. The calling thread works too; without workers this is a plain loop.
+void parallelFor(int count, JobFunc func, void* context);
+
+// Split form of parallelFor: returns as soon as the workers have the batch, so
+// the caller can do other work meanwhile. done(context), if given, runs once
+// after the last index, on whichever thread finished it. Only one batch can be
+// in flight; waitForJobs joins it, and parallelFor joins it first. Without
+// workers everything, done included, runs before startParallelFor returns.
+void startParallelFor(int count, JobFunc func, JobDoneFunc done, void* context);
+void waitForJobs();
+
+#endif
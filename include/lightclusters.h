@@ -0,0 +1,36 @@
+#ifndef LIGHTCLUSTERS_H
+#define LIGHTCLUSTERS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+#include "Vectors.h"
+
+// Froxel grid: screen tiles times exponentially spaced view-depth slices
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES 24
+#define CLUSTER_COUNT (CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES)
+
+// Texture units of the buffer textures the fragment shader reads
+#define CLUSTER_UNIT_LIGHTS 5
+#define CLUSTER_UNIT_GRID 6
+#define CLUSTER_UNIT_INDICES 7
+
+typedef struct {
+    int lights;        // Lights submitted
+    int indices;       // Light references across all clusters
+    int maxPerCluster;
+    bool rebuilt;      // False when nothing changed and last frame's lists were kept
+} LightClusterStats;
+
+void initLightClusters();
+void cleanupLightClusters();
+
+// Assigns lights[] to clusters for this camera and uploads the lists. Skips the
+// work when the camera, viewport and lights all match the previous call.
+void updateLightClusters(const Matrix4x4* view, const Matrix4x4* projection, float nearPlane, float farPlane, int width, int height);
+void bindLightClusters();
+LightClusterStats getLightClusterStats();
+
+#endif
@@ -1,4 +1,12 @@
-#define MAX_LIGHTS 10
+#ifndef LIGHTSHADING_H
+#define LIGHTSHADING_H
+
+// Lights are culled per cluster (see lightclusters.h), so fragments only pay
+// for the lights that reach them
+#define MAX_LIGHTS 256
+
+// Falloff level treated as zero when bounding a light's reach
+#define LIGHT_CUTOFF (1.0f / 256.0f)
 
 #include "Vectors.h"
 
@@ -25,9 +33,11 @@ extern Light lights[MAX_LIGHTS];
 extern int lightCount;
 
 void initLightingSystem();
-void updateShaderLights();
+float lightRange(const Light* light);
 void addLight(Light newLight);
 void updateLight(int index, Light updatedLight);
 void removeLight(int index);
 Vector3 calculateLighting(Vector3 normal, Vector3 fragPos, Vector3 viewDir);
 void createLight(Vector3 position, Vector3 direction, Vector3 color, float intensity, LightType type);
+
+#endif
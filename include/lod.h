@@ -0,0 +1,51 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include "Vectors.h"
+#include "bounds.h"
+
+#define MAX_LOD_LEVELS 4
+
+// One detail level: a range of the mesh's shared element buffer
+typedef struct {
+    unsigned int indexOffset;
+    unsigned int indexCount;
+} LODLevel;
+
+// Levels from full detail (0) to coarsest. Every level draws from the same
+// vertex array, so switching level never changes what can be batched together.
+typedef struct {
+    LODLevel levels[MAX_LOD_LEVELS];
+    int count;
+} LODChain;
+
+LODChain makeSingleLODChain(unsigned int indexCount);
+
+// Quadric error edge-collapse simplification. Vertices are merged into a
+// neighbour rather than moved, so the result still indexes the original
+// positions. Stops at targetIndexCount or once the cheapest remaining collapse
+// would move the surface further than maxError. destination must hold
+// indexCount entries; returns how many were written.
+// attributes holds attributeCount floats per vertex for whatever else the mesh
+// uploads besides positions, or is NULL when it uploads only positions. Copies
+// of a position whose attributes differ form a seam and are never collapsed.
+unsigned int simplifyMesh(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+    const Vector3* positions, unsigned int vertexCount, const float* attributes, unsigned int attributeCount,
+    unsigned int targetIndexCount, float maxError);
+
+// Appends simplified levels after the full-detail indices. *indices is
+// reallocated to hold every level and chain receives their ranges; meshes too
+// small to benefit keep a single level.
+void buildLODChain(unsigned int** indices, unsigned int indexCount, const Vector3* positions, unsigned int vertexCount,
+    const float* attributes, unsigned int attributeCount, LODChain* chain);
+
+// Fraction of the viewport height covered by the sphere around bounds.
+// projScale is projection.data[1][1], the cotangent of half the vertical FOV.
+float projectedSize(AABB bounds, Vector3 eye, float projScale);
+
+// Level to draw at this projected size. Leaving the current level needs the
+// size to cross the threshold by a margin, so objects sitting on a boundary
+// do not flip between levels every frame.
+int selectLOD(float screenSize, int current, int levelCount);
+
+#endif
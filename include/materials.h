@@ -24,5 +24,6 @@ void bindPBRMaterial(PBRMaterial material);
 void cleanupPBRMaterial(PBRMaterial* material);
 void addMaterial(const char* name, PBRMaterial material);
 PBRMaterial* getMaterial(const char* name);
+int getMaterialIndex(PBRMaterial material);
 
 #endif 
@@ -0,0 +1,34 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stdbool.h>
+#include "Vectors.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Matrices are column-major, data[column][row], with translation in data[3].
+// matrixMultiply(a, b) applies a first, then b.
+Matrix4x4 translateMatrix(Vector3 position);
+Matrix4x4 matrixMultiply(Matrix4x4 a, Matrix4x4 b);
+Matrix4x4 lookAt(Vector3 eye, Vector3 center, Vector3 up);
+Matrix4x4 perspective(float fov, float aspect, float znear, float zfar);
+Matrix4x4 rotateMatrix(float angle, Vector3 axis);
+Matrix4x4 scaleMatrix(Vector3 scale);
+Matrix4x4 identityMatrix();
+Matrix4x4 composeTransform(Vector3 position, Vector3 rotation, Vector3 scale);
+Matrix3x3 normalMatrix(const Matrix4x4* model);
+bool invertAffine(const Matrix4x4* m, Matrix4x4* out);
+
+// Same product as matrixMultiply without copying the operands; out may alias either
+void matrixMultiplyInto(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out);
+
+Vector3 transformPoint(const Matrix4x4* m, Vector3 p);
+Vector3 transformDirection(const Matrix4x4* m, Vector3 d);
+
+// Batched variants; out may be the same array as in
+void transformPoints(const Matrix4x4* m, const Vector3* in, Vector3* out, int count);
+void transformDirections(const Matrix4x4* m, const Vector3* in, Vector3* out, int count);
+
+#endif
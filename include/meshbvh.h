@@ -0,0 +1,30 @@
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include <stdbool.h>
+#include "bounds.h"
+
+#define MESH_BVH_LEAF_SIZE 4
+#define MESH_BVH_BINS 12
+#define MESH_BVH_MAX_DEPTH 64
+
+typedef struct {
+    AABB box;
+    unsigned int first;  // First triangle for leaves, left child for interior nodes (right is first + 1)
+    unsigned int count;  // Triangles in a leaf, 0 for interior nodes
+} MeshBVHNode;
+
+// Triangle hierarchy over a mesh's CPU-side positions, built with a binned SAH
+typedef struct {
+    MeshBVHNode* nodes;
+    unsigned int nodeCount;
+    unsigned int* triangles;  // Triangle indices, reordered so every leaf is a contiguous range
+    unsigned int triangleCount;
+} MeshBVH;
+
+bool buildMeshBVH(MeshBVH* bvh, const Vector3* positions, const unsigned int* indices, unsigned int triangleCount);
+void freeMeshBVH(MeshBVH* bvh);
+bool intersectMeshBVH(const MeshBVH* bvh, const Vector3* positions, const unsigned int* indices, const Ray* ray,
+    float maxDistance, float* hitDistance, int* hitTriangle);
+
+#endif
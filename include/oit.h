@@ -0,0 +1,28 @@
+#ifndef OIT_H
+#define OIT_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+
+// Weighted blended order-independent transparency. Translucent surfaces are
+// drawn in any order into an accumulation target (premultiplied color times a
+// depth weight) and a revealage target (product of 1 - alpha), then resolved
+// onto the scene framebuffer with one fullscreen pass.
+
+// Texture units the composite shader samples the two targets from
+#define OIT_UNIT_ACCUM 0
+#define OIT_UNIT_REVEALAGE 1
+
+bool initOIT();
+void cleanupOIT();
+
+// Sizes the targets to the scene, copies the opaque depth into them and
+// sets up blending. Returns false when the targets are unusable; the caller
+// should fall back to sorted blending.
+bool beginOITPass(int width, int height);
+
+// Composites the accumulated surfaces over the scene framebuffer
+void endOITPass();
+
+#endif
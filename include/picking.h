@@ -0,0 +1,21 @@
+#ifndef PICKING_H
+#define PICKING_H
+
+#include <stdbool.h>
+#include "bounds.h"
+#include "SceneObject.h"
+
+typedef struct {
+    SceneObject* object;
+    int objectIndex;
+    int mesh;        // Mesh within a model, -1 for primitives
+    int triangle;    // Triangle within that mesh, -1 when the hit was against bounds
+    float distance;  // Along the normalized ray, in world units
+    Vector3 point;
+} PickResult;
+
+Ray screenPointToRay(double x, double y, int width, int height, const Matrix4x4* view, const Matrix4x4* proj);
+bool pickRay(const Ray* ray, float maxDistance, PickResult* result);
+bool pickScreenPoint(double x, double y, PickResult* result);
+
+#endif
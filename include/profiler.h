@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hierarchical CPU scope timer. Every thread records finished scopes into its
+// own ring buffer, which only that thread writes, so recording takes no locks.
+// The rings always hold the most recent events, so a trace can be dumped at any
+// moment, including during startup.
+
+#define PROFILER_MAX_THREADS 64
+#define PROFILER_EVENTS_PER_THREAD 32768  // Power of two
+#define PROFILER_MAX_DEPTH 32
+#define PROFILER_MAX_SUMMARY_NODES 128
+
+// One row of the per-frame summary tree, in depth-first order
+typedef struct {
+    const char* name;
+    int depth;
+    int calls;
+    double ms;  // Summed over the calls
+} ProfileNode;
+
+// Names the calling thread "main"; call before any other thread profiles
+void initProfiler();
+void shutdownProfiler();
+void profilerSetThreadName(const char* name);
+
+// name must outlive the profiler: use string literals
+void profileBegin(const char* name);
+void profileEnd();
+
+// Called by the main thread between frames. Summarizes the main thread's
+// scopes from the frame that just ended.
+void profilerBeginFrame();
+int getProfilerSummary(const ProfileNode** nodes);
+double getProfilerFrameMs();
+
+// Every event still in the rings, as Chrome trace JSON (chrome://tracing, Perfetto)
+bool writeChromeTrace(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef STELLAI_DISABLE_PROFILER
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#else
+#define PROFILE_BEGIN(name) profileBegin(name)
+#define PROFILE_END() profileEnd()
+#endif
+
+#ifdef __cplusplus
+// Scoped form for C++ callers; ends when the enclosing block exits
+struct ProfileScope {
+    explicit ProfileScope(const char* name) { PROFILE_BEGIN(name); }
+    ~ProfileScope() { PROFILE_END(); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+#define PROFILE_SCOPE_CONCAT2(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_SCOPE_CONCAT(profileScope, __LINE__)(name)
+#endif
+
+#endif
@@ -7,9 +7,12 @@
 #include "Vectors.h"
 #include "3DObjects.h"
 #include "ModelLoad.h"
+#include "culling.h"
+#include <stdbool.h>
 
 // Function prototypes
 void setup();
+bool setupHeadless(int width, int height);
 void render();
 double calculateDeltaTime();
 void update(double deltaTime);
@@ -17,6 +20,9 @@ void handleMouseInput(GLFWwindow* window, Camera* camera);
 void end();
 void loadResources(int stage, float* progress);
 void drawMesh(const Mesh* mesh);
+void drawMeshLOD(const Mesh* mesh, int level);
+CullStats getCullStats();
+Matrix4x4 getSceneProjectionMatrix();
 
 // Input callbacks
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
@@ -0,0 +1,41 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <stdint.h>
+
+// Sort key layout, most significant first:
+//   [63:62] pass  [61:58] shader variant  [57:50] material  [49:40] texture
+//   [39:24] vertex array  [23:22] detail level  [21:0] depth
+#define SORT_KEY_PASS_SHIFT     62
+#define SORT_KEY_VARIANT_SHIFT  58
+#define SORT_KEY_MATERIAL_SHIFT 50
+#define SORT_KEY_TEXTURE_SHIFT  40
+#define SORT_KEY_VAO_SHIFT      24
+#define SORT_KEY_LOD_SHIFT      22
+#define SORT_KEY_DEPTH_BITS     22
+
+typedef enum {
+    RENDER_PASS_OPAQUE,
+    RENDER_PASS_TRANSPARENT
+} RenderPass;
+
+typedef struct {
+    uint64_t key;
+    int object;  // Index into objectManager
+} DrawPacket;
+
+typedef struct {
+    DrawPacket* packets;
+    DrawPacket* scratch;  // Ping-pong buffer for the radix sort
+    int count;
+    int capacity;
+} RenderQueue;
+
+uint64_t makeSortKey(RenderPass pass, unsigned int variant, unsigned int material, unsigned int texture, unsigned int vao, unsigned int lod, float depth);
+void initRenderQueue(RenderQueue* queue, int capacity);
+void freeRenderQueue(RenderQueue* queue);
+void clearRenderQueue(RenderQueue* queue);
+void pushDraw(RenderQueue* queue, uint64_t key, int object);
+void sortRenderQueue(RenderQueue* queue);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef RENDERTARGET_H
+#define RENDERTARGET_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+
+// Offscreen framebuffer sized to the scene, shared by the passes that render
+// into their own targets and resolve them with a fullscreen triangle (OIT,
+// deferred). Textures are sampled with texelFetch or 1:1, so they use nearest
+// filtering and clamp to the edge.
+
+#define RENDER_TARGET_MAX_TEXTURES 4
+
+typedef struct {
+    GLuint texture;
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+} TargetTexture;
+
+typedef struct {
+    const char* name;               // Names the target when it is incomplete
+    GLuint framebuffer;
+    TargetTexture textures[RENDER_TARGET_MAX_TEXTURES];
+    int textureCount;
+    GLuint depthBuffer;             // D24S8 renderbuffer, 0 when depth is one of the textures
+    int width;
+    int height;
+    bool complete;
+} RenderTarget;
+
+void createRenderTarget(RenderTarget* target, const char* name);
+// Creates a texture and attaches it; storage is specified by resizeRenderTarget
+GLuint addTargetTexture(RenderTarget* target, GLenum attachment, GLenum internalFormat, GLenum format, GLenum type);
+// Attaches a depth-stencil renderbuffer in the default framebuffer's format, so
+// depth can be blitted between the two
+void addTargetDepthBuffer(RenderTarget* target);
+void deleteRenderTarget(RenderTarget* target);
+
+// Respecifies storage only when the size changes and reports whether the
+// framebuffer is complete at that size
+bool resizeRenderTarget(RenderTarget* target, int width, int height);
+
+// Draws a triangle covering the viewport with whatever program is bound. The
+// vertex shader builds the corners from gl_VertexID.
+void drawFullscreenTriangle();
+void cleanupFullscreenTriangle();
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SCENETARGET_H
+#define SCENETARGET_H
+
+#include <glad/glad.h>
+#include <stdbool.h>
+
+// Where the 3D scene is drawn before the GUI. At full scale that is the
+// default framebuffer itself; below it, an offscreen color and depth target
+// of the scaled size, stretched over the default framebuffer afterwards.
+// Passes that leave and return to the scene's framebuffer (OIT, deferred)
+// bind getSceneFramebuffer() rather than the default one.
+
+// Binds the scene's framebuffer and viewport for this frame and clears the
+// offscreen target. Falls back to full scale when the target is unusable.
+void beginSceneTarget(int width, int height, float scale);
+// Stretches an offscreen scene over the default framebuffer and restores its viewport
+void endSceneTarget();
+void cleanupSceneTarget();
+
+GLuint getSceneFramebuffer();
+int getSceneWidth();
+int getSceneHeight();
+
+#endif
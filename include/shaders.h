@@ -1,7 +1,44 @@
-#include <glad/glad.h>  
+#ifndef SHADERS_H
+#define SHADERS_H
+
+#include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <stdbool.h>
-unsigned int loadShader(const char* vertexPath, const char* fragmentPath);
+#include "lightshading.h"
+
+// Per-draw uniforms the engine sets, resolved once after linking. Camera, light
+// and frame toggles live in the shared blocks from uniformbuffers.h.
+typedef enum {
+    UNIFORM_MODEL,
+    UNIFORM_NORMAL_MATRIX,
+    UNIFORM_INPUT_COLOR,
+    UNIFORM_USE_TEXTURE,
+    UNIFORM_USE_COLOR,
+    UNIFORM_USE_PBR,
+    UNIFORM_USE_INSTANCING,
+    UNIFORM_OIT_PASS,
+    UNIFORM_GBUFFER_PASS,
+    UNIFORM_SLOT_COUNT
+} UniformSlot;
+
+typedef struct {
+    char name[64];
+    GLint location;
+    GLenum type;
+    GLint size;
+} ShaderUniform;
+
+typedef struct {
+    GLuint id;
+    ShaderUniform* uniforms;    // Every active uniform, enumerated after linking
+    int uniformCount;
+    GLint slots[UNIFORM_SLOT_COUNT];    // -1 when the program does not use the uniform
+} ShaderProgram;
+
+ShaderProgram loadShader(const char* vertexPath, const char* fragmentPath);
+void deleteShader(ShaderProgram* program);
+GLint findUniform(const ShaderProgram* program, const char* name);
 bool checkCompileErrors(unsigned int shader, const char* type);
 char* readFile(const char* filePath);
 
+#endif
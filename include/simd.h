@@ -0,0 +1,38 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "Vectors.h"
+
+// Math kernels run 4 lanes wide with SSE, which every x86-64 target has. AVX2
+// builds (STELLAI_ENABLE_AVX2) get the same kernels VEX encoded and with fused
+// multiply-adds. Anything else takes the scalar loops.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define STELLAI_SIMD_SSE 1
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define simdMulAdd(a, b, c) _mm_fmadd_ps((a), (b), (c))
+#else
+#include <xmmintrin.h>
+#define simdMulAdd(a, b, c) _mm_add_ps(_mm_mul_ps((a), (b)), (c))
+#endif
+
+// Four packed Vector3s (12 floats, AoS) to one register per component
+static inline void loadVector3x4(const Vector3* v, __m128* x, __m128* y, __m128* z) {
+    const float* f = &v->x;
+    __m128 a = _mm_loadu_ps(f);      // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(f + 4);  // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(f + 8);  // z2 x3 y3 z3
+    *x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    *z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void storeVector3x4(Vector3* v, __m128 x, __m128 y, __m128 z) {
+    float* f = &v->x;
+    _mm_storeu_ps(f, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(f + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(f + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
+#endif
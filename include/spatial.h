@@ -0,0 +1,52 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <stdbool.h>
+#include "bounds.h"
+#include "culling.h"
+
+#define SPATIAL_NULL_NODE -1
+
+// Leaves store a box enlarged by this fraction of its size (plus a small constant),
+// so objects that move a little do not have to be reinserted
+#define SPATIAL_FAT_MARGIN 0.1f
+#define SPATIAL_FAT_MIN 0.05f
+
+typedef struct {
+    AABB box;       // Fat box for leaves, union of the children otherwise
+    int parent;     // Next free node while on the free list
+    int left;
+    int right;
+    int height;     // 0 for leaves, -1 for free nodes
+    int userData;   // Payload of leaves
+} SpatialNode;
+
+// Dynamic AABB tree, balanced with rotations as leaves are inserted and removed
+typedef struct {
+    SpatialNode* nodes;
+    int nodeCount;
+    int nodeCapacity;
+    int root;
+    int freeList;
+    int leafCount;
+} SpatialTree;
+
+// Return false to stop the query early
+typedef bool (*SpatialQueryCallback)(int userData, void* context);
+
+// Returns the distance the ray should be clipped to: the current maxDistance to
+// keep going, a hit distance to only look for closer leaves, or a negative value to stop
+typedef float (*SpatialRayCallback)(int userData, const Ray* ray, float maxDistance, void* context);
+
+void initSpatialTree(SpatialTree* tree);
+void freeSpatialTree(SpatialTree* tree);
+int createProxy(SpatialTree* tree, AABB box, int userData);
+void destroyProxy(SpatialTree* tree, int proxy);
+bool moveProxy(SpatialTree* tree, int proxy, AABB box);
+void setProxyUserData(SpatialTree* tree, int proxy, int userData);
+int getSpatialTreeHeight(const SpatialTree* tree);
+void querySpatialBox(const SpatialTree* tree, AABB box, SpatialQueryCallback callback, void* context);
+void querySpatialFrustum(const SpatialTree* tree, const Frustum* frustum, SpatialQueryCallback callback, void* context);
+void querySpatialRay(const SpatialTree* tree, const Ray* ray, float maxDistance, SpatialRayCallback callback, void* context);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef UNIFORMBUFFERS_H
+#define UNIFORMBUFFERS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stdbool.h>
+#include "Vectors.h"
+
+// std140 blocks shared by every program; the binding point is the enum value.
+// Shaders declare the blocks they read under the names in uniformBlockNames.
+typedef enum {
+    UNIFORM_BLOCK_CAMERA,
+    UNIFORM_BLOCK_FRAME,
+    UNIFORM_BLOCK_LIGHTS,
+    UNIFORM_BLOCK_COUNT
+} UniformBlock;
+
+extern const char* uniformBlockNames[UNIFORM_BLOCK_COUNT];
+
+// std140 layout of LightBlock. The lights and their per-cluster lists live in
+// buffer textures (lightclusters.h); this block only describes the grid.
+typedef struct {
+    int clusterDims[4];     // Tiles x, tiles y, depth slices, light count
+    float clusterDepth[4];  // Slice scale, slice bias, near, far
+    float tileSize[4];      // Pixels per tile in x and y
+} LightGridUniforms;
+
+// Buffer uploads issued and skipped because the contents had not changed
+typedef struct {
+    unsigned int uploads;
+    unsigned int skipped;
+} UniformBufferStats;
+
+void initUniformBuffers();
+void cleanupUniformBuffers();
+void bindUniformBlocks(GLuint program);
+
+// Each update compares against the last upload and only touches the buffer on change
+void updateCameraUniforms(const Matrix4x4* view, const Matrix4x4* projection, Vector3 viewPos);
+void updateFrameUniforms(bool useLighting, bool noShading);
+void updateLightUniforms(const LightGridUniforms* grid);
+
+void beginUniformFrame();
+UniformBufferStats getUniformBufferStats();
+
+#endif
@@ -0,0 +1,56 @@
+// Clustered lighting shared by the forward object shader and the deferred
+// light pass, spliced in by loadShader. See lightclusters.c. Each light is four
+// texels of clusterLights: position.xyz + range, direction.xyz + type,
+// color.rgb + intensity, spot cutoffs. clusterGrid holds (offset, count) into
+// clusterIndices.
+layout (std140) uniform LightBlock {
+    ivec4 clusterDims;   // Tiles x, tiles y, depth slices, light count
+    vec4 clusterDepth;   // Slice scale, slice bias, near, far
+    vec4 clusterTile;    // Pixels per tile in x and y
+};
+
+uniform samplerBuffer clusterLights;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer clusterIndices;
+
+// viewDepth is the fragment's distance in front of the camera along the view axis
+vec3 clusteredLighting(vec3 fragPos, float viewDepth, vec3 norm, vec3 viewDir, vec3 albedo, float metallic, float roughness) {
+    vec3 ambient = 0.3 * albedo;
+    vec3 lighting = vec3(0.0);
+
+    // Only the lights assigned to this fragment's cluster are evaluated
+    float depth = max(viewDepth, clusterDepth.z);
+    int slice = clamp(int(log(depth) * clusterDepth.x - clusterDepth.y), 0, clusterDims.z - 1);
+    ivec2 tile = min(ivec2(gl_FragCoord.xy / clusterTile.xy), clusterDims.xy - 1);
+    uvec2 cell = texelFetch(clusterGrid, (slice * clusterDims.y + tile.y) * clusterDims.x + tile.x).xy;
+
+    for (uint i = 0u; i < cell.y; i++) {
+        int light = int(texelFetch(clusterIndices, int(cell.x + i)).r) * 4;
+        vec4 positionRange = texelFetch(clusterLights, light);
+        vec4 colorIntensity = texelFetch(clusterLights, light + 2);
+        vec3 lightPosition = positionRange.xyz;
+        // Intensity only sets the clustering range (lightRange); shading uses the color alone
+        vec3 lightColor = colorIntensity.rgb;
+        vec3 lightDir = normalize(lightPosition - fragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor * albedo;
+
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float spec = pow(max(dot(norm, halfwayDir), 0.0), 2.0 / (roughness + 0.0001));
+        float kSpecular = (metallic + (1.0 - metallic) * pow(1.0 - max(dot(viewDir, halfwayDir), 0.0), 5.0));
+        vec3 specular = spec * lightColor * kSpecular;
+
+        // Fade to zero at the range the light was clustered with, so the
+        // cluster boundary never shows as a hard edge
+        float distance = length(lightPosition - fragPos);
+        float falloff = 1.0 / (1.0 + distance * distance);
+        if (positionRange.w >= 0.0) {
+            float ratio = distance / max(positionRange.w, 0.0001);
+            float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+            falloff *= window * window;
+        }
+        lighting += (diffuse + specular) * falloff;
+    }
+
+    return ambient + lighting;
+}
@@ -0,0 +1,47 @@
+#version 330 core
+
+out vec4 FragColor;
+
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+};
+
+layout (std140) uniform FrameBlock {
+    int useLighting;
+    int noShading;
+};
+
+#include "shaders/common/clusteredLighting.glsl"
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gMaterial;
+uniform sampler2D gDepth;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth >= 1.0) {
+        discard; // Nothing opaque here, the skybox fills it
+    }
+
+    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    if (noShading != 0 || useLighting == 0) {
+        FragColor = vec4(albedo, 1.0);
+        return;
+    }
+
+    // View space position from the perspective depth, then back to world space
+    vec2 ndc = gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0;
+    float viewZ = -projection[3][2] / (depth * 2.0 - 1.0 + projection[2][2]);
+    vec3 viewPosition = vec3(ndc.x * -viewZ / projection[0][0], ndc.y * -viewZ / projection[1][1], viewZ);
+    vec3 fragPos = transpose(mat3(view)) * (viewPosition - view[3].xyz);
+
+    vec3 norm = normalize(texelFetch(gNormal, pixel, 0).xyz);
+    vec4 material = texelFetch(gMaterial, pixel, 0);
+    vec3 viewDir = normalize(viewPos.xyz - fragPos);
+    FragColor = vec4(clusteredLighting(fragPos, -viewZ, norm, viewDir, albedo, material.r, material.g), 1.0);
+}
@@ -0,0 +1,5 @@
+#version 330 core
+
+// Depth pre-pass: the depth test and write do all the work, so nothing is shaded
+void main() {
+}
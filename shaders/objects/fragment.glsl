@@ -1,27 +1,37 @@
 #version 330 core
 
-out vec4 FragColor;
+// Location 1 is only written to by the OIT pass, which has two draw buffers;
+// locations 2 and 3 only by the G-buffer pass, see deferred.h
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out float Revealage;
+layout (location = 2) out vec4 GNormal;
+layout (location = 3) out vec4 GMaterial;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
 in vec4 vertexColor;
 
-struct Light {
-    vec3 position;
-    vec3 color;
-    float intensity;
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
 };
 
-uniform Light lights[10];
-uniform int lightCount;
+layout (std140) uniform FrameBlock {
+    int useLighting;
+    int noShading;
+};
+
+#include "shaders/common/clusteredLighting.glsl"
+
 uniform sampler2D texture1;
-uniform vec3 viewPos;
 uniform bool useTexture;
-uniform bool useLighting;
 uniform bool useColor;
-uniform bool noShading;
 uniform bool usePBR;
+uniform bool oitPass;
+uniform bool gbufferPass;
 
 uniform sampler2D albedoMap;
 uniform sampler2D normalMap;
@@ -29,37 +39,18 @@ uniform sampler2D metallicMap;
 uniform sampler2D roughnessMap;
 uniform sampler2D aoMap;
 
-vec3 calculateLighting(vec3 norm, vec3 viewDir, vec3 albedo, float metallic, float roughness, float ao) {
-    vec3 ambient = 0.3 * albedo;
-    vec3 lighting = vec3(0.0);
-
-    for (int i = 0; i < lightCount; i++) {
-        vec3 lightDir = normalize(lights[i].position - FragPos);
-        float diff = max(dot(norm, lightDir), 0.0);
-        vec3 diffuse = diff * lights[i].color * albedo;
-
-        vec3 halfwayDir = normalize(lightDir + viewDir);
-        float spec = pow(max(dot(norm, halfwayDir), 0.0), 2.0 / (roughness + 0.0001));
-        float kSpecular = (metallic + (1.0 - metallic) * pow(1.0 - max(dot(viewDir, halfwayDir), 0.0), 5.0));
-        vec3 specular = spec * lights[i].color * kSpecular;
-
-        lighting += (diffuse + specular) * (1.0 / (1.0 + pow(length(lights[i].position - FragPos), 2.0)));
-    }
-
-    return ambient + lighting;
-}
-
 void main() {
     vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 baseColor = vec3(1.0); // Start with default white color
+    float ao = 1.0;
 
     if (usePBR) {
         baseColor = texture(albedoMap, TexCoord).rgb;
         norm = normalize(texture(normalMap, TexCoord).rgb * 2.0 - 1.0);
         float metallic = texture(metallicMap, TexCoord).r;
         float roughness = texture(roughnessMap, TexCoord).r;
-        float ao = texture(aoMap, TexCoord).r;
+        ao = texture(aoMap, TexCoord).r;
         baseColor *= ao; // Apply ambient occlusion directly to base color
     } else if (useTexture) {
         baseColor = texture(texture1, TexCoord).rgb;
@@ -70,11 +61,34 @@ void main() {
         baseColor = mix(baseColor, vertexColor.rgb, 0.5);
     }
 
+    // Surface attributes only; the deferred light pass shades them
+    if (gbufferPass) {
+        FragColor = vec4(baseColor, 1.0);
+        GNormal = vec4(norm, 0.0);
+        // The forward path below lights with metallic 0 and roughness 1; the
+        // light pass must see the same values to produce the same image
+        GMaterial = vec4(0.0, 1.0, ao, 0.0);
+        return;
+    }
+
     // Compute lighting or return the color directly if no shading is required
-    if (noShading || !useLighting) {
-        FragColor = vec4(baseColor, 0.5);
+    vec4 color;
+    if (noShading != 0 || useLighting == 0) {
+        color = vec4(baseColor, vertexColor.a);
+    } else {
+        float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+        vec3 lightingResult = clusteredLighting(FragPos, viewDepth, norm, viewDir, baseColor, 0.0, 1.0);
+        color = vec4(lightingResult, vertexColor.a);
+    }
+
+    if (oitPass) {
+        // Weighted blended OIT (McGuire & Bavoil): nearer and more opaque
+        // surfaces get a larger share of the accumulated color
+        float z = -(view * vec4(FragPos, 1.0)).z;
+        float weight = color.a * clamp(10.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+        FragColor = vec4(color.rgb * color.a, color.a) * weight;
+        Revealage = color.a;
     } else {
-        vec3 lightingResult = calculateLighting(norm, viewDir, baseColor, 0.0, 1.0, 1.0);
-        FragColor = vec4(lightingResult, 1.0);
+        FragColor = color;
     }
 }
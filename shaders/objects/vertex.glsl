@@ -3,22 +3,37 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 layout (location = 2) in vec3 aNormal;
+layout (location = 3) in mat4 instanceModel;  // Locations 3-6, one column each
+layout (location = 7) in vec4 instanceColor;
+layout (location = 8) in mat3 instanceNormal;  // Locations 8-10
 
 out vec3 FragPos;  
 out vec2 TexCoord;  
 out vec3 Normal;   
 out vec4 vertexColor;  
 
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;
+    vec4 viewPos;
+};
+
 uniform mat4 model;       
-uniform mat4 view;        
-uniform mat4 projection;  
+uniform mat3 normalMatrix;  // Inverse transpose of model, computed on the CPU
 uniform vec4 inputColor;  
+uniform bool useInstancing;
+
+// The depth pre-pass links this shader into another program; the main pass
+// tests GL_EQUAL against its depth, so both must compute identical positions
+invariant gl_Position;
 
 void main() {
-    vec4 worldPosition = model * vec4(aPos, 1.0);
+    mat4 modelMatrix = useInstancing ? instanceModel : model;
+    vec4 worldPosition = modelMatrix * vec4(aPos, 1.0);
     FragPos = vec3(worldPosition);  
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
+    Normal = (useInstancing ? instanceNormal : normalMatrix) * aNormal;  
     TexCoord = aTexCoord;
-    vertexColor = inputColor;  
+    vertexColor = useInstancing ? instanceColor : inputColor;  
     gl_Position = projection * view * worldPosition;  
 }
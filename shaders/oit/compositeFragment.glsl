@@ -0,0 +1,19 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D oitAccum;
+uniform sampler2D oitRevealage;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(oitRevealage, texel, 0).r;
+    if (revealage >= 1.0) {
+        discard;  // Nothing translucent covered this pixel
+    }
+
+    // Weighted average color; the clamp keeps half float overflow out of the division
+    vec4 accum = texelFetch(oitAccum, texel, 0);
+    vec3 average = accum.rgb / clamp(accum.a, 1e-4, 5e4);
+    FragColor = vec4(average, revealage);
+}
@@ -3,12 +3,16 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 skyboxView;  // view with the translation removed
+    vec4 viewPos;
+};
 
 void main()
 {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
-    gl_Position = pos.xyww;  // Remove translation component
+    vec4 pos = projection * skyboxView * vec4(aPos, 1.0);
+    gl_Position = pos.xyww;  // Depth of 1 keeps the sky behind everything
 }
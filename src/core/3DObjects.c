@@ -6,10 +6,12 @@
 #include <stdio.h>
 #include "Vectors.h"
 #include "Camera.h"
+#include "shaders.h"
+#include "glstate.h"
 
 #define PI 3.14159265358979323846
 
-extern unsigned int shaderProgram;
+extern ShaderProgram shaderProgram;
 // CUBE
 void generateCubeVertices(float* vertices, unsigned int* indices, float size) {
     int vertexIndex = 0, index = 0;
@@ -78,7 +80,7 @@ Cube createCube(Vector3 position, Vector4 color, float size) {
     generateCubeVertices(vertices, indices, size);
 
     glGenVertexArrays(1, &cube.vao);
-    glBindVertexArray(cube.vao);
+    stateBindVertexArray(cube.vao);
 
     glGenBuffers(1, &cube.vbo);
     glBindBuffer(GL_ARRAY_BUFFER, cube.vbo);
@@ -96,39 +98,32 @@ Cube createCube(Vector3 position, Vector4 color, float size) {
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    stateBindVertexArray(0);
 
     free(vertices);
     free(indices);
 
     cube.position = position;
     cube.color = color;
+    cube.bounds = makeAABB(vector(-size / 2.0f, -size / 2.0f, -size / 2.0f), vector(size / 2.0f, size / 2.0f, size / 2.0f));
     return cube;
 }
 
 
-void drawCube(const Cube* cube, Matrix4x4 viewMatrix, Matrix4x4 projMatrix) {
-    glUseProgram(shaderProgram);
-
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
+void drawCube(const Cube* cube) {
+    stateUseProgram(shaderProgram.id);
 
     Matrix4x4 modelMatrix = translateMatrix(cube->position);  // Assuming translateMatrix is defined elsewhere
 
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, modelMatrix.data[0]);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, viewMatrix.data[0]);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projMatrix.data[0]);
+    glUniformMatrix4fv(shaderProgram.slots[UNIFORM_MODEL], 1, GL_FALSE, modelMatrix.data[0]);
 
     // Set color
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
-    glUniform4f(colorLoc, cube->color.x, cube->color.y, cube->color.z, cube->color.w);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], cube->color.x, cube->color.y, cube->color.z, cube->color.w);
 
 
 
-    glBindVertexArray(cube->vao);
+    stateBindVertexArray(cube->vao);
     glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 
@@ -141,7 +136,8 @@ void destroyCube(Cube* cube) {
 
 
 // CUBESPHERE (time to implement.: about 5 days :))
-void generateSphereVertices(float* vertices, unsigned int* indices, float radius, int sectorCount, int stackCount) {
+// Indices are offset by baseVertex; returns how many were written
+unsigned int generateSphereVertices(float* vertices, unsigned int* indices, float radius, int sectorCount, int stackCount, unsigned int baseVertex) {
     float x, y, z, xy;                              // vertex position
     float nx, ny, nz, lengthInv = 1.0f / radius;    // vertex normal
     float s, t;                                     // vertex texCoord
@@ -185,9 +181,9 @@ void generateSphereVertices(float* vertices, unsigned int* indices, float radius
         }
     }
 
-    int k1, k2;
+    unsigned int k1, k2;
     for (int i = 0; i < stackCount; ++i) {
-        k1 = i * (sectorCount + 1);     // beginning of current stack
+        k1 = baseVertex + i * (sectorCount + 1);     // beginning of current stack
         k2 = k1 + sectorCount + 1;      // beginning of next stack
 
         for (int j = 0; j < sectorCount; ++j, ++k1, ++k2) {
@@ -204,27 +200,57 @@ void generateSphereVertices(float* vertices, unsigned int* indices, float radius
             }
         }
     }
+    return index;
+}
+
+// Segment count for a detail level: halved per level, down to a floor that still reads as round
+static int lodSegments(int base, int level, int minimum) {
+    int segments = base >> level;
+    if (minimum > base) minimum = base;
+    return segments < minimum ? minimum : segments;
 }
 
 Sphere createSphere(float radius, int sectorCount, int stackCount, Vector3 position, Vector4 color) {
     Sphere sphere;
-    int vertexCount = (stackCount + 1) * (sectorCount + 1);
+
+    // Every detail level is a complete sphere; they share one vertex and element buffer
+    int levelSectors[MAX_LOD_LEVELS], levelStacks[MAX_LOD_LEVELS];
+    int levelCount = 0, vertexCount = 0, indexCapacity = 0;
+    for (int level = 0; level < MAX_LOD_LEVELS; level++) {
+        int sectors = lodSegments(sectorCount, level, 6);
+        int stacks = lodSegments(stackCount, level, 4);
+        if (level > 0 && sectors == levelSectors[level - 1] && stacks == levelStacks[level - 1]) break;
+        levelSectors[level] = sectors;
+        levelStacks[level] = stacks;
+        levelCount++;
+        vertexCount += (stacks + 1) * (sectors + 1);
+        indexCapacity += stacks * sectors * 6;
+    }
     // 3 for position, 3 for normal, 2 for texture
     int numVertices = vertexCount * 8;
-    int indexCount = stackCount * sectorCount * 6;
 
     float* vertices = (float*)malloc(numVertices * sizeof(float));
-    unsigned int* indices = (unsigned int*)malloc(indexCount * sizeof(unsigned int));
+    unsigned int* indices = (unsigned int*)malloc(indexCapacity * sizeof(unsigned int));
 
     if (!vertices || !indices) {
         fprintf(stderr, "Failed to allocate memory for sphere.\n");
         exit(EXIT_FAILURE);
     }
 
-    // Call the function to generate the vertices and indices for the sphere
-    generateSphereVertices(vertices, indices, radius, sectorCount, stackCount);
+    // Call the function to generate the vertices and indices for each level
+    unsigned int baseVertex = 0, indexCount = 0;
+    for (int level = 0; level < levelCount; level++) {
+        unsigned int written = generateSphereVertices(vertices + baseVertex * 8, indices + indexCount, radius,
+            levelSectors[level], levelStacks[level], baseVertex);
+        sphere.lods.levels[level].indexOffset = indexCount;
+        sphere.lods.levels[level].indexCount = written;
+        baseVertex += (levelStacks[level] + 1) * (levelSectors[level] + 1);
+        indexCount += written;
+    }
+    sphere.lods.count = levelCount;
+
     glGenVertexArrays(1, &sphere.vao);
-    glBindVertexArray(sphere.vao);
+    stateBindVertexArray(sphere.vao);
 
     glGenBuffers(1, &sphere.vbo);
     glBindBuffer(GL_ARRAY_BUFFER, sphere.vbo);
@@ -241,15 +267,16 @@ Sphere createSphere(float radius, int sectorCount, int stackCount, Vector3 posit
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
 
-    glBindVertexArray(0);
+    stateBindVertexArray(0);
 
     free(vertices);
     free(indices);
 
     sphere.position = position;
     sphere.color = color;
-    sphere.numVertices = vertexCount;
-    sphere.numIndices = indexCount;
+    sphere.bounds = makeAABB(vector(-radius, -radius, -radius), vector(radius, radius, radius));
+    sphere.numVertices = (stackCount + 1) * (sectorCount + 1);
+    sphere.numIndices = sphere.lods.levels[0].indexCount;
 
     return sphere;
 }
@@ -257,26 +284,18 @@ Sphere createSphere(float radius, int sectorCount, int stackCount, Vector3 posit
 
 
 // Function to draw a sphere
-void drawSphere(const Sphere* sphere, Matrix4x4 viewMatrix, Matrix4x4 projMatrix) {
-    glUseProgram(shaderProgram);
-
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
+void drawSphere(const Sphere* sphere) {
+    stateUseProgram(shaderProgram.id);
 
     Matrix4x4 modelMatrix = translateMatrix(sphere->position);
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (const GLfloat*)modelMatrix.data);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, (const GLfloat*)viewMatrix.data);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, (const GLfloat*)projMatrix.data);
+    glUniformMatrix4fv(shaderProgram.slots[UNIFORM_MODEL], 1, GL_FALSE, (const GLfloat*)modelMatrix.data);
 
 
 
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
-    glUniform4f(colorLoc, sphere->color.x, sphere->color.y, sphere->color.z, sphere->color.w);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], sphere->color.x, sphere->color.y, sphere->color.z, sphere->color.w);
 
-    glBindVertexArray(sphere->vao);
+    stateBindVertexArray(sphere->vao);
     glDrawElements(GL_TRIANGLES, sphere->numIndices, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 void destroySphere(Sphere* sphere) {
@@ -341,7 +360,7 @@ Pyramid createPyramid(Vector3 position, Vector4 color, float baseSize, float hei
     generatePyramidVertices(vertices, indices, baseSize, height);
 
     glGenVertexArrays(1, &pyramid.vao);
-    glBindVertexArray(pyramid.vao);
+    stateBindVertexArray(pyramid.vao);
 
     glGenBuffers(1, &pyramid.vbo);
     glBindBuffer(GL_ARRAY_BUFFER, pyramid.vbo);
@@ -359,23 +378,20 @@ Pyramid createPyramid(Vector3 position, Vector4 color, float baseSize, float hei
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    stateBindVertexArray(0);
 
     free(vertices);
     free(indices);
 
     pyramid.position = position;
     pyramid.color = color;
+    pyramid.bounds = makeAABB(vector(-baseSize / 2.0f, 0.0f, -baseSize / 2.0f), vector(baseSize / 2.0f, height, baseSize / 2.0f));
     return pyramid;
 }
 
 // Function to draw a pyramid
-void drawPyramid(const Pyramid* pyramid, Matrix4x4 viewMatrix, Matrix4x4 projMatrix) {
-    glUseProgram(shaderProgram);
-
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
+void drawPyramid(const Pyramid* pyramid) {
+    stateUseProgram(shaderProgram.id);
 
     // Create a translation matrix to place the pyramid correctly in the world
     Matrix4x4 translationMatrix = translateMatrix(pyramid->position);
@@ -383,19 +399,15 @@ void drawPyramid(const Pyramid* pyramid, Matrix4x4 viewMatrix, Matrix4x4 projMat
     Matrix4x4 adjustmentMatrix = translateMatrix((Vector3) { 0.0f, -0.5f, 0.0f });
     Matrix4x4 modelMatrix = matrixMultiply(translationMatrix, adjustmentMatrix);
 
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (const GLfloat*)modelMatrix.data);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, (const GLfloat*)viewMatrix.data);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, (const GLfloat*)projMatrix.data);
+    glUniformMatrix4fv(shaderProgram.slots[UNIFORM_MODEL], 1, GL_FALSE, (const GLfloat*)modelMatrix.data);
 
 
 
     // Set color
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
-    glUniform4f(colorLoc, pyramid->color.x, pyramid->color.y, pyramid->color.z, pyramid->color.w);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], pyramid->color.x, pyramid->color.y, pyramid->color.z, pyramid->color.w);
 
-    glBindVertexArray(pyramid->vao);
+    stateBindVertexArray(pyramid->vao);
     glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 
@@ -407,7 +419,8 @@ void destroyPyramid(Pyramid* pyramid) {
 }
 
 // CYLINDER
-void generateCylinderVertices(float* vertices, unsigned int* indices, float radius, float height, int sectorCount) {
+// Writes (sectorCount + 1) * 2 vertices and sectorCount * 12 indices, offset by baseVertex
+void generateCylinderVertices(float* vertices, unsigned int* indices, float radius, float height, int sectorCount, unsigned int baseVertex) {
     float angleStep = 2 * PI / sectorCount;
     float angle;
     int vertexIndex = 0, index = 0;
@@ -478,13 +491,27 @@ void generateCylinderVertices(float* vertices, unsigned int* indices, float radi
         indices[index++] = nextBottom;
         indices[index++] = nextTop;
     }
+
+    for (int i = 0; i < index; ++i) {
+        indices[i] += baseVertex;
+    }
 }
 
 Cylinder createCylinder(float radius, float height, int sectorCount, Vector3 position, Vector4 color) {
     Cylinder cylinder;
-    int vertexCount = (sectorCount + 1) * 2 + 2; // +2 for center points of top and bottom circle
+
+    // Detail levels drop sectors and share one vertex and element buffer
+    int levelSectors[MAX_LOD_LEVELS];
+    int levelCount = 0, vertexCount = 0, indexCount = 0;
+    for (int level = 0; level < MAX_LOD_LEVELS; level++) {
+        int sectors = lodSegments(sectorCount, level, 6);
+        if (level > 0 && sectors == levelSectors[level - 1]) break;
+        levelSectors[level] = sectors;
+        levelCount++;
+        vertexCount += (sectors + 1) * 2;
+        indexCount += sectors * 12; // 6 indices per sector for sides, top and bottom
+    }
     int numVertices = vertexCount * 6; // 3 for position, 3 for normal
-    int indexCount = sectorCount * 12; // 6 indices per sector for sides, top and bottom
 
     float* vertices = (float*)malloc(numVertices * sizeof(float));
     unsigned int* indices = (unsigned int*)malloc(indexCount * sizeof(unsigned int));
@@ -494,10 +521,18 @@ Cylinder createCylinder(float radius, float height, int sectorCount, Vector3 pos
         exit(EXIT_FAILURE);
     }
 
-    generateCylinderVertices(vertices, indices, radius, height, sectorCount);
+    unsigned int baseVertex = 0, indexOffset = 0;
+    for (int level = 0; level < levelCount; level++) {
+        generateCylinderVertices(vertices + baseVertex * 6, indices + indexOffset, radius, height, levelSectors[level], baseVertex);
+        cylinder.lods.levels[level].indexOffset = indexOffset;
+        cylinder.lods.levels[level].indexCount = levelSectors[level] * 12;
+        baseVertex += (levelSectors[level] + 1) * 2;
+        indexOffset += levelSectors[level] * 12;
+    }
+    cylinder.lods.count = levelCount;
 
     glGenVertexArrays(1, &cylinder.vao);
-    glBindVertexArray(cylinder.vao);
+    stateBindVertexArray(cylinder.vao);
 
     glGenBuffers(1, &cylinder.vbo);
     glBindBuffer(GL_ARRAY_BUFFER, cylinder.vbo);
@@ -512,7 +547,7 @@ Cylinder createCylinder(float radius, float height, int sectorCount, Vector3 pos
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
 
-    glBindVertexArray(0);
+    stateBindVertexArray(0);
 
     // Cleanup
     free(vertices);
@@ -520,6 +555,7 @@ Cylinder createCylinder(float radius, float height, int sectorCount, Vector3 pos
 
     cylinder.position = position;
     cylinder.color = color;
+    cylinder.bounds = makeAABB(vector(-radius, -height / 2.0f, -radius), vector(radius, height / 2.0f, radius));
     cylinder.radius = radius;
     cylinder.height = height;
     cylinder.sectorCount = sectorCount;
@@ -527,26 +563,18 @@ Cylinder createCylinder(float radius, float height, int sectorCount, Vector3 pos
     return cylinder;
 }
 
-void drawCylinder(const Cylinder* cylinder, Matrix4x4 viewMatrix, Matrix4x4 projMatrix) {
-    glUseProgram(shaderProgram);
-
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
+void drawCylinder(const Cylinder* cylinder) {
+    stateUseProgram(shaderProgram.id);
 
     Matrix4x4 modelMatrix = translateMatrix(cylinder->position); 
 
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, modelMatrix.data[0]);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, viewMatrix.data[0]);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projMatrix.data[0]);
+    glUniformMatrix4fv(shaderProgram.slots[UNIFORM_MODEL], 1, GL_FALSE, modelMatrix.data[0]);
 
     // Set color
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
-    glUniform4f(colorLoc, cylinder->color.x, cylinder->color.y, cylinder->color.z, cylinder->color.w);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], cylinder->color.x, cylinder->color.y, cylinder->color.z, cylinder->color.w);
 
-    glBindVertexArray(cylinder->vao);
+    stateBindVertexArray(cylinder->vao);
     glDrawElements(GL_TRIANGLES, cylinder->sectorCount * 12, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 void destroyCylinder(Cylinder* cylinder) {
@@ -574,7 +602,7 @@ Plane createPlane(Vector3 position, Vector4 color) {
     };
 
     glGenVertexArrays(1, &plane.vao);
-    glBindVertexArray(plane.vao);
+    stateBindVertexArray(plane.vao);
 
     glGenBuffers(1, &plane.vbo);
     glBindBuffer(GL_ARRAY_BUFFER, plane.vbo);
@@ -590,33 +618,26 @@ Plane createPlane(Vector3 position, Vector4 color) {
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    stateBindVertexArray(0);
 
     plane.position = position;
     plane.color = color;
+    plane.bounds = makeAABB(vector(-halfWidth, 0.0f, -halfHeight), vector(halfWidth, 0.0f, halfHeight));
     return plane;
 }
 
-void drawPlane(const Plane* plane, Matrix4x4 viewMatrix, Matrix4x4 projMatrix) {
-    glUseProgram(shaderProgram);
-
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
+void drawPlane(const Plane* plane) {
+    stateUseProgram(shaderProgram.id);
 
     Matrix4x4 modelMatrix = translateMatrix(plane->position);  
 
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, modelMatrix.data[0]);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, viewMatrix.data[0]);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, projMatrix.data[0]);
+    glUniformMatrix4fv(shaderProgram.slots[UNIFORM_MODEL], 1, GL_FALSE, modelMatrix.data[0]);
 
     // Set color
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
-    glUniform4f(colorLoc, plane->color.x, plane->color.y, plane->color.z, plane->color.w);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], plane->color.x, plane->color.y, plane->color.z, plane->color.w);
 
-    glBindVertexArray(plane->vao);
+    stateBindVertexArray(plane->vao);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 void destroyPlane(Plane* plane) {
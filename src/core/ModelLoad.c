@@ -1,4 +1,6 @@
 #include "ModelLoad.h"
+#include "glstate.h"
+#include "profiler.h"
 
 Mesh processMesh(struct aiMesh* mesh, const struct aiScene* scene) {
     Mesh newMesh = { 0 };
@@ -8,7 +10,7 @@ Mesh processMesh(struct aiMesh* mesh, const struct aiScene* scene) {
     glGenBuffers(1, &newMesh.VBO);
     glGenBuffers(1, &newMesh.EBO);
 
-    glBindVertexArray(newMesh.VAO);
+    stateBindVertexArray(newMesh.VAO);
 
     // Vertices
     glBindBuffer(GL_ARRAY_BUFFER, newMesh.VBO);
@@ -28,22 +30,47 @@ Mesh processMesh(struct aiMesh* mesh, const struct aiScene* scene) {
             newMesh.indices[i * mesh->mFaces[i].mNumIndices + j] = mesh->mFaces[i].mIndices[j];
         }
     }
+
+    newMesh.numVertices = mesh->mNumVertices;
+    newMesh.numIndices = mesh->mNumFaces * 3;
+
+    newMesh.bounds = emptyAABB();
+    newMesh.positions = (Vector3*)malloc(mesh->mNumVertices * sizeof(Vector3));
+    if (newMesh.positions) {
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+            newMesh.positions[i] = vector(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+            expandAABB(&newMesh.bounds, newMesh.positions[i]);
+        }
+    }
+
+    // Simplified levels reuse the vertex buffer and are appended to the index buffer.
+    // Only positions are uploaded, so no copy of a position looks different from another.
+    buildLODChain(&newMesh.indices, newMesh.numIndices, newMesh.positions, newMesh.numVertices, NULL, 0, &newMesh.lods);
+    const LODLevel* coarsest = &newMesh.lods.levels[newMesh.lods.count - 1];
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newMesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->mNumFaces * 3 * sizeof(unsigned int), newMesh.indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (coarsest->indexOffset + coarsest->indexCount) * sizeof(unsigned int), newMesh.indices, GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(struct aiVector3D), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);  // Unbind VAO
+    stateBindVertexArray(0);  // Unbind VAO
 
-    newMesh.numVertices = mesh->mNumVertices;
-    newMesh.numIndices = mesh->mNumFaces * 3;
+    if (newMesh.positions) {
+        buildMeshBVH(&newMesh.bvh, newMesh.positions, newMesh.indices, mesh->mNumFaces);
+    }
+    else {
+        fprintf(stderr, "Failed to allocate memory for mesh positions; picking will fall back to bounds.\n");
+    }
     return newMesh;
 }
 
 
 Model* loadModel(const char* path) {
-    const struct aiScene* scene = aiImportFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+    return loadModelWithFlags(path, MODEL_IMPORT_FLAGS);
+}
+
+static Model* importModel(const char* path, unsigned int importFlags) {
+    const struct aiScene* scene = aiImportFile(path, importFlags);
     if (!scene) {
         fprintf(stderr, "Failed to load model: %s\n", aiGetErrorString());
         return NULL;
@@ -73,14 +100,23 @@ Model* loadModel(const char* path) {
         return NULL;
     }
 
+    model->bounds = emptyAABB();
     for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
         model->meshes[i] = processMesh(scene->mMeshes[i], scene);
+        model->bounds = mergeAABB(model->bounds, model->meshes[i].bounds);
     }
 
     aiReleaseImport(scene);
     return model;
 }
 
+Model* loadModelWithFlags(const char* path, unsigned int importFlags) {
+    PROFILE_BEGIN("loadModel");
+    Model* model = importModel(path, importFlags);
+    PROFILE_END();
+    return model;
+}
+
 
 void freeModel(Model* model) {
     if (!model) return;
@@ -104,6 +140,11 @@ void freeModel(Model* model) {
             free(mesh->indices);
             mesh->indices = NULL;
         }
+        if (mesh->positions) {
+            free(mesh->positions);
+            mesh->positions = NULL;
+        }
+        freeMeshBVH(&mesh->bvh);
     }
 
     if (model->meshes) {
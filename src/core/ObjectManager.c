@@ -11,28 +11,298 @@
 #include "gui.h"
 #include "SceneObject.h"
 #include "Object3D.h"
+#include "glstate.h"
+#include "geometry.h"
+#include <stdlib.h>
+#include <string.h>
 
 ObjectManager objectManager;
 
+// Owns the spatial layout of objectManager.objects; leaves carry object indices
+SpatialTree sceneTree;
+
 void initObjectManager() {
     objectManager.count = 0;
-    objectManager.capacity = MAX_OBJECTS;
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        objectManager.objects[i].id = -1; // Initialize object IDs to -1 to indicate they are not used
+    objectManager.capacity = 0;
+    objectManager.freeSlotCount = 0;
+    objectManager.slotCount = 0;
+    objectManager.slotCapacity = 0;
+    initSpatialTree(&sceneTree);
+}
+
+static void* growArray(void* array, size_t elementSize, int capacity) {
+    void* grown = realloc(array, (size_t)capacity * elementSize);
+    if (!grown) {
+        fprintf(stderr, "Failed to grow object storage.\n");
+        exit(EXIT_FAILURE);
     }
+    return grown;
 }
 
-void addObjectToManager(SceneObject newObject) {
-    static int currentID = 0; // Static variable to keep track of unique IDs
-    if (objectManager.count < MAX_OBJECTS) {
-        newObject.id = currentID++; // Assign a unique ID to the new object
-        objectManager.objects[objectManager.count++] = newObject;
+// The slot map outlives the objects so handles from before a scene reset
+// (undo history, clipboard) stay stale instead of aliasing new objects
+static void freeObjectStorage() {
+    free(objectManager.objects);
+    free(objectManager.handles);
+    free(objectManager.worldMatrices);
+    free(objectManager.normalMatrices);
+    free(objectManager.worldBounds);
+    free(objectManager.transformDirty);
+    free(objectManager.renderStates);
+    free(objectManager.colors);
+    free(objectManager.materialRefs);
+    free(objectManager.lodLevels);
+    free(objectManager.dirtyObjects);
+    objectManager.objects = NULL;
+    objectManager.handles = NULL;
+    objectManager.worldMatrices = NULL;
+    objectManager.normalMatrices = NULL;
+    objectManager.worldBounds = NULL;
+    objectManager.transformDirty = NULL;
+    objectManager.renderStates = NULL;
+    objectManager.colors = NULL;
+    objectManager.materialRefs = NULL;
+    objectManager.lodLevels = NULL;
+    objectManager.dirtyObjects = NULL;
+    objectManager.count = 0;
+    objectManager.capacity = 0;
+    objectManager.dirtyCount = 0;
+    objectManager.dirtyCapacity = 0;
+}
+
+// Doubles every dense array together
+static void reserveObjects(int needed) {
+    if (needed <= objectManager.capacity) return;
+
+    int capacity = objectManager.capacity ? objectManager.capacity : 64;
+    while (capacity < needed) capacity *= 2;
+
+    objectManager.objects = (SceneObject*)growArray(objectManager.objects, sizeof(SceneObject), capacity);
+    objectManager.handles = (ObjectHandle*)growArray(objectManager.handles, sizeof(ObjectHandle), capacity);
+    objectManager.worldMatrices = (Matrix4x4*)growArray(objectManager.worldMatrices, sizeof(Matrix4x4), capacity);
+    objectManager.normalMatrices = (Matrix3x3*)growArray(objectManager.normalMatrices, sizeof(Matrix3x3), capacity);
+    objectManager.worldBounds = (AABB*)growArray(objectManager.worldBounds, sizeof(AABB), capacity);
+    objectManager.transformDirty = (unsigned char*)growArray(objectManager.transformDirty, sizeof(unsigned char), capacity);
+    objectManager.renderStates = (ObjectRenderState*)growArray(objectManager.renderStates, sizeof(ObjectRenderState), capacity);
+    objectManager.colors = (Vector4*)growArray(objectManager.colors, sizeof(Vector4), capacity);
+    objectManager.materialRefs = (int*)growArray(objectManager.materialRefs, sizeof(int), capacity);
+    objectManager.lodLevels = (unsigned char*)growArray(objectManager.lodLevels, sizeof(unsigned char), capacity);
+    objectManager.capacity = capacity;
+}
+
+static ObjectHandle makeHandle(int slot, unsigned int generation) {
+    return ((ObjectHandle)generation << 32) | (ObjectHandle)(uint32_t)slot;
+}
+
+// Reuses the most recently freed slot, or issues a new one
+static int allocateSlot() {
+    if (objectManager.freeSlotCount > 0) {
+        return objectManager.freeSlots[--objectManager.freeSlotCount];
+    }
+    if (objectManager.slotCount == objectManager.slotCapacity) {
+        int capacity = objectManager.slotCapacity ? objectManager.slotCapacity * 2 : 64;
+        objectManager.slotIndices = (int*)growArray(objectManager.slotIndices, sizeof(int), capacity);
+        objectManager.slotGenerations = (unsigned int*)growArray(objectManager.slotGenerations, sizeof(unsigned int), capacity);
+        objectManager.freeSlots = (int*)growArray(objectManager.freeSlots, sizeof(int), capacity);
+        objectManager.slotCapacity = capacity;
+    }
+    int slot = objectManager.slotCount++;
+    objectManager.slotGenerations[slot] = 1;
+    return slot;
+}
+
+int getObjectIndex(ObjectHandle handle) {
+    uint32_t slot = (uint32_t)(handle & 0xFFFFFFFFu);
+    unsigned int generation = (unsigned int)(handle >> 32);
+    if (handle == INVALID_OBJECT_HANDLE || slot >= (uint32_t)objectManager.slotCount) return -1;
+    if (objectManager.slotGenerations[slot] != generation) return -1;
+    return objectManager.slotIndices[slot];
+}
+
+// The pointer is only good until the next add or remove
+SceneObject* getObject(ObjectHandle handle) {
+    int index = getObjectIndex(handle);
+    return index >= 0 ? &objectManager.objects[index] : NULL;
+}
+
+static int objectIndexCount(const SceneObject* obj) {
+    switch (obj->object.type) {
+    case OBJ_CUBE: return 36;
+    case OBJ_SPHERE: return obj->object.data.sphere.numIndices;
+    case OBJ_PYRAMID: return 18;
+    case OBJ_CYLINDER: return obj->object.data.cylinder.sectorCount * 12;
+    case OBJ_PLANE: return 6;
+    case OBJ_MODEL: return 0;
+    }
+    return 0;
+}
+
+// Models pick one level for all their meshes, clamped per mesh when drawn
+static int objectLODCount(const SceneObject* obj) {
+    if (obj->object.type == OBJ_MODEL) {
+        int count = 1;
+        for (unsigned int i = 0; i < obj->object.data.model.meshCount; i++) {
+            int meshCount = obj->object.data.model.meshes[i].lods.count;
+            if (meshCount > count) count = meshCount;
+        }
+        return count;
+    }
+    const LODChain* lods = getObjectLODChain(obj);
+    return lods && lods->count > 0 ? lods->count : 1;
+}
+
+// Queues the object and everything below it for recomposition. A dirty object
+// always has dirty descendants, so an already dirty object can stop the walk.
+static void markTransformDirty(int index) {
+    if (objectManager.transformDirty[index]) return;
+    objectManager.transformDirty[index] = 1;
+
+    if (objectManager.dirtyCount == objectManager.dirtyCapacity) {
+        int capacity = objectManager.dirtyCapacity ? objectManager.dirtyCapacity * 2 : 64;
+        objectManager.dirtyObjects = (ObjectHandle*)growArray(objectManager.dirtyObjects, sizeof(ObjectHandle), capacity);
+        objectManager.dirtyCapacity = capacity;
+    }
+    objectManager.dirtyObjects[objectManager.dirtyCount++] = objectManager.handles[index];
+
+    for (ObjectHandle child = objectManager.objects[index].firstChild; child != INVALID_OBJECT_HANDLE;) {
+        int childIndex = getObjectIndex(child);
+        markTransformDirty(childIndex);
+        child = objectManager.objects[childIndex].nextSibling;
+    }
+}
+
+// Parents are resolved first, so each dirty object is composed exactly once
+static void updateWorldTransform(int index) {
+    if (!objectManager.transformDirty[index]) return;
+
+    SceneObject* obj = &objectManager.objects[index];
+    Matrix4x4* world = &objectManager.worldMatrices[index];
+    Matrix4x4 local = getObjectModelMatrix(obj);
+    int parent = getObjectIndex(obj->parent);
+    if (parent >= 0) {
+        updateWorldTransform(parent);
+        matrixMultiplyInto(&local, &objectManager.worldMatrices[parent], world);
+    }
+    else {
+        *world = local;
+    }
+
+    objectManager.normalMatrices[index] = normalMatrix(world);
+    objectManager.worldBounds[index] = transformAABB(getObjectLocalBounds(obj), world);
+    moveProxy(&sceneTree, obj->proxy, objectManager.worldBounds[index]);
+    objectManager.transformDirty[index] = 0;
+}
+
+// Recomposes the world data of every object edited since the last call. Static
+// scenes leave the dirty list empty and pay nothing here.
+void updateTransforms() {
+    for (int i = 0; i < objectManager.dirtyCount; i++) {
+        int index = getObjectIndex(objectManager.dirtyObjects[i]);
+        if (index >= 0) {
+            updateWorldTransform(index);
+        }
     }
+    objectManager.dirtyCount = 0;
 }
 
-void addObject(Camera* camera, ObjectType type, bool useTexture, int textureIndex, bool colorCreation, Model* model, PBRMaterial material, bool usePBR) {
-    if (objectManager.count >= MAX_OBJECTS) return;
+// Rebuilds the render data for objects[index] and queues its world transform.
+// Call after editing the record so rendering, culling and queries see the
+// change; the tree only restructures when the object leaves its fat box.
+void syncObject(int index) {
+    SceneObject* obj = &objectManager.objects[index];
+    markTransformDirty(index);
+
+    ObjectRenderState* state = &objectManager.renderStates[index];
+    state->vao = getObjectVAO(obj);
+    state->textureID = obj->object.textureID;
+    state->indexCount = objectIndexCount(obj);
+    state->type = (unsigned char)obj->object.type;
+    state->lodCount = (unsigned char)objectLODCount(obj);
+    if (objectManager.lodLevels[index] >= state->lodCount) {
+        objectManager.lodLevels[index] = 0;
+    }
+    state->flags = 0;
+    if (obj->object.useTexture) state->flags |= OBJECT_FLAG_TEXTURE;
+    if (obj->object.useColor) state->flags |= OBJECT_FLAG_COLOR;
+    if (obj->object.usePBR) state->flags |= OBJECT_FLAG_PBR;
+
+    objectManager.colors[index] = obj->color;
+    objectManager.materialRefs[index] = obj->object.usePBR ? getMaterialIndex(obj->object.material) : -1;
+}
 
+static void linkChild(SceneObject* parent, SceneObject* child) {
+    child->parent = parent->handle;
+    child->nextSibling = parent->firstChild;
+    parent->firstChild = child->handle;
+}
+
+static void unlinkFromParent(SceneObject* child) {
+    SceneObject* parent = getObject(child->parent);
+    if (parent) {
+        ObjectHandle* link = &parent->firstChild;
+        while (*link != INVALID_OBJECT_HANDLE && *link != child->handle) {
+            link = &getObject(*link)->nextSibling;
+        }
+        if (*link == child->handle) {
+            *link = child->nextSibling;
+        }
+    }
+    child->parent = INVALID_OBJECT_HANDLE;
+    child->nextSibling = INVALID_OBJECT_HANDLE;
+}
+
+// Attaches child under parent, or detaches it when parent is INVALID_OBJECT_HANDLE.
+// The child keeps its local transform, so it moves with its new parent.
+bool setObjectParent(ObjectHandle child, ObjectHandle parent) {
+    int childIndex = getObjectIndex(child);
+    int parentIndex = getObjectIndex(parent);
+    if (childIndex < 0 || (parent != INVALID_OBJECT_HANDLE && parentIndex < 0)) return false;
+
+    // Refuse cycles: the new parent may not be the child or one of its descendants
+    for (int i = parentIndex; i >= 0; i = getObjectIndex(objectManager.objects[i].parent)) {
+        if (i == childIndex) return false;
+    }
+
+    SceneObject* obj = &objectManager.objects[childIndex];
+    unlinkFromParent(obj);
+    if (parentIndex >= 0) {
+        linkChild(&objectManager.objects[parentIndex], obj);
+    }
+    markTransformDirty(childIndex);
+    return true;
+}
+
+ObjectHandle addObjectToManager(SceneObject newObject) {
+    static int currentID = 0; // Static variable to keep track of unique IDs
+    reserveObjects(objectManager.count + 1);
+
+    int index = objectManager.count++;
+    int slot = allocateSlot();
+    objectManager.slotIndices[slot] = index;
+
+    newObject.id = currentID++; // Assign a unique ID to the new object
+    newObject.handle = makeHandle(slot, objectManager.slotGenerations[slot]);
+    newObject.firstChild = INVALID_OBJECT_HANDLE;
+    newObject.nextSibling = INVALID_OBJECT_HANDLE;
+    retainGeometry(newObject.object.geometry); // The manager holds one reference per object
+    Matrix4x4 modelMatrix = getObjectModelMatrix(&newObject);
+    newObject.proxy = createProxy(&sceneTree, transformAABB(getObjectLocalBounds(&newObject), &modelMatrix), index);
+    objectManager.handles[index] = newObject.handle;
+    objectManager.transformDirty[index] = 0;
+    objectManager.lodLevels[index] = 0;
+
+    // Records restored from undo history rejoin their parent if it still exists
+    SceneObject* parent = getObject(newObject.parent);
+    newObject.parent = INVALID_OBJECT_HANDLE;
+    objectManager.objects[index] = newObject;
+    if (parent) {
+        linkChild(parent, &objectManager.objects[index]);
+    }
+    syncObject(index);
+    return newObject.handle;
+}
+
+ObjectHandle addObject(Camera* camera, ObjectType type, bool useTexture, int textureIndex, bool colorCreation, Model* model, PBRMaterial material, bool usePBR) {
     SceneObject newObject;
     newObject.object.type = type;
     newObject.object.useTexture = useTexture;
@@ -53,172 +323,267 @@ void addObject(Camera* camera, ObjectType type, bool useTexture, int textureInde
     newObject.scale = (Vector3){ 1.0f, 1.0f, 1.0f };
     newObject.color = (Vector4){ 1.0f, 1.0f, 1.0f, 1.0f }; // Default to white color
     newObject.selected = false;
+    newObject.parent = INVALID_OBJECT_HANDLE;
+
+    // Geometry is shared through the registry; each object only keeps copies of the handles
+    if (type == OBJ_MODEL) {
+        newObject.object.geometry = model ? acquireModelGeometry(model->path, MODEL_IMPORT_FLAGS) : INVALID_GEOMETRY;
+    }
+    else {
+        newObject.object.geometry = acquirePrimitiveGeometry(defaultPrimitiveParams(type));
+    }
+
+    const GeometryEntry* geometry = getGeometry(newObject.object.geometry);
+    if (!geometry) {
+        fprintf(stderr, "Failed to acquire geometry for object of type %d\n", type);
+        return INVALID_OBJECT_HANDLE;
+    }
 
     switch (type) {
     case OBJ_CUBE:
-        newObject.object.data.cube = createCube(newObject.position, newObject.color, 1.0f);
+        newObject.object.data.cube = geometry->data.cube;
+        newObject.object.data.cube.position = newObject.position;
         break;
     case OBJ_SPHERE:
-        newObject.object.data.sphere = createSphere(1.0f, 20, 20, newObject.position, newObject.color);
+        newObject.object.data.sphere = geometry->data.sphere;
+        newObject.object.data.sphere.position = newObject.position;
         break;
     case OBJ_PYRAMID:
-        newObject.object.data.pyramid = createPyramid(newObject.position, newObject.color, 1.0f, 1.0f);
+        newObject.object.data.pyramid = geometry->data.pyramid;
+        newObject.object.data.pyramid.position = newObject.position;
         break;
     case OBJ_CYLINDER:
-        newObject.object.data.cylinder = createCylinder(1.0f, 2.0f, 20, newObject.position, newObject.color);
+        newObject.object.data.cylinder = geometry->data.cylinder;
+        newObject.object.data.cylinder.position = newObject.position;
         break;
     case OBJ_PLANE:
-        newObject.object.data.plane = createPlane(newObject.position, newObject.color);
+        newObject.object.data.plane = geometry->data.plane;
+        newObject.object.data.plane.position = newObject.position;
         break;
     case OBJ_MODEL:
-        if (model) {
-            newObject.object.data.model = *model;
-            newObject.object.data.model.meshes = (Mesh*)malloc(model->meshCount * sizeof(Mesh));
-            for (unsigned int i = 0; i < model->meshCount; i++) {
-                newObject.object.data.model.meshes[i] = model->meshes[i];
-            }
-            newObject.object.data.model.meshCount = model->meshCount;
-        }
+        newObject.object.data.model = geometry->data.model;
         break;
     }
 
-    addObjectToManager(newObject);
+    ObjectHandle handle = addObjectToManager(newObject);
+    releaseGeometry(newObject.object.geometry);
+    return handle;
 }
 
+// Swaps the last object into the hole, so only that one object changes index
 void removeObject(int index) {
     if (index < 0 || index >= objectManager.count) {
         printf("Invalid index: %d\n", index);
         return;
     }
 
-    printf("Removing object at index: %d\n", index);
-
     SceneObject* obj = &objectManager.objects[index];
+    uint32_t slot = (uint32_t)(obj->handle & 0xFFFFFFFFu);
 
-    switch (obj->object.type) {
-    case OBJ_CUBE:
-        printf("Destroying cube at index: %d\n", index);
-        destroyCube(&obj->object.data.cube);
-        break;
-    case OBJ_SPHERE:
-        printf("Destroying sphere at index: %d\n", index);
-        destroySphere(&obj->object.data.sphere);
-        break;
-    case OBJ_PYRAMID:
-        printf("Destroying pyramid at index: %d\n", index);
-        destroyPyramid(&obj->object.data.pyramid);
-        break;
-    case OBJ_CYLINDER:
-        printf("Destroying cylinder at index: %d\n", index);
-        destroyCylinder(&obj->object.data.cylinder);
-        break;
-    case OBJ_PLANE:
-        printf("Destroying plane at index: %d\n", index);
-        destroyPlane(&obj->object.data.plane);
-        break;
-    case OBJ_MODEL:
-        printf("Freeing model at index: %d\n", index);
-        freeModel(&obj->object.data.model);
-        break;
-    default:
-        printf("Unknown object type at index: %d\n", index);
-        break;
-    }
+    // The mesh itself is destroyed once its last user lets go of it
+    releaseGeometry(obj->object.geometry);
+    destroyProxy(&sceneTree, obj->proxy);
 
-    // Shift objects down in the array to fill the gap
-    for (int i = index; i < objectManager.count - 1; ++i) {
-        objectManager.objects[i] = objectManager.objects[i + 1];
-        printf("Shifting object from index %d to %d\n", i + 1, i);
+    // Children outlive their parent and fall back to their local transform
+    unlinkFromParent(obj);
+    for (ObjectHandle child = obj->firstChild; child != INVALID_OBJECT_HANDLE;) {
+        int childIndex = getObjectIndex(child);
+        SceneObject* childObj = &objectManager.objects[childIndex];
+        child = childObj->nextSibling;
+        childObj->parent = INVALID_OBJECT_HANDLE;
+        childObj->nextSibling = INVALID_OBJECT_HANDLE;
+        markTransformDirty(childIndex);
     }
+    obj->firstChild = INVALID_OBJECT_HANDLE;
 
-    // Decrement the count of objects after shifting
-    objectManager.count--;
+    // Retire the handle; the generation bump invalidates every copy of it
+    objectManager.slotIndices[slot] = -1;
+    objectManager.slotGenerations[slot]++;
+    objectManager.freeSlots[objectManager.freeSlotCount++] = (int)slot;
 
-    // Clear the last object 
-    objectManager.objects[objectManager.count].id = -1;
-    printf("Object count after removal: %d\n", objectManager.count);
+    objectManager.revision++;
+    int last = --objectManager.count;
+    if (index != last) {
+        objectManager.objects[index] = objectManager.objects[last];
+        objectManager.handles[index] = objectManager.handles[last];
+        objectManager.worldMatrices[index] = objectManager.worldMatrices[last];
+        objectManager.normalMatrices[index] = objectManager.normalMatrices[last];
+        objectManager.worldBounds[index] = objectManager.worldBounds[last];
+        objectManager.transformDirty[index] = objectManager.transformDirty[last];
+        objectManager.renderStates[index] = objectManager.renderStates[last];
+        objectManager.colors[index] = objectManager.colors[last];
+        objectManager.materialRefs[index] = objectManager.materialRefs[last];
+        objectManager.lodLevels[index] = objectManager.lodLevels[last];
 
-    // Update selected object if necessary
-    if (selected_object == obj) {
-        selected_object = NULL;
-        printf("Selected object was removed. Clearing selection.\n");
+        uint32_t movedSlot = (uint32_t)(objectManager.handles[index] & 0xFFFFFFFFu);
+        objectManager.slotIndices[movedSlot] = index;
+        setProxyUserData(&sceneTree, objectManager.objects[index].proxy, index);
     }
 }
+
+void removeObjectByHandle(ObjectHandle handle) {
+    int index = getObjectIndex(handle);
+    if (index >= 0) {
+        removeObject(index);
+    }
+}
+
 void cleanupObjects() {
-    for (int i = 0; i < objectManager.count; i++) {
-        removeObject(i);
+    // Remove from the back so nothing is swapped
+    while (objectManager.count > 0) {
+        removeObject(objectManager.count - 1);
     }
-    objectManager.count = 0;
+    freeObjectStorage();
+    freeSpatialTree(&sceneTree);
 }
 
-void updateObjectInManager(SceneObject* updatedObject) {
-    for (int i = 0; i < objectManager.count; i++) {
-        if (objectManager.objects[i].id == updatedObject->id) {
-            objectManager.objects[i] = *updatedObject;
+// Copies an edited record back into the manager. The record may be the stored
+// object itself or a copy of it; the tree leaf and the hierarchy links always
+// come from the stored one, since only setObjectParent may change them.
+void updateObjectInManager(const SceneObject* updatedObject) {
+    int index = getObjectIndex(updatedObject->handle);
+    if (index < 0) return;
 
+    SceneObject* obj = &objectManager.objects[index];
+    if (obj != updatedObject) {
+        SceneObject live = *obj;
+        *obj = *updatedObject;
+        obj->proxy = live.proxy;
+        obj->parent = live.parent;
+        obj->firstChild = live.firstChild;
+        obj->nextSibling = live.nextSibling;
+    }
+    syncObject(index);
+}
 
-            printf("Updated object in manager: ID=%d, Index=%d\n", updatedObject->id, i);
+typedef struct {
+    AABB box;
+    Vector3 point;
+    float radius;
+    bool sphere;
+    int* indices;
+    int count;
+    int maxCount;
+} ObjectQuery;
 
-            // Update the selected_object pointer if necessary
-            if (selected_object && selected_object->id == updatedObject->id) {
-                selected_object = &objectManager.objects[i];
-            }
-            break;
-        }
+// The tree reports fat-box overlaps; confirm against the tight world bounds
+static bool collectObject(int index, void* context) {
+    ObjectQuery* query = (ObjectQuery*)context;
+    AABB bounds = objectManager.worldBounds[index];
+    if (query->sphere) {
+        Vector3 closest = {
+            fmaxf(bounds.min.x, fminf(query->point.x, bounds.max.x)),
+            fmaxf(bounds.min.y, fminf(query->point.y, bounds.max.y)),
+            fmaxf(bounds.min.z, fminf(query->point.z, bounds.max.z))
+        };
+        Vector3 offset = vector_sub(closest, query->point);
+        if (vector_dot(offset, offset) > query->radius * query->radius) return true;
+    }
+    else if (bounds.min.x > query->box.max.x || bounds.max.x < query->box.min.x
+        || bounds.min.y > query->box.max.y || bounds.max.y < query->box.min.y
+        || bounds.min.z > query->box.max.z || bounds.max.z < query->box.min.z) {
+        return true;
+    }
+
+    query->indices[query->count++] = index;
+    return query->count < query->maxCount;
+}
+
+int findObjectsInBox(AABB box, int* indices, int maxCount) {
+    ObjectQuery query = { box, { 0.0f, 0.0f, 0.0f }, 0.0f, false, indices, 0, maxCount };
+    if (maxCount <= 0) return 0;
+    updateTransforms();
+    querySpatialBox(&sceneTree, box, collectObject, &query);
+    return query.count;
+}
+
+int findObjectsNear(Vector3 point, float radius, int* indices, int maxCount) {
+    Vector3 reach = { radius, radius, radius };
+    ObjectQuery query = { makeAABB(vector_sub(point, reach), vector_add(point, reach)), point, radius, true, indices, 0, maxCount };
+    if (maxCount <= 0) return 0;
+    updateTransforms();
+    querySpatialBox(&sceneTree, query.box, collectObject, &query);
+    return query.count;
+}
+
+// Vertex array used for the object's first draw, for sorting and batching
+GLuint getObjectVAO(const SceneObject* obj) {
+    switch (obj->object.type) {
+    case OBJ_CUBE: return obj->object.data.cube.vao;
+    case OBJ_SPHERE: return obj->object.data.sphere.vao;
+    case OBJ_PYRAMID: return obj->object.data.pyramid.vao;
+    case OBJ_CYLINDER: return obj->object.data.cylinder.vao;
+    case OBJ_PLANE: return obj->object.data.plane.vao;
+    case OBJ_MODEL:
+        return obj->object.data.model.meshCount > 0 ? obj->object.data.model.meshes[0].VAO : 0;
+    }
+    return 0;
+}
+
+// Bounds of the object's geometry before its transform is applied
+AABB getObjectLocalBounds(const SceneObject* obj) {
+    switch (obj->object.type) {
+    case OBJ_CUBE: return obj->object.data.cube.bounds;
+    case OBJ_SPHERE: return obj->object.data.sphere.bounds;
+    case OBJ_PYRAMID: return obj->object.data.pyramid.bounds;
+    case OBJ_CYLINDER: return obj->object.data.cylinder.bounds;
+    case OBJ_PLANE: return obj->object.data.plane.bounds;
+    case OBJ_MODEL: return obj->object.data.model.bounds;
     }
+    return emptyAABB();
 }
 
-void drawObject(const SceneObject* obj, const Matrix4x4 viewMatrix, const Matrix4x4 projMatrix) {
-    glUseProgram(shaderProgram);
+// Detail levels of a primitive's shared mesh; NULL for single-level primitives and
+// models, whose chains are per mesh
+const LODChain* getObjectLODChain(const SceneObject* obj) {
+    switch (obj->object.type) {
+    case OBJ_SPHERE: return &obj->object.data.sphere.lods;
+    case OBJ_CYLINDER: return &obj->object.data.cylinder.lods;
+    default: return NULL;
+    }
+}
 
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
+// Transform relative to the parent; the world matrix lives in objectManager.worldMatrices
+Matrix4x4 getObjectModelMatrix(const SceneObject* obj) {
+    return composeTransform(obj->position, obj->rotation, obj->scale);
+}
 
-    Matrix4x4 modelMatrix = translateMatrix(obj->position);
-    modelMatrix = matrixMultiply(modelMatrix, rotateMatrix(obj->rotation.x, (Vector3) { 1.0f, 0.0f, 0.0f }));
-    modelMatrix = matrixMultiply(modelMatrix, rotateMatrix(obj->rotation.y, (Vector3) { 0.0f, 1.0f, 0.0f }));
-    modelMatrix = matrixMultiply(modelMatrix, rotateMatrix(obj->rotation.z, (Vector3) { 0.0f, 0.0f, 1.0f }));
-    modelMatrix = matrixMultiply(modelMatrix, scaleMatrix(obj->scale));
+// View and projection come from the shared camera block
+void drawObject(int index) {
+    drawObjectAt(index, &objectManager.worldMatrices[index], &objectManager.normalMatrices[index], objectManager.lodLevels[index]);
+}
+
+void drawObjectAt(int index, const Matrix4x4* world, const Matrix3x3* normal, int lod) {
+    const ObjectRenderState* state = &objectManager.renderStates[index];
+    const Vector4 color = objectManager.colors[index];
 
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, &modelMatrix.data[0][0]);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &viewMatrix.data[0][0]);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, &projMatrix.data[0][0]);
+    stateUseProgram(shaderProgram.id);
 
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
-    glUniform4f(colorLoc, obj->color.x, obj->color.y, obj->color.z, obj->color.w);
+    glUniformMatrix4fv(shaderProgram.slots[UNIFORM_MODEL], 1, GL_FALSE, &world->data[0][0]);
+    glUniformMatrix3fv(shaderProgram.slots[UNIFORM_NORMAL_MATRIX], 1, GL_FALSE, &normal->data[0][0]);
 
-    if (obj->object.useTexture) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, obj->object.textureID);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], color.x, color.y, color.z, color.w);
+
+    if (state->flags & OBJECT_FLAG_TEXTURE) {
+        stateBindTexture(0, GL_TEXTURE_2D, state->textureID);
     }
 
-    switch (obj->object.type) {
-    case OBJ_CUBE:
-        glBindVertexArray(obj->object.data.cube.vao);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        break;
-    case OBJ_SPHERE:
-        glBindVertexArray(obj->object.data.sphere.vao);
-        glDrawElements(GL_TRIANGLES, obj->object.data.sphere.numIndices, GL_UNSIGNED_INT, 0);
-        break;
-    case OBJ_PYRAMID:
-        glBindVertexArray(obj->object.data.pyramid.vao);
-        glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0);
-        break;
-    case OBJ_CYLINDER:
-        glBindVertexArray(obj->object.data.cylinder.vao);
-        glDrawElements(GL_TRIANGLES, obj->object.data.cylinder.sectorCount * 12, GL_UNSIGNED_INT, 0);
-        break;
-    case OBJ_PLANE:
-        glBindVertexArray(obj->object.data.plane.vao);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        break;
-    case OBJ_MODEL:
-        for (unsigned int i = 0; i < obj->object.data.model.meshCount; i++) {
-            drawMesh(&obj->object.data.model.meshes[i]);
+    if (state->type == OBJ_MODEL) {
+        const Model* model = &objectManager.objects[index].object.data.model;
+        for (unsigned int i = 0; i < model->meshCount; i++) {
+            drawMeshLOD(&model->meshes[i], lod);
         }
-        break;
+        return;
+    }
+
+    stateBindVertexArray(state->vao);
+    const LODChain* lods = getObjectLODChain(&objectManager.objects[index]);
+    if (lods && lod > 0 && lod < lods->count) {
+        const LODLevel* level = &lods->levels[lod];
+        glDrawElements(GL_TRIANGLES, level->indexCount, GL_UNSIGNED_INT, (void*)(level->indexOffset * sizeof(unsigned int)));
+        stateCountDraw(level->indexCount, 1);
+        return;
     }
-    glBindVertexArray(0);
+    glDrawElements(GL_TRIANGLES, state->indexCount, GL_UNSIGNED_INT, 0);
+    stateCountDraw(state->indexCount, 1);
 }
@@ -24,6 +24,7 @@
 #include "Vectors.h"
 #include "Camera.h"
 #include "ObjectManager.h"
+#include "profiler.h"
 
 namespace StellAI {
 
@@ -93,6 +94,7 @@ TerrainGenerator::~TerrainGenerator() {
 }
 
 Model* TerrainGenerator::generateTerrain(const TerrainParams& params) {
+    PROFILE_SCOPE("generateTerrain");
     // Simple placeholder implementation that creates a heightmap-based terrain
     // This will be replaced with AI-driven terrain generation
     
@@ -293,6 +295,7 @@ ModelGenerator::~ModelGenerator() {
 }
 
 Model* ModelGenerator::generateFromText(const ModelGenParams& params) {
+    PROFILE_SCOPE("generateFromText");
     std::cout << "Generating 3D model from text: \"" << params.prompt << "\"" << std::endl;
     
     // In a real implementation, this would call an AI model to generate a 3D model
@@ -420,6 +423,7 @@ Model* ModelGenerator::generateFromText(const ModelGenParams& params) {
 }
 
 PBRMaterial ModelGenerator::generateMaterial(Model* model, const std::string& description) {
+    PROFILE_SCOPE("generateMaterial");
     std::cout << "Generating PBR material from description: \"" << description << "\"" << std::endl;
     
     // In a real implementation, this would use AI to generate material maps based on the description
@@ -459,6 +463,7 @@ ShaderGenerator::~ShaderGenerator() {
 }
 
 std::pair<std::string, std::string> ShaderGenerator::generateShader(const ShaderGenParams& params) {
+    PROFILE_SCOPE("generateShader");
     std::cout << "Generating shader for effect: \"" << params.effect << "\"" << std::endl;
     
     // In a real implementation, this would use AI to generate shader code based on the description
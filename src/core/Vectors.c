@@ -1,5 +1,7 @@
 #include "Vectors.h"
+#include "simd.h"
 #include <math.h>
+
 Vector4 vector4(float x, float y, float z, float w) {
 	Vector4 v;
 	v.x = x;
@@ -30,7 +32,7 @@ Vector3 vector_sub(Vector3 a, Vector3 b) {
 }
 
 Vector3 vector_normalize(Vector3 v) {
-	float mag = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+	float mag = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
 	return (Vector3) { v.x / mag, v.y / mag, v.z / mag };
 }
 
@@ -63,5 +65,53 @@ Vector3 reflect(Vector3 I, Vector3 N) {
 }
 
 float vector_length(Vector3 v) {
-	return sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+	return sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+void vector_normalize_array(const Vector3* in, Vector3* out, int count) {
+	int i = 0;
+#ifdef STELLAI_SIMD_SSE
+	for (; i + 4 <= count; i += 4) {
+		__m128 x, y, z;
+		loadVector3x4(in + i, &x, &y, &z);
+		__m128 mag = _mm_sqrt_ps(simdMulAdd(z, z, simdMulAdd(y, y, _mm_mul_ps(x, x))));
+		storeVector3x4(out + i, _mm_div_ps(x, mag), _mm_div_ps(y, mag), _mm_div_ps(z, mag));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = vector_normalize(in[i]);
+	}
+}
+
+void vector_dot_array(const Vector3* a, const Vector3* b, float* out, int count) {
+	int i = 0;
+#ifdef STELLAI_SIMD_SSE
+	for (; i + 4 <= count; i += 4) {
+		__m128 ax, ay, az, bx, by, bz;
+		loadVector3x4(a + i, &ax, &ay, &az);
+		loadVector3x4(b + i, &bx, &by, &bz);
+		_mm_storeu_ps(out + i, simdMulAdd(az, bz, simdMulAdd(ay, by, _mm_mul_ps(ax, bx))));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = vector_dot(a[i], b[i]);
+	}
+}
+
+void vector_cross_array(const Vector3* a, const Vector3* b, Vector3* out, int count) {
+	int i = 0;
+#ifdef STELLAI_SIMD_SSE
+	for (; i + 4 <= count; i += 4) {
+		__m128 ax, ay, az, bx, by, bz;
+		loadVector3x4(a + i, &ax, &ay, &az);
+		loadVector3x4(b + i, &bx, &by, &bz);
+		__m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+		__m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+		__m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+		storeVector3x4(out + i, cx, cy, cz);
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = vector_cross(a[i], b[i]);
+	}
 }
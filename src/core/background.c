@@ -5,8 +5,11 @@
 #include "Camera.h"
 #include "background.h"
 #include "SOIL2/SOIL2.h"
+#include "glstate.h"
+#include "profiler.h"
 #include <stdio.h>
-GLuint skyboxVAO, skyboxVBO, skyboxShader, skyboxTexture;
+GLuint skyboxVAO, skyboxVBO, skyboxTexture;
+ShaderProgram skyboxShader;
 extern float skyboxVertices[108];
 // Define the background names
 const char* backgroundNames[] = {
@@ -23,9 +26,10 @@ const char* backgroundNames[] = {
 // Define the number of backgrounds
 const int backgroundCount = sizeof(backgroundNames) / sizeof(backgroundNames[0]);
 GLuint loadCubemap(const char* faceFiles[6]) {
+    PROFILE_BEGIN("loadCubemap");
     GLuint textureID;
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    stateBindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
 
     int width, height, channels;
     for (int i = 0; i < 6; i++) {
@@ -45,6 +49,7 @@ GLuint loadCubemap(const char* faceFiles[6]) {
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
+    PROFILE_END();
     return textureID;
 }
 
@@ -101,7 +106,7 @@ void initSkybox(int backgroundIndex) {
 
     // Generate and bind the VAO and VBO
     glGenVertexArrays(1, &skyboxVAO);
-    glBindVertexArray(skyboxVAO);
+    stateBindVertexArray(skyboxVAO);
 
     glGenBuffers(1, &skyboxVBO);
     glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
@@ -128,33 +133,22 @@ void initSkybox(int backgroundIndex) {
         return;
     }
 
+    deleteShader(&skyboxShader);
     skyboxShader = loadShader("shaders/skybox/skyboxVertex.glsl", "shaders/skybox/skyboxFragment.glsl");
-    if (skyboxShader == 0) {
+    if (skyboxShader.id == 0) {
         fprintf(stderr, "Failed to load skybox shader\n");
         return;
     }
 }
 
-void drawSkybox(const Camera* camera, const Matrix4x4* projMatrix) {
-    glDepthMask(GL_FALSE); // Disable depth write
-    glUseProgram(skyboxShader);
+// The translation-free view and the projection come from the shared camera block
+void drawSkybox() {
+    stateDepthMask(GL_FALSE); // Disable depth write
+    stateUseProgram(skyboxShader.id);
 
-    // Create a view matrix for the skybox (remove translation)
-    Matrix4x4 viewMatrixSkybox = getViewMatrix((Camera*)camera);
-    viewMatrixSkybox.data[3][0] = 0;
-    viewMatrixSkybox.data[3][1] = 0;
-    viewMatrixSkybox.data[3][2] = 0;
-
-    // Set the uniform for the view and projection matrices
-    glUniformMatrix4fv(glGetUniformLocation(skyboxShader, "view"), 1, GL_FALSE, &viewMatrixSkybox.data[0][0]);
-    glUniformMatrix4fv(glGetUniformLocation(skyboxShader, "projection"), 1, GL_FALSE, &projMatrix->data[0][0]);
-
-    glBindVertexArray(skyboxVAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
-    glUniform1i(glGetUniformLocation(skyboxShader, "skybox"), 0);
+    stateBindVertexArray(skyboxVAO);
+    stateBindTexture(0, GL_TEXTURE_CUBE_MAP, skyboxTexture);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-    glUseProgram(0);
-    glDepthMask(GL_TRUE); // Re-enable depth write
+    stateCountDraw(36, 1);
+    stateDepthMask(GL_TRUE); // Re-enable depth write
 }
\ No newline at end of file
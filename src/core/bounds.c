@@ -0,0 +1,94 @@
+#include "bounds.h"
+#include <float.h>
+
+AABB emptyAABB() {
+    AABB box = {
+        { FLT_MAX, FLT_MAX, FLT_MAX },
+        { -FLT_MAX, -FLT_MAX, -FLT_MAX }
+    };
+    return box;
+}
+
+AABB makeAABB(Vector3 min, Vector3 max) {
+    AABB box = { min, max };
+    return box;
+}
+
+bool isAABBEmpty(AABB box) {
+    return box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z;
+}
+
+void expandAABB(AABB* box, Vector3 point) {
+    box->min.x = fminf(box->min.x, point.x);
+    box->min.y = fminf(box->min.y, point.y);
+    box->min.z = fminf(box->min.z, point.z);
+    box->max.x = fmaxf(box->max.x, point.x);
+    box->max.y = fmaxf(box->max.y, point.y);
+    box->max.z = fmaxf(box->max.z, point.z);
+}
+
+AABB mergeAABB(AABB a, AABB b) {
+    if (isAABBEmpty(b)) return a;
+    expandAABB(&a, b.min);
+    expandAABB(&a, b.max);
+    return a;
+}
+
+// Transforms the center and projects the extents onto the world axes (Arvo's method),
+// which gives the tightest box around the transformed box without visiting its corners
+AABB transformAABB(AABB box, const Matrix4x4* transform) {
+    if (isAABBEmpty(box)) return box;
+
+    Vector3 center = aabbCenter(box);
+    Vector3 extents = aabbExtents(box);
+    const float (*m)[4] = transform->data;
+
+    Vector3 worldCenter = {
+        m[0][0] * center.x + m[1][0] * center.y + m[2][0] * center.z + m[3][0],
+        m[0][1] * center.x + m[1][1] * center.y + m[2][1] * center.z + m[3][1],
+        m[0][2] * center.x + m[1][2] * center.y + m[2][2] * center.z + m[3][2]
+    };
+    Vector3 worldExtents = {
+        fabsf(m[0][0]) * extents.x + fabsf(m[1][0]) * extents.y + fabsf(m[2][0]) * extents.z,
+        fabsf(m[0][1]) * extents.x + fabsf(m[1][1]) * extents.y + fabsf(m[2][1]) * extents.z,
+        fabsf(m[0][2]) * extents.x + fabsf(m[1][2]) * extents.y + fabsf(m[2][2]) * extents.z
+    };
+
+    return makeAABB(vector_sub(worldCenter, worldExtents), vector_add(worldCenter, worldExtents));
+}
+
+Vector3 aabbCenter(AABB box) {
+    return vector_scale(vector_add(box.min, box.max), 0.5f);
+}
+
+Vector3 aabbExtents(AABB box) {
+    return vector_scale(vector_sub(box.max, box.min), 0.5f);
+}
+
+Ray makeRay(Vector3 origin, Vector3 direction) {
+    Ray ray = { origin, direction, { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z } };
+    return ray;
+}
+
+// Slab test. Zero direction components give infinite reciprocals, which the
+// min/max below handle as long as the origin is not exactly on a slab plane.
+bool intersectRayAABB(const Ray* ray, AABB box, float maxDistance, float* hitDistance) {
+    float tx1 = (box.min.x - ray->origin.x) * ray->invDirection.x;
+    float tx2 = (box.max.x - ray->origin.x) * ray->invDirection.x;
+    float tmin = fminf(tx1, tx2);
+    float tmax = fmaxf(tx1, tx2);
+
+    float ty1 = (box.min.y - ray->origin.y) * ray->invDirection.y;
+    float ty2 = (box.max.y - ray->origin.y) * ray->invDirection.y;
+    tmin = fmaxf(tmin, fminf(ty1, ty2));
+    tmax = fminf(tmax, fmaxf(ty1, ty2));
+
+    float tz1 = (box.min.z - ray->origin.z) * ray->invDirection.z;
+    float tz2 = (box.max.z - ray->origin.z) * ray->invDirection.z;
+    tmin = fmaxf(tmin, fminf(tz1, tz2));
+    tmax = fminf(tmax, fmaxf(tz1, tz2));
+
+    if (tmax < fmaxf(tmin, 0.0f) || tmin > maxDistance) return false;
+    if (hitDistance) *hitDistance = fmaxf(tmin, 0.0f);
+    return true;
+}
@@ -5,6 +5,7 @@
 #include "ObjectManager.h" 
 #include "Vectors.h"
 #include "materials.h" 
+#include "gui.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -19,9 +20,11 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 void updateCameraVectors(Camera* camera) {
     Vector3 front;
-    front.x = cos(M_PI / 180.0 * camera->Yaw) * cos(M_PI / 180.0 * camera->Pitch);
-    front.y = sin(M_PI / 180.0 * camera->Pitch);
-    front.z = sin(M_PI / 180.0 * camera->Yaw) * cos(M_PI / 180.0 * camera->Pitch);
+    float yaw = camera->Yaw * (float)M_PI / 180.0f;
+    float pitch = camera->Pitch * (float)M_PI / 180.0f;
+    front.x = cosf(yaw) * cosf(pitch);
+    front.y = sinf(pitch);
+    front.z = sinf(yaw) * cosf(pitch);
     camera->Front = vector_normalize(front);
     camera->Right = vector_normalize(vector_cross(camera->Front, camera->WorldUp));
     camera->Up = vector_normalize(vector_cross(camera->Right, camera->Front));
@@ -54,9 +57,12 @@ void initCamera(Camera* camera) {
     camera->invertY = false;
     camera->mode = CAMERA_MODE_ORBIT; 
     updateCameraVectors(camera);
-    glfwSetMouseButtonCallback(screen.window, mouse_button_callback);
-    glfwSetCursorPosCallback(screen.window, cursor_position_callback);
-    glfwSetScrollCallback(screen.window, scroll_callback);
+    // Headless runs have no window to receive input from
+    if (screen.window) {
+        glfwSetMouseButtonCallback(screen.window, mouse_button_callback);
+        glfwSetCursorPosCallback(screen.window, cursor_position_callback);
+        glfwSetScrollCallback(screen.window, scroll_callback);
+    }
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
@@ -64,6 +70,11 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
         isPanning = true;
         glfwGetCursorPos(window, &lastX, &lastY);
     }
+    else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        pick_object_at_cursor(x, y);
+    }
     else if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) {
         isPanning = false;
     }
@@ -149,99 +160,3 @@ Matrix4x4 getViewMatrix(Camera* camera) {
 Matrix4x4 getProjectionMatrix(float fov, float aspectRatio, float nearPlane, float farPlane) {
     return perspective(fov, aspectRatio, nearPlane, farPlane);
 }
-
-Matrix4x4 translateMatrix(Vector3 position) {
-    Matrix4x4 mat = { 0 };
-    for (int i = 0; i < 4; i++) {
-        mat.data[i][i] = 1.0f;
-    }
-    mat.data[3][0] = position.x;
-    mat.data[3][1] = position.y;
-    mat.data[3][2] = position.z;
-    return mat;
-}
-
-Matrix4x4 rotateMatrix(float angle, Vector3 axis) {
-    Matrix4x4 mat = { 0 };
-    float rad = angle * M_PI / 180.0f;
-    float c = cos(rad);
-    float s = sin(rad);
-    Vector3 norm = vector_normalize(axis);
-    mat.data[0][0] = c + norm.x * norm.x * (1 - c);
-    mat.data[0][1] = norm.x * norm.y * (1 - c) - norm.z * s;
-    mat.data[0][2] = norm.x * norm.z * (1 - c) + norm.y * s;
-    mat.data[1][0] = norm.y * norm.x * (1 - c) + norm.z * s;
-    mat.data[1][1] = c + norm.y * norm.y * (1 - c);
-    mat.data[1][2] = norm.y * norm.z * (1 - c) - norm.x * s;
-    mat.data[2][0] = norm.z * norm.x * (1 - c) - norm.y * s;
-    mat.data[2][1] = norm.z * norm.y * (1 - c) + norm.x * s;
-    mat.data[2][2] = c + norm.z * norm.z * (1 - c);
-    mat.data[3][3] = 1.0f;
-    return mat;
-}
-
-Matrix4x4 scaleMatrix(Vector3 scale) {
-    Matrix4x4 mat = { 0 };
-    mat.data[0][0] = scale.x;
-    mat.data[1][1] = scale.y;
-    mat.data[2][2] = scale.z;
-    mat.data[3][3] = 1.0f;
-    return mat;
-}
-
-Matrix4x4 matrixMultiply(Matrix4x4 a, Matrix4x4 b) {
-    Matrix4x4 result = { 0 };
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            result.data[i][j] = 0;
-            for (int k = 0; k < 4; k++) {
-                result.data[i][j] += a.data[i][k] * b.data[k][j];
-            }
-        }
-    }
-    return result;
-}
-
-Matrix4x4 lookAt(Vector3 eye, Vector3 center, Vector3 up) {
-    Vector3 f = vector_normalize(vector_sub(center, eye));
-    Vector3 s = vector_normalize(vector_cross(f, up));
-    Vector3 u = vector_cross(s, f);
-
-    Matrix4x4 result = { 0 };
-    result.data[0][0] = s.x;
-    result.data[1][0] = s.y;
-    result.data[2][0] = s.z;
-    result.data[0][1] = u.x;
-    result.data[1][1] = u.y;
-    result.data[2][1] = u.z;
-    result.data[0][2] = -f.x;
-    result.data[1][2] = -f.y;
-    result.data[2][2] = -f.z;
-    result.data[3][0] = -vector_dot(s, eye);
-    result.data[3][1] = -vector_dot(u, eye);
-    result.data[3][2] = vector_dot(f, eye);
-    result.data[3][3] = 1.0f;
-    return result;
-}
-
-
-Matrix4x4 perspective(float fov, float aspect, float znear, float zfar) {
-    Matrix4x4 m = { 0 };
-    float tanHalfFovy = tan(fov / 2.0f);
-    m.data[0][0] = 1.0f / (aspect * tanHalfFovy);
-    m.data[1][1] = 1.0f / tanHalfFovy;
-    m.data[2][2] = -(zfar + znear) / (zfar - znear);
-    m.data[2][3] = -1.0f;
-    m.data[3][2] = -(2.0f * zfar * znear) / (zfar - znear);
-    return m;
-}
-
-Matrix4x4 identityMatrix() {
-    Matrix4x4 result = { .data = {
-        {1, 0, 0, 0},
-        {0, 1, 0, 0},
-        {0, 0, 1, 0},
-        {0, 0, 0, 1}
-    } };
-    return result;
-}
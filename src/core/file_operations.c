@@ -5,6 +5,8 @@
 #include "ObjectManager.h"
 #include "lightshading.h"
 #include "SceneObject.h"
+#include "geometry.h"
+#include "actions.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -89,6 +91,8 @@ void save_project() {
         cJSON_AddNumberToObject(jsonObject, "textureID", obj->object.textureID);
         cJSON_AddNumberToObject(jsonObject, "usePBR", obj->object.usePBR);
         cJSON_AddStringToObject(jsonObject, "materialName", getMaterialName(&obj->object.material));
+        // Objects are saved in storage order, so the parent's index is its position in this array
+        cJSON_AddNumberToObject(jsonObject, "parent", getObjectIndex(obj->parent));
 
         if (obj->object.type == OBJ_MODEL) {
             cJSON_AddStringToObject(jsonObject, "modelPath", obj->object.data.model.path);
@@ -187,10 +191,15 @@ void load_project() {
         return;
     }
 
-    FILE* file = fopen(loadPath, "r");
+    load_project_from_file(loadPath);
+}
+
+// Replaces the scene with the objects, lights and camera saved at path
+bool load_project_from_file(const char* path) {
+    FILE* file = fopen(path, "r");
     if (!file) {
-        fprintf(stderr, "Failed to open file.\n");
-        return;
+        fprintf(stderr, "Failed to open %s.\n", path);
+        return false;
     }
 
     fseek(file, 0, SEEK_END);
@@ -201,7 +210,7 @@ void load_project() {
     if (!jsonString) {
         fprintf(stderr, "Failed to allocate memory for JSON string.\n");
         fclose(file);
-        return;
+        return false;
     }
 
     fread(jsonString, 1, length, file);
@@ -212,10 +221,11 @@ void load_project() {
     if (!root) {
         fprintf(stderr, "Failed to parse JSON file.\n");
         free(jsonString);
-        return;
+        return false;
     }
 
-    // Clear current objects and lights
+    // Clear current objects and lights; the undo history refers to the old scene
+    clearActionStacks();
     cleanupObjects();
     lightCount = 0;
 
@@ -223,6 +233,13 @@ void load_project() {
     cJSON* objectsArray = cJSON_GetObjectItem(root, "objects");
     if (objectsArray) {
         int arraySize = cJSON_GetArraySize(objectsArray);
+        ObjectHandle* loaded = (ObjectHandle*)calloc(arraySize > 0 ? arraySize : 1, sizeof(ObjectHandle));
+        if (!loaded) {
+            fprintf(stderr, "Failed to allocate memory for loaded objects.\n");
+            cJSON_Delete(root);
+            free(jsonString);
+            return false;
+        }
         for (int i = 0; i < arraySize; i++) {
             cJSON* jsonObject = cJSON_GetArrayItem(objectsArray, i);
 
@@ -261,24 +278,43 @@ void load_project() {
 
             if (type == OBJ_MODEL) {
                 const char* modelPath = cJSON_GetObjectItem(jsonObject, "modelPath")->valuestring;
-                Model* model = loadModel(modelPath);
-                if (model) {
-                    addObject(&camera, type, useTexture, textureID, true, model, *material, usePBR);
+                // Objects referencing the same file share one import
+                int geometry = acquireModelGeometry(modelPath, MODEL_IMPORT_FLAGS);
+                const GeometryEntry* entry = getGeometry(geometry);
+                if (entry) {
+                    loaded[i] = addObject(&camera, type, useTexture, textureID, true, (Model*)&entry->data.model, *material, usePBR);
+                    releaseGeometry(geometry);
                 }
                 else {
                     printf("Error: Failed to load model from path: %s\n", modelPath);
+                    continue;
                 }
             }
             else {
-                addObject(&camera, type, useTexture, textureID, true, NULL, *material, usePBR);
+                loaded[i] = addObject(&camera, type, useTexture, textureID, true, NULL, *material, usePBR);
             }
 
-            SceneObject* newObj = &objectManager.objects[objectManager.count - 1];
+            int index = getObjectIndex(loaded[i]);
+            if (index < 0) {
+                continue;
+            }
+            SceneObject* newObj = &objectManager.objects[index];
             newObj->position = position;
             newObj->rotation = rotation;
             newObj->scale = scale;
             newObj->color = color;
+            syncObject(index);
+        }
+
+        // Parents may come later in the file, so link once everything exists
+        for (int i = 0; i < arraySize; i++) {
+            cJSON* parentItem = cJSON_GetObjectItem(cJSON_GetArrayItem(objectsArray, i), "parent");
+            int parent = parentItem ? parentItem->valueint : -1;
+            if (parent >= 0 && parent < arraySize) {
+                setObjectParent(loaded[i], loaded[parent]);
+            }
         }
+        free(loaded);
     }
 
     // Load Lights
@@ -338,13 +374,15 @@ void load_project() {
 
     cJSON_Delete(root);
     free(jsonString);
+    return true;
 }
 
 
 void new_project() {
+    clearActionStacks();
     cleanupObjects();
     lightCount = 0;
-    selected_object = NULL; // Reset the selected object
+    selected_handle = INVALID_OBJECT_HANDLE; // Reset the selected object
 
     // Optionally reset other state variables as needed
     camera.Position = (Vector3){ 0.0f, 0.0f, 3.0f };
@@ -0,0 +1,175 @@
+#include "geometry.h"
+#include "ModelLoad.h"
+#include "glstate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static GeometryEntry* entries = NULL;
+static int entryCount = 0;
+static int entryCapacity = 0;
+
+// Parameters addObject has always used for each built-in primitive
+PrimitiveParams defaultPrimitiveParams(ObjectType type) {
+    PrimitiveParams params = { type, 1.0f, 0.0f, 0, 0 };
+    switch (type) {
+    case OBJ_SPHERE:
+        params.sectors = 20;
+        params.stacks = 20;
+        break;
+    case OBJ_PYRAMID:
+        params.height = 1.0f;
+        break;
+    case OBJ_CYLINDER:
+        params.height = 2.0f;
+        params.sectors = 20;
+        break;
+    default:
+        break;
+    }
+    return params;
+}
+
+static bool sameParams(const PrimitiveParams* a, const PrimitiveParams* b) {
+    return a->type == b->type && a->size == b->size && a->height == b->height
+        && a->sectors == b->sectors && a->stacks == b->stacks;
+}
+
+static int allocateEntry() {
+    for (int i = 0; i < entryCount; i++) {
+        if (!entries[i].used) return i;
+    }
+    if (entryCount == entryCapacity) {
+        int newCapacity = entryCapacity ? entryCapacity * 2 : 32;
+        GeometryEntry* grown = (GeometryEntry*)realloc(entries, newCapacity * sizeof(GeometryEntry));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow geometry registry.\n");
+            return INVALID_GEOMETRY;
+        }
+        entries = grown;
+        entryCapacity = newCapacity;
+    }
+    return entryCount++;
+}
+
+int acquirePrimitiveGeometry(PrimitiveParams params) {
+    if (params.type == OBJ_MODEL) return INVALID_GEOMETRY;
+
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].used && sameParams(&entries[i].params, &params)) {
+            entries[i].refCount++;
+            return i;
+        }
+    }
+
+    int handle = allocateEntry();
+    if (handle == INVALID_GEOMETRY) return INVALID_GEOMETRY;
+
+    GeometryEntry* entry = &entries[handle];
+    memset(entry, 0, sizeof(*entry));
+    entry->params = params;
+
+    // Vertex data is generated around the origin; placement comes from the model matrix
+    Vector3 origin = { 0.0f, 0.0f, 0.0f };
+    Vector4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+    switch (params.type) {
+    case OBJ_CUBE:
+        entry->data.cube = createCube(origin, white, params.size);
+        break;
+    case OBJ_SPHERE:
+        entry->data.sphere = createSphere(params.size, params.sectors, params.stacks, origin, white);
+        break;
+    case OBJ_PYRAMID:
+        entry->data.pyramid = createPyramid(origin, white, params.size, params.height);
+        break;
+    case OBJ_CYLINDER:
+        entry->data.cylinder = createCylinder(params.size, params.height, params.sectors, origin, white);
+        break;
+    case OBJ_PLANE:
+        entry->data.plane = createPlane(origin, white);
+        break;
+    default:
+        return INVALID_GEOMETRY;
+    }
+
+    entry->used = true;
+    entry->refCount = 1;
+    return handle;
+}
+
+int acquireModelGeometry(const char* path, unsigned int importFlags) {
+    if (!path || path[0] == '\0') return INVALID_GEOMETRY;
+
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].used && entries[i].importFlags == importFlags && strcmp(entries[i].path, path) == 0) {
+            entries[i].refCount++;
+            return i;
+        }
+    }
+
+    Model* model = loadModelWithFlags(path, importFlags);
+    if (!model) return INVALID_GEOMETRY;
+
+    int handle = allocateEntry();
+    if (handle == INVALID_GEOMETRY) {
+        freeModel(model);
+        free(model);
+        return INVALID_GEOMETRY;
+    }
+
+    GeometryEntry* entry = &entries[handle];
+    memset(entry, 0, sizeof(*entry));
+    entry->params.type = OBJ_MODEL;
+    strncpy(entry->path, path, sizeof(entry->path) - 1);
+    entry->importFlags = importFlags;
+    entry->data.model = *model;
+    free(model);
+
+    entry->used = true;
+    entry->refCount = 1;
+    return handle;
+}
+
+void retainGeometry(int handle) {
+    if (handle < 0 || handle >= entryCount || !entries[handle].used) return;
+    entries[handle].refCount++;
+}
+
+static void destroyEntry(GeometryEntry* entry) {
+    switch (entry->params.type) {
+    case OBJ_CUBE: destroyCube(&entry->data.cube); break;
+    case OBJ_SPHERE: destroySphere(&entry->data.sphere); break;
+    case OBJ_PYRAMID: destroyPyramid(&entry->data.pyramid); break;
+    case OBJ_CYLINDER: destroyCylinder(&entry->data.cylinder); break;
+    case OBJ_PLANE: destroyPlane(&entry->data.plane); break;
+    case OBJ_MODEL: freeModel(&entry->data.model); break;
+    }
+    // Deleted names may be handed out again, so cached bindings can no longer be trusted
+    invalidateStateCache();
+    memset(entry, 0, sizeof(*entry));
+}
+
+void releaseGeometry(int handle) {
+    if (handle < 0 || handle >= entryCount || !entries[handle].used) return;
+    if (--entries[handle].refCount <= 0) {
+        destroyEntry(&entries[handle]);
+    }
+}
+
+const GeometryEntry* getGeometry(int handle) {
+    if (handle < 0 || handle >= entryCount || !entries[handle].used) return NULL;
+    return &entries[handle];
+}
+
+// References still held at shutdown (undo history, clipboard) are dropped here
+void cleanupGeometry() {
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].used) {
+            destroyEntry(&entries[i]);
+        }
+    }
+    free(entries);
+    entries = NULL;
+    entryCount = 0;
+    entryCapacity = 0;
+}
@@ -0,0 +1,95 @@
+#include "governor.h"
+#include "globals.h"
+
+// Resolution goes first, since fill cost falls with its square; coarser
+// detail levels only join in once the image would get too soft
+static const struct {
+    float renderScale;
+    float lodScale;
+} qualityLevels[] = {
+    { 1.0f, 1.0f },
+    { 0.9f, 1.0f },
+    { 0.8f, 1.0f },
+    { 0.7f, 0.75f },
+    { 0.6f, 0.5f },
+    { 0.5f, 0.35f },
+};
+#define QUALITY_LEVEL_COUNT (int)(sizeof(qualityLevels) / sizeof(qualityLevels[0]))
+
+// Weight of the newest frame in the smoothed frame time
+#define GOVERNOR_SMOOTHING 0.1f
+
+static int level = 0;
+static float smoothedMs = 0.0f;
+static int overFrames = 0;
+static int headroomFrames = 0;
+static int settleFrames = 0;
+
+void resetGovernor() {
+    level = 0;
+    smoothedMs = 0.0f;
+    overFrames = 0;
+    headroomFrames = 0;
+    settleFrames = 0;
+}
+
+static void changeLevel(int newLevel) {
+    level = newLevel;
+    overFrames = 0;
+    headroomFrames = 0;
+    settleFrames = GOVERNOR_SETTLE_FRAMES;
+    // The old level's timings say nothing about the new one
+    smoothedMs = 0.0f;
+}
+
+void updateGovernor(float frameMs) {
+    if (!governorEnabled) {
+        if (level != 0 || smoothedMs != 0.0f) resetGovernor();
+        return;
+    }
+    if (settleFrames > 0) {
+        settleFrames--;
+        return;
+    }
+
+    smoothedMs = smoothedMs == 0.0f ? frameMs : smoothedMs + (frameMs - smoothedMs) * GOVERNOR_SMOOTHING;
+    float target = governorTargetMs > 0.0f ? governorTargetMs : 16.6f;
+
+    if (smoothedMs > target * GOVERNOR_OVER_BUDGET) {
+        headroomFrames = 0;
+        if (++overFrames >= GOVERNOR_DROP_FRAMES && level + 1 < QUALITY_LEVEL_COUNT) {
+            changeLevel(level + 1);
+        }
+    }
+    else if (smoothedMs < target * GOVERNOR_HEADROOM) {
+        overFrames = 0;
+        if (++headroomFrames >= GOVERNOR_RAISE_FRAMES && level > 0) {
+            changeLevel(level - 1);
+        }
+    }
+    else {
+        // Inside the band: hold the current level
+        overFrames = 0;
+        headroomFrames = 0;
+    }
+}
+
+int getGovernorLevel() {
+    return level;
+}
+
+int getGovernorLevelCount() {
+    return QUALITY_LEVEL_COUNT;
+}
+
+float getGovernorFrameMs() {
+    return smoothedMs;
+}
+
+float getRenderScale() {
+    return qualityLevels[level].renderScale;
+}
+
+float getLODDetailScale() {
+    return qualityLevels[level].lodScale;
+}
@@ -250,6 +250,10 @@
      return ImGui::IsItemFocused();
  }
  
+ bool imgui_want_capture_mouse() {
+     return ImGui::GetCurrentContext() != nullptr && ImGui::GetIO().WantCaptureMouse;
+ }
+ 
  void imgui_show_demo_window(bool* p_open) {
      ImGui::ShowDemoWindow(p_open);
  }
@@ -0,0 +1,219 @@
+#include "jobs.h"
+#include "profiler.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE Thread;
+typedef SRWLOCK Mutex;
+typedef CONDITION_VARIABLE Condition;
+#define mutexInit(m) InitializeSRWLock(m)
+#define mutexDestroy(m) ((void)(m))
+#define mutexLock(m) AcquireSRWLockExclusive(m)
+#define mutexUnlock(m) ReleaseSRWLockExclusive(m)
+#define conditionInit(c) InitializeConditionVariable(c)
+#define conditionDestroy(c) ((void)(c))
+#define conditionWait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define conditionBroadcast(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+#include <unistd.h>
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+#define mutexInit(m) pthread_mutex_init(m, NULL)
+#define mutexDestroy(m) pthread_mutex_destroy(m)
+#define mutexLock(m) pthread_mutex_lock(m)
+#define mutexUnlock(m) pthread_mutex_unlock(m)
+#define conditionInit(c) pthread_cond_init(c, NULL)
+#define conditionDestroy(c) pthread_cond_destroy(c)
+#define conditionWait(c, m) pthread_cond_wait(c, m)
+#define conditionBroadcast(c) pthread_cond_broadcast(c)
+#endif
+
+#define MAX_JOB_WORKERS 32
+
+// One batch at a time; workers sleep on workReady between batches
+typedef struct {
+    Thread workers[MAX_JOB_WORKERS];
+    int workerCount;
+    Mutex lock;
+    Condition workReady;
+    Condition workDone;
+    JobFunc func;
+    JobDoneFunc done;
+    void* context;
+    int count;
+    int next;          // Next index to hand out
+    int remaining;     // Indices not finished yet
+    bool active;       // Started and not yet through done
+    unsigned int batch;  // Bumped per parallelFor so workers notice new work
+    bool quit;
+} JobSystem;
+
+static JobSystem jobs;
+static bool jobsInitialized = false;
+
+// Claims and runs indices until the batch is drained. Called with the lock held.
+static void drainBatch() {
+    while (jobs.next < jobs.count) {
+        int index = jobs.next++;
+        JobFunc func = jobs.func;
+        void* context = jobs.context;
+        mutexUnlock(&jobs.lock);
+        PROFILE_BEGIN("job");
+        func(index, context);
+        PROFILE_END();
+        mutexLock(&jobs.lock);
+        if (--jobs.remaining > 0) continue;
+
+        // Waiters keep sleeping until done has returned too
+        if (jobs.done) {
+            JobDoneFunc done = jobs.done;
+            mutexUnlock(&jobs.lock);
+            PROFILE_BEGIN("job done");
+            done(context);
+            PROFILE_END();
+            mutexLock(&jobs.lock);
+        }
+        jobs.active = false;
+        conditionBroadcast(&jobs.workDone);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI workerMain(LPVOID arg) {
+#else
+static void* workerMain(void* arg) {
+#endif
+    (void)arg;
+    profilerSetThreadName("job worker");
+    unsigned int seenBatch = 0;
+    mutexLock(&jobs.lock);
+    while (!jobs.quit) {
+        if (jobs.batch == seenBatch) {
+            conditionWait(&jobs.workReady, &jobs.lock);
+            continue;
+        }
+        seenBatch = jobs.batch;
+        drainBatch();
+    }
+    mutexUnlock(&jobs.lock);
+    return 0;
+}
+
+static int hardwareThreadCount() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+void initJobSystem(int workerCount) {
+    if (jobsInitialized) return;
+    if (workerCount <= 0) workerCount = hardwareThreadCount() - 1;
+    if (workerCount > MAX_JOB_WORKERS) workerCount = MAX_JOB_WORKERS;
+
+    mutexInit(&jobs.lock);
+    conditionInit(&jobs.workReady);
+    conditionInit(&jobs.workDone);
+    jobs.workerCount = 0;
+    jobs.batch = 0;
+    jobs.active = false;
+    jobs.quit = false;
+    jobsInitialized = true;
+
+    for (int i = 0; i < workerCount; i++) {
+#ifdef _WIN32
+        jobs.workers[i] = CreateThread(NULL, 0, workerMain, NULL, 0, NULL);
+        bool started = jobs.workers[i] != NULL;
+#else
+        bool started = pthread_create(&jobs.workers[i], NULL, workerMain, NULL) == 0;
+#endif
+        if (!started) {
+            fprintf(stderr, "Failed to start job worker %d; continuing with %d.\n", i, jobs.workerCount);
+            break;
+        }
+        jobs.workerCount++;
+    }
+}
+
+void shutdownJobSystem() {
+    if (!jobsInitialized) return;
+    waitForJobs();
+
+    mutexLock(&jobs.lock);
+    jobs.quit = true;
+    conditionBroadcast(&jobs.workReady);
+    mutexUnlock(&jobs.lock);
+
+    for (int i = 0; i < jobs.workerCount; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(jobs.workers[i], INFINITE);
+        CloseHandle(jobs.workers[i]);
+#else
+        pthread_join(jobs.workers[i], NULL);
+#endif
+    }
+    jobs.workerCount = 0;
+    conditionDestroy(&jobs.workReady);
+    conditionDestroy(&jobs.workDone);
+    mutexDestroy(&jobs.lock);
+    jobsInitialized = false;
+}
+
+int getJobWorkerCount() {
+    return jobsInitialized ? jobs.workerCount : 0;
+}
+
+void parallelFor(int count, JobFunc func, void* context) {
+    if (count <= 0) return;
+    if (!jobsInitialized || jobs.workerCount == 0 || count == 1) {
+        waitForJobs();
+        for (int i = 0; i < count; i++) {
+            func(i, context);
+        }
+        return;
+    }
+    startParallelFor(count, func, NULL, context);
+    waitForJobs();
+}
+
+void startParallelFor(int count, JobFunc func, JobDoneFunc done, void* context) {
+    waitForJobs();
+    if (!jobsInitialized || jobs.workerCount == 0 || count <= 0) {
+        for (int i = 0; i < count; i++) {
+            func(i, context);
+        }
+        if (done) done(context);
+        return;
+    }
+
+    mutexLock(&jobs.lock);
+    jobs.func = func;
+    jobs.done = done;
+    jobs.context = context;
+    jobs.count = count;
+    jobs.next = 0;
+    jobs.remaining = count;
+    jobs.active = true;
+    jobs.batch++;
+    conditionBroadcast(&jobs.workReady);
+    mutexUnlock(&jobs.lock);
+}
+
+void waitForJobs() {
+    if (!jobsInitialized) return;
+    mutexLock(&jobs.lock);
+    drainBatch();
+    while (jobs.active) {
+        conditionWait(&jobs.workDone, &jobs.lock);
+    }
+    mutexUnlock(&jobs.lock);
+}
@@ -0,0 +1,438 @@
+#include "lod.h"
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Meshes below this many triangles are drawn at full detail at any distance
+#define LOD_MIN_TRIANGLES 256
+
+// Border edges get a perpendicular plane this much heavier than a face, so
+// open edges and silhouettes of unclosed meshes stay in place
+#define LOD_BORDER_WEIGHT 10.0f
+
+// Projected size below which each level is used, as a fraction of viewport height
+static const float lodThresholds[MAX_LOD_LEVELS] = { FLT_MAX, 0.25f, 0.1f, 0.04f };
+#define LOD_HYSTERESIS 0.15f
+
+// Triangle budget and allowed error, relative to the bounds diagonal, per level
+static const float lodRatios[MAX_LOD_LEVELS] = { 1.0f, 0.5f, 0.25f, 0.1f };
+static const float lodErrors[MAX_LOD_LEVELS] = { 0.0f, 0.005f, 0.015f, 0.04f };
+
+LODChain makeSingleLODChain(unsigned int indexCount) {
+    LODChain chain;
+    memset(&chain, 0, sizeof(chain));
+    chain.levels[0].indexCount = indexCount;
+    chain.count = 1;
+    return chain;
+}
+
+// Symmetric 4x4 error matrix, upper triangle, plus the accumulated area weight
+typedef struct {
+    float a00, a01, a02, a03;
+    float a11, a12, a13;
+    float a22, a23;
+    float a33;
+    float weight;
+} Quadric;
+
+typedef struct {
+    uint64_t key;  // Lower vertex in the high bits, higher in the low bits
+    unsigned int triangle;
+} EdgeRef;
+
+typedef struct {
+    unsigned int from;
+    unsigned int to;
+    float cost;
+} Collapse;
+
+static void addPlane(Quadric* q, Vector3 n, float d, float weight) {
+    q->a00 += weight * n.x * n.x;
+    q->a01 += weight * n.x * n.y;
+    q->a02 += weight * n.x * n.z;
+    q->a03 += weight * n.x * d;
+    q->a11 += weight * n.y * n.y;
+    q->a12 += weight * n.y * n.z;
+    q->a13 += weight * n.y * d;
+    q->a22 += weight * n.z * n.z;
+    q->a23 += weight * n.z * d;
+    q->a33 += weight * d * d;
+    q->weight += weight;
+}
+
+static void addQuadric(Quadric* q, const Quadric* other) {
+    q->a00 += other->a00; q->a01 += other->a01; q->a02 += other->a02; q->a03 += other->a03;
+    q->a11 += other->a11; q->a12 += other->a12; q->a13 += other->a13;
+    q->a22 += other->a22; q->a23 += other->a23;
+    q->a33 += other->a33;
+    q->weight += other->weight;
+}
+
+// Mean squared distance from p to the planes gathered in a and b
+static float quadricError(const Quadric* a, const Quadric* b, Vector3 p) {
+    Quadric q = *a;
+    addQuadric(&q, b);
+    float error = q.a00 * p.x * p.x + 2.0f * q.a01 * p.x * p.y + 2.0f * q.a02 * p.x * p.z + 2.0f * q.a03 * p.x
+        + q.a11 * p.y * p.y + 2.0f * q.a12 * p.y * p.z + 2.0f * q.a13 * p.y
+        + q.a22 * p.z * p.z + 2.0f * q.a23 * p.z
+        + q.a33;
+    return fabsf(error) / (q.weight > 0.0f ? q.weight : 1.0f);
+}
+
+static uint64_t edgeKey(unsigned int a, unsigned int b) {
+    return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+}
+
+static int compareEdges(const void* a, const void* b) {
+    uint64_t keyA = ((const EdgeRef*)a)->key;
+    uint64_t keyB = ((const EdgeRef*)b)->key;
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+static int compareCollapses(const void* a, const void* b) {
+    float costA = ((const Collapse*)a)->cost;
+    float costB = ((const Collapse*)b)->cost;
+    return (costA > costB) - (costA < costB);
+}
+
+// Imports usually split vertices at UV and normal seams. Connectivity and
+// error are worked out on positions, so every copy of a position is mapped to
+// its first occurrence; the output still indexes the original copies.
+static void weldPositions(const Vector3* positions, unsigned int vertexCount, unsigned int* remap) {
+    unsigned int tableSize = 1;
+    while (tableSize < vertexCount * 2) tableSize <<= 1;
+    unsigned int* table = (unsigned int*)malloc(tableSize * sizeof(unsigned int));
+    if (!table) {
+        for (unsigned int i = 0; i < vertexCount; i++) remap[i] = i;
+        return;
+    }
+    memset(table, 0xFF, tableSize * sizeof(unsigned int));
+
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        uint32_t bits[3];
+        memcpy(bits, &positions[i], sizeof(bits));
+        uint32_t hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        unsigned int slot = hash & (tableSize - 1);
+        while (table[slot] != UINT32_MAX && memcmp(&positions[table[slot]], &positions[i], sizeof(Vector3)) != 0) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == UINT32_MAX) table[slot] = i;
+        remap[i] = table[slot];
+    }
+    free(table);
+}
+
+// Drops triangles that collapsed to a line or point, keeping corners (the
+// unwelded index of each entry) in step; returns the new index count
+static unsigned int removeDegenerates(unsigned int* indices, unsigned int* corners, unsigned int indexCount) {
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < indexCount; i += 3) {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a == b || b == c || a == c) continue;
+        for (int k = 0; k < 3; k++) {
+            corners[count] = corners[i + k];
+            indices[count++] = indices[i + k];
+        }
+    }
+    return count;
+}
+
+// Sorted edge list of the current triangles; an edge seen once is a border
+static void buildEdges(const unsigned int* indices, unsigned int indexCount, EdgeRef* edges) {
+    for (unsigned int i = 0; i < indexCount; i++) {
+        unsigned int next = (i % 3 == 2) ? i - 2 : i + 1;
+        edges[i].key = edgeKey(indices[i], indices[next]);
+        edges[i].triangle = i / 3;
+    }
+    qsort(edges, indexCount, sizeof(EdgeRef), compareEdges);
+}
+
+// Edges are sorted, so an edge shared by two triangles has a twin beside it
+static bool isBorderEdge(const EdgeRef* edges, unsigned int edgeCount, unsigned int i) {
+    return (i == 0 || edges[i - 1].key != edges[i].key) && (i + 1 == edgeCount || edges[i + 1].key != edges[i].key);
+}
+
+static Vector3 triangleNormal(Vector3 a, Vector3 b, Vector3 c) {
+    return vector_cross(vector_sub(b, a), vector_sub(c, a));
+}
+
+// Collapsing from onto to must not flip any triangle that survives it
+static bool collapseFlips(unsigned int from, unsigned int to, const unsigned int* indices,
+    const unsigned int* adjacency, const unsigned int* adjacencyOffsets, const Vector3* positions) {
+    for (unsigned int i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++) {
+        const unsigned int* triangle = &indices[adjacency[i] * 3];
+        if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+
+        Vector3 corners[3], moved[3];
+        for (int k = 0; k < 3; k++) {
+            corners[k] = positions[triangle[k]];
+            moved[k] = triangle[k] == from ? positions[to] : corners[k];
+        }
+        Vector3 before = triangleNormal(corners[0], corners[1], corners[2]);
+        Vector3 after = triangleNormal(moved[0], moved[1], moved[2]);
+        if (vector_dot(before, after) <= 0.0f) return true;
+    }
+    return false;
+}
+
+// Scratch space for one simplifyMesh call
+typedef struct {
+    unsigned int* remap;
+    Quadric* quadrics;
+    unsigned char* border;
+    unsigned char* seam;             // Welded from copies whose uploaded attributes differ
+    unsigned char* locked;
+    unsigned int* corners;           // Original vertex of each index entry
+    unsigned int* collapsedCorner;   // Per collapsed vertex, the original copy of its target
+    unsigned int* adjacencyOffsets;  // Per vertex, into adjacency
+    unsigned int* adjacency;         // Triangles around each vertex
+    EdgeRef* edges;
+    Collapse* collapses;
+} SimplifyScratch;
+
+static void addFaceQuadrics(SimplifyScratch* s, const unsigned int* indices, unsigned int count, const Vector3* positions) {
+    // Every vertex starts with the planes of the faces around it, weighted by area
+    for (unsigned int i = 0; i < count; i += 3) {
+        Vector3 a = positions[indices[i]], b = positions[indices[i + 1]], c = positions[indices[i + 2]];
+        Vector3 normal = triangleNormal(a, b, c);
+        float length = vector_length(normal);
+        if (length <= 0.0f) continue;
+        normal = vector_scale(normal, 1.0f / length);
+        float d = -vector_dot(normal, a);
+        for (int k = 0; k < 3; k++) {
+            addPlane(&s->quadrics[indices[i + k]], normal, d, length * 0.5f);
+        }
+    }
+
+    buildEdges(indices, count, s->edges);
+    for (unsigned int i = 0; i < count; i++) {
+        if (!isBorderEdge(s->edges, count, i)) continue;
+        unsigned int a = (unsigned int)(s->edges[i].key >> 32), b = (unsigned int)(s->edges[i].key & 0xFFFFFFFFu);
+        const unsigned int* triangle = &indices[s->edges[i].triangle * 3];
+        Vector3 faceNormal = triangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+        Vector3 edge = vector_sub(positions[b], positions[a]);
+        Vector3 normal = vector_cross(edge, faceNormal);
+        float length = vector_length(normal);
+        if (length <= 0.0f) continue;
+        normal = vector_scale(normal, 1.0f / length);
+        float d = -vector_dot(normal, positions[a]);
+        float weight = vector_dot(edge, edge) * LOD_BORDER_WEIGHT;
+        addPlane(&s->quadrics[a], normal, d, weight);
+        addPlane(&s->quadrics[b], normal, d, weight);
+    }
+}
+
+static void buildAdjacency(SimplifyScratch* s, const unsigned int* indices, unsigned int count, unsigned int vertexCount) {
+    unsigned int* offsets = s->adjacencyOffsets;
+    memset(offsets, 0, (vertexCount + 1) * sizeof(unsigned int));
+    for (unsigned int i = 0; i < count; i++) offsets[indices[i] + 1]++;
+    for (unsigned int v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+    for (unsigned int i = 0; i < count; i++) s->adjacency[offsets[indices[i]]++] = i / 3;
+    for (unsigned int v = vertexCount; v > 0; v--) offsets[v] = offsets[v - 1];
+    offsets[0] = 0;
+}
+
+// One candidate per edge, in its cheaper allowed direction. Border vertices
+// may only slide along their own border. Seam vertices never move: their
+// triangles disagree on uploaded attributes, so no single copy of the target could
+// stand in for all of them.
+static unsigned int gatherCollapses(SimplifyScratch* s, unsigned int count, const Vector3* positions, float maxErrorSquared) {
+    unsigned int candidateCount = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (i > 0 && s->edges[i - 1].key == s->edges[i].key) continue;
+        unsigned int a = (unsigned int)(s->edges[i].key >> 32), b = (unsigned int)(s->edges[i].key & 0xFFFFFFFFu);
+        bool borderEdge = isBorderEdge(s->edges, count, i);
+        bool fromA = (borderEdge || !s->border[a]) && !s->seam[a];
+        bool fromB = (borderEdge || !s->border[b]) && !s->seam[b];
+
+        float costAB = fromA ? quadricError(&s->quadrics[a], &s->quadrics[b], positions[b]) : FLT_MAX;
+        float costBA = fromB ? quadricError(&s->quadrics[a], &s->quadrics[b], positions[a]) : FLT_MAX;
+        Collapse collapse = costAB <= costBA ? (Collapse){ a, b, costAB } : (Collapse){ b, a, costBA };
+        if (collapse.cost <= maxErrorSquared) {
+            s->collapses[candidateCount++] = collapse;
+        }
+    }
+    qsort(s->collapses, candidateCount, sizeof(Collapse), compareCollapses);
+    return candidateCount;
+}
+
+static unsigned int collapseEdges(SimplifyScratch* s, unsigned int* indices, unsigned int count,
+    const Vector3* positions, unsigned int vertexCount, unsigned int targetIndexCount, float maxError) {
+    addFaceQuadrics(s, indices, count, positions);
+    bool edgesCurrent = true;
+
+    // Each pass applies the cheapest collapses that do not touch each other's
+    // triangles, then rebuilds connectivity for the next
+    while (count > targetIndexCount) {
+        if (!edgesCurrent) {
+            buildEdges(indices, count, s->edges);
+        }
+        edgesCurrent = false;
+        memset(s->border, 0, vertexCount);
+        for (unsigned int i = 0; i < count; i++) {
+            if (isBorderEdge(s->edges, count, i)) {
+                s->border[s->edges[i].key >> 32] = 1;
+                s->border[s->edges[i].key & 0xFFFFFFFFu] = 1;
+            }
+        }
+        buildAdjacency(s, indices, count, vertexCount);
+
+        unsigned int candidateCount = gatherCollapses(s, count, positions, maxError * maxError);
+        if (candidateCount == 0) break;
+
+        for (unsigned int v = 0; v < vertexCount; v++) s->remap[v] = v;
+        memset(s->locked, 0, vertexCount);
+        unsigned int applied = 0;
+        unsigned int remaining = count;
+        for (unsigned int i = 0; i < candidateCount && remaining > targetIndexCount; i++) {
+            unsigned int from = s->collapses[i].from, to = s->collapses[i].to;
+            if (s->locked[from] || s->locked[to]) continue;
+            if (collapseFlips(from, to, indices, s->adjacency, s->adjacencyOffsets, positions)) continue;
+
+            s->remap[from] = to;
+            addQuadric(&s->quadrics[to], &s->quadrics[from]);
+            for (unsigned int t = s->adjacencyOffsets[from]; t < s->adjacencyOffsets[from + 1]; t++) {
+                unsigned int first = s->adjacency[t] * 3;
+                const unsigned int* triangle = &indices[first];
+                for (int k = 0; k < 3; k++) {
+                    // from is no seam, so its triangles all share one side of
+                    // any seam through to: the copy of to they collapse onto
+                    // is the one in a triangle the edge removes
+                    if (triangle[k] == to) {
+                        s->collapsedCorner[from] = s->corners[first + k];
+                        remaining -= 3;
+                    }
+                }
+                s->locked[triangle[0]] = s->locked[triangle[1]] = s->locked[triangle[2]] = 1;
+            }
+            applied++;
+        }
+        if (applied == 0) break;
+
+        for (unsigned int i = 0; i < count; i++) {
+            if (s->remap[indices[i]] != indices[i]) {
+                s->corners[i] = s->collapsedCorner[indices[i]];
+                indices[i] = s->remap[indices[i]];
+            }
+        }
+        count = removeDegenerates(indices, s->corners, count);
+    }
+    return count;
+}
+
+// Copies of one position drawn identically need no seam
+static bool sameAttributes(const float* attributes, unsigned int attributeCount, unsigned int a, unsigned int b) {
+    if (!attributes) return true;
+    return memcmp(&attributes[(size_t)a * attributeCount], &attributes[(size_t)b * attributeCount],
+        attributeCount * sizeof(float)) == 0;
+}
+
+unsigned int simplifyMesh(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+    const Vector3* positions, unsigned int vertexCount, const float* attributes, unsigned int attributeCount,
+    unsigned int targetIndexCount, float maxError) {
+    SimplifyScratch s;
+    s.remap = (unsigned int*)malloc(vertexCount * sizeof(unsigned int));
+    s.quadrics = (Quadric*)calloc(vertexCount, sizeof(Quadric));
+    s.border = (unsigned char*)malloc(vertexCount);
+    s.seam = (unsigned char*)calloc(vertexCount, 1);
+    s.locked = (unsigned char*)malloc(vertexCount);
+    s.corners = (unsigned int*)malloc(indexCount * sizeof(unsigned int));
+    s.collapsedCorner = (unsigned int*)malloc(vertexCount * sizeof(unsigned int));
+    s.adjacencyOffsets = (unsigned int*)malloc((vertexCount + 1) * sizeof(unsigned int));
+    s.adjacency = (unsigned int*)malloc(indexCount * sizeof(unsigned int));
+    s.edges = (EdgeRef*)malloc(indexCount * sizeof(EdgeRef));
+    s.collapses = (Collapse*)malloc(indexCount * sizeof(Collapse));
+
+    unsigned int count = indexCount;
+    if (!s.remap || !s.quadrics || !s.border || !s.seam || !s.locked || !s.corners || !s.collapsedCorner ||
+        !s.adjacencyOffsets || !s.adjacency || !s.edges || !s.collapses) {
+        fprintf(stderr, "Failed to allocate mesh simplification buffers.\n");
+        memcpy(destination, indices, indexCount * sizeof(unsigned int));
+    }
+    else {
+        weldPositions(positions, vertexCount, s.remap);
+        for (unsigned int v = 0; v < vertexCount; v++) {
+            if (s.remap[v] != v && !sameAttributes(attributes, attributeCount, v, s.remap[v])) s.seam[s.remap[v]] = 1;
+        }
+        for (unsigned int i = 0; i < indexCount; i++) {
+            destination[i] = s.remap[indices[i]];
+            s.corners[i] = indices[i];
+        }
+        count = removeDegenerates(destination, s.corners, indexCount);
+        count = collapseEdges(&s, destination, count, positions, vertexCount, targetIndexCount, maxError);
+        // Back to the original copies, so every corner keeps its own UVs and normal
+        memcpy(destination, s.corners, count * sizeof(unsigned int));
+    }
+
+    free(s.remap);
+    free(s.quadrics);
+    free(s.border);
+    free(s.seam);
+    free(s.locked);
+    free(s.corners);
+    free(s.collapsedCorner);
+    free(s.adjacencyOffsets);
+    free(s.adjacency);
+    free(s.edges);
+    free(s.collapses);
+    return count;
+}
+
+void buildLODChain(unsigned int** indices, unsigned int indexCount, const Vector3* positions, unsigned int vertexCount,
+    const float* attributes, unsigned int attributeCount, LODChain* chain) {
+    *chain = makeSingleLODChain(indexCount);
+    if (indexCount / 3 < LOD_MIN_TRIANGLES || !positions) return;
+
+    AABB bounds = emptyAABB();
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        expandAABB(&bounds, positions[i]);
+    }
+    float diagonal = vector_length(vector_sub(bounds.max, bounds.min));
+
+    // Each level is at most as long as the one before, so this always fits
+    unsigned int* all = (unsigned int*)malloc((size_t)indexCount * MAX_LOD_LEVELS * sizeof(unsigned int));
+    if (!all) return;
+    memcpy(all, *indices, indexCount * sizeof(unsigned int));
+
+    unsigned int total = indexCount;
+    for (int level = 1; level < MAX_LOD_LEVELS; level++) {
+        const LODLevel* previous = &chain->levels[level - 1];
+        unsigned int target = (unsigned int)(indexCount * lodRatios[level]) / 3 * 3;
+        unsigned int count = simplifyMesh(all + total, all + previous->indexOffset, previous->indexCount,
+            positions, vertexCount, attributes, attributeCount, target, diagonal * lodErrors[level]);
+
+        // A level that barely saves anything costs memory without saving vertex work
+        if (count == 0 || count > previous->indexCount - previous->indexCount / 5) break;
+        chain->levels[level].indexOffset = total;
+        chain->levels[level].indexCount = count;
+        chain->count++;
+        total += count;
+    }
+
+    unsigned int* shrunk = (unsigned int*)realloc(all, total * sizeof(unsigned int));
+    free(*indices);
+    *indices = shrunk ? shrunk : all;
+}
+
+float projectedSize(AABB bounds, Vector3 eye, float projScale) {
+    Vector3 center = aabbCenter(bounds);
+    float radius = vector_length(aabbExtents(bounds));
+    float distance = vector_length(vector_sub(center, eye));
+    if (distance <= radius) return FLT_MAX;  // Camera inside the bounds
+    return radius * projScale / distance;
+}
+
+int selectLOD(float screenSize, int current, int levelCount) {
+    if (levelCount <= 1) return 0;
+    if (current >= levelCount) current = levelCount - 1;
+    while (current + 1 < levelCount && screenSize < lodThresholds[current + 1] * (1.0f - LOD_HYSTERESIS)) {
+        current++;
+    }
+    while (current > 0 && screenSize > lodThresholds[current] * (1.0f + LOD_HYSTERESIS)) {
+        current--;
+    }
+    return current;
+}
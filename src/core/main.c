@@ -12,19 +12,33 @@
 #include "textures.h"
 #include "lightshading.h"
 #include "background.h"
+#include "headless.h"
+#include "gputimers.h"
+#include "profiler.h"
+#include "governor.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 // Forward declarations
 static void process_input(GLFWwindow* window, float deltaTime);
 static float calculate_delta_time();
+static void load_scene_resources();
+static void create_default_scene();
+static int run_headless(int argc, char** argv);
 
 // Global time variables
 static float last_frame_time = 0.0f;
 static float delta_time = 0.0f;
 
-int main(void) {
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            return run_headless(argc, argv);
+        }
+    }
+
     // Hide console on Windows (for release builds)
     #ifdef _WIN32
         #ifdef NDEBUG
@@ -35,6 +49,7 @@ int main(void) {
 
     // Initialize random seed
     srand((unsigned int)time(NULL));
+    initProfiler();
 
     // Setup OpenGL and GLFW
     setup();
@@ -48,7 +63,66 @@ int main(void) {
     glfwSetFramebufferSizeCallback(screen.window, framebuffer_size_callback);
     glfwSetWindowSizeCallback(screen.window, resize_callback);
 
-    // Load resources
+    load_scene_resources();
+    create_default_scene();
+    
+    // Main render loop
+    printf("Starting main loop...\n");
+    while (!glfwWindowShouldClose(screen.window)) {
+        profilerBeginFrame();
+        PROFILE_BEGIN("frame");
+        double frame_start = glfwGetTime();
+
+        // Calculate delta time
+        delta_time = calculate_delta_time();
+        
+        // Process input
+        PROFILE_BEGIN("input");
+        glfwPollEvents();
+        process_input(screen.window, delta_time);
+        PROFILE_END();
+        
+        // Update game state if running
+        if (isRunning) {
+            update(delta_time);
+        }
+        
+        // Render
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        render();
+        
+        // Render GUI
+        beginGpuPass(GPU_PASS_GUI);
+        main_gui();
+        endGpuPass();
+
+        // Waiting for vsync in the swap is not frame cost, so measure before it
+        float cpu_ms = (float)((glfwGetTime() - frame_start) * 1000.0);
+        GpuTimerStats gpu_stats = getGpuTimerStats();
+        updateGovernor(gpu_stats.lastTotalMs > cpu_ms ? gpu_stats.lastTotalMs : cpu_ms);
+        
+        // Swap buffers
+        PROFILE_BEGIN("swap");
+        glfwSwapBuffers(screen.window);
+        PROFILE_END();
+
+        PROFILE_END();
+    }
+
+    // Cleanup
+    cleanupObjects();
+    teardown_imgui();
+    end();
+    shutdownProfiler();
+    
+    printf("Application terminated normally.\n");
+    return 0;
+}
+
+/**
+ * Load the textures, materials, skybox and lighting every scene relies on
+ */
+static void load_scene_resources() {
     printf("Loading textures...\n");
     load_texture();
     
@@ -60,8 +134,12 @@ int main(void) {
     
     printf("Setting up lighting...\n");
     initLightingSystem();
-    
-    // Create a default scene
+}
+
+/**
+ * Ground plane with a cube, sphere and pyramid under a point light
+ */
+static void create_default_scene() {
     printf("Creating default scene...\n");
     PBRMaterial defaultMaterial = *getMaterial("peacockOre");
     
@@ -78,54 +156,115 @@ int main(void) {
     // Add a cube, sphere, and pyramid
     addObject(&camera, OBJ_CUBE, true, 0, true, NULL, defaultMaterial, true);
     objectManager.objects[objectManager.count-1].position = positions[0];
+    syncObject(objectManager.count-1);
     
     addObject(&camera, OBJ_SPHERE, true, 0, true, NULL, defaultMaterial, true);
     objectManager.objects[objectManager.count-1].position = positions[1];
+    syncObject(objectManager.count-1);
     
     addObject(&camera, OBJ_PYRAMID, true, 0, true, NULL, defaultMaterial, true);
     objectManager.objects[objectManager.count-1].position = positions[2];
+    syncObject(objectManager.count-1);
     
     // Add a point light
     createLight((Vector3){0.0f, 5.0f, 0.0f}, (Vector3){0.0f, -1.0f, 0.0f}, (Vector3){1.0f, 1.0f, 1.0f}, 1.5f, LIGHT_POINT);
-    
-    // Main render loop
-    printf("Starting main loop...\n");
-    while (!glfwWindowShouldClose(screen.window)) {
-        // Calculate delta time
-        delta_time = calculate_delta_time();
-        
-        // Process input
-        glfwPollEvents();
-        process_input(screen.window, delta_time);
-        
-        // Update game state if running
-        if (isRunning) {
-            update(delta_time);
+}
+
+/**
+ * Render the default scene offscreen without a window, GUI or loading screen.
+ * Options: --size WxH (default 1280x720), --frames N (default 1), --output file.ppm,
+ * --trace file.json (Chrome trace of the whole run), --depth-prepass, --deferred,
+ * --governor MS (frame budget governor with this target; the saved frame shows its final scale)
+ */
+static int run_headless(int argc, char** argv) {
+    int width = 1280;
+    int height = 720;
+    int frames = 1;
+    const char* output = NULL;
+    const char* trace = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                fprintf(stderr, "Invalid size '%s', expected WxH\n", argv[i]);
+                return EXIT_FAILURE;
+            }
         }
-        
-        // Render
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+            if (frames < 1) frames = 1;
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace = argv[++i];
+        }
+        else if (strcmp(argv[i], "--depth-prepass") == 0) {
+            depthPrepassEnabled = true;
+        }
+        else if (strcmp(argv[i], "--deferred") == 0) {
+            deferredEnabled = true;
+        }
+        else if (strcmp(argv[i], "--governor") == 0 && i + 1 < argc) {
+            governorEnabled = true;
+            governorTargetMs = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--headless") != 0) {
+            fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    initProfiler();
+    if (!setupHeadless(width, height)) {
+        shutdownProfiler();
+        return EXIT_FAILURE;
+    }
+    load_scene_resources();
+    create_default_scene();
+
+    printf("Rendering %d frame(s) at %dx%d...\n", frames, width, height);
+    for (int i = 0; i < frames; i++) {
+        profilerBeginFrame();
+        // Frames end in glFinish, so the profiled frame is its whole cost
+        if (i > 0) {
+            updateGovernor((float)getProfilerFrameMs());
+        }
+        PROFILE_BEGIN("frame");
         render();
-        
-        // Render GUI
-        main_gui();
-        
-        // Swap buffers
-        glfwSwapBuffers(screen.window);
+        PROFILE_BEGIN("finish");
+        glFinish();
+        PROFILE_END();
+        PROFILE_END();
+    }
+    profilerBeginFrame();
+    if (governorEnabled) {
+        printf("Governor settled at level %d: render scale %.2f, detail %.2f\n",
+            getGovernorLevel(), getRenderScale(), getLODDetailScale());
+    }
+
+    int status = EXIT_SUCCESS;
+    if (output) {
+        if (saveHeadlessFrame(output)) {
+            printf("Saved frame to %s\n", output);
+        }
+        else {
+            fprintf(stderr, "Failed to save frame to %s\n", output);
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (trace && !writeChromeTrace(trace)) {
+        status = EXIT_FAILURE;
     }
 
-    // Cleanup
     cleanupObjects();
-    teardown_imgui();
     end();
-    
-    printf("Application terminated normally.\n");
-    return 0;
+    shutdownProfiler();
+    return status;
 }
 
-/**
- * Process keyboard and mouse input
- */
 /**
  * Calculate delta time between frames
  */
@@ -0,0 +1,256 @@
+#include "matrix.h"
+#include "simd.h"
+#include <math.h>
+
+Matrix4x4 translateMatrix(Vector3 position) {
+    Matrix4x4 mat = { 0 };
+    for (int i = 0; i < 4; i++) {
+        mat.data[i][i] = 1.0f;
+    }
+    mat.data[3][0] = position.x;
+    mat.data[3][1] = position.y;
+    mat.data[3][2] = position.z;
+    return mat;
+}
+
+Matrix4x4 rotateMatrix(float angle, Vector3 axis) {
+    Matrix4x4 mat = { 0 };
+    float rad = angle * (float)M_PI / 180.0f;
+    float c = cosf(rad);
+    float s = sinf(rad);
+    Vector3 norm = vector_normalize(axis);
+    mat.data[0][0] = c + norm.x * norm.x * (1 - c);
+    mat.data[0][1] = norm.x * norm.y * (1 - c) - norm.z * s;
+    mat.data[0][2] = norm.x * norm.z * (1 - c) + norm.y * s;
+    mat.data[1][0] = norm.y * norm.x * (1 - c) + norm.z * s;
+    mat.data[1][1] = c + norm.y * norm.y * (1 - c);
+    mat.data[1][2] = norm.y * norm.z * (1 - c) - norm.x * s;
+    mat.data[2][0] = norm.z * norm.x * (1 - c) - norm.y * s;
+    mat.data[2][1] = norm.z * norm.y * (1 - c) + norm.x * s;
+    mat.data[2][2] = c + norm.z * norm.z * (1 - c);
+    mat.data[3][3] = 1.0f;
+    return mat;
+}
+
+Matrix4x4 scaleMatrix(Vector3 scale) {
+    Matrix4x4 mat = { 0 };
+    mat.data[0][0] = scale.x;
+    mat.data[1][1] = scale.y;
+    mat.data[2][2] = scale.z;
+    mat.data[3][3] = 1.0f;
+    return mat;
+}
+
+// Each output column is a combination of b's columns weighted by a's column,
+// so one column takes four broadcasts and four multiply-adds
+void matrixMultiplyInto(const Matrix4x4* a, const Matrix4x4* b, Matrix4x4* out) {
+#ifdef STELLAI_SIMD_SSE
+    __m128 b0 = _mm_loadu_ps(b->data[0]);
+    __m128 b1 = _mm_loadu_ps(b->data[1]);
+    __m128 b2 = _mm_loadu_ps(b->data[2]);
+    __m128 b3 = _mm_loadu_ps(b->data[3]);
+    for (int i = 0; i < 4; i++) {
+        const float* column = a->data[i];
+        __m128 r = _mm_mul_ps(_mm_set1_ps(column[0]), b0);
+        r = simdMulAdd(_mm_set1_ps(column[1]), b1, r);
+        r = simdMulAdd(_mm_set1_ps(column[2]), b2, r);
+        r = simdMulAdd(_mm_set1_ps(column[3]), b3, r);
+        _mm_storeu_ps(out->data[i], r);
+    }
+#else
+    Matrix4x4 result;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.data[i][j] = 0;
+            for (int k = 0; k < 4; k++) {
+                result.data[i][j] += a->data[i][k] * b->data[k][j];
+            }
+        }
+    }
+    *out = result;
+#endif
+}
+
+Matrix4x4 matrixMultiply(Matrix4x4 a, Matrix4x4 b) {
+    Matrix4x4 result;
+    matrixMultiplyInto(&a, &b, &result);
+    return result;
+}
+
+Matrix4x4 lookAt(Vector3 eye, Vector3 center, Vector3 up) {
+    Vector3 f = vector_normalize(vector_sub(center, eye));
+    Vector3 s = vector_normalize(vector_cross(f, up));
+    Vector3 u = vector_cross(s, f);
+
+    Matrix4x4 result = { 0 };
+    result.data[0][0] = s.x;
+    result.data[1][0] = s.y;
+    result.data[2][0] = s.z;
+    result.data[0][1] = u.x;
+    result.data[1][1] = u.y;
+    result.data[2][1] = u.z;
+    result.data[0][2] = -f.x;
+    result.data[1][2] = -f.y;
+    result.data[2][2] = -f.z;
+    result.data[3][0] = -vector_dot(s, eye);
+    result.data[3][1] = -vector_dot(u, eye);
+    result.data[3][2] = vector_dot(f, eye);
+    result.data[3][3] = 1.0f;
+    return result;
+}
+
+Matrix4x4 perspective(float fov, float aspect, float znear, float zfar) {
+    Matrix4x4 m = { 0 };
+    float tanHalfFovy = tanf(fov / 2.0f);
+    m.data[0][0] = 1.0f / (aspect * tanHalfFovy);
+    m.data[1][1] = 1.0f / tanHalfFovy;
+    m.data[2][2] = -(zfar + znear) / (zfar - znear);
+    m.data[2][3] = -1.0f;
+    m.data[3][2] = -(2.0f * zfar * znear) / (zfar - znear);
+    return m;
+}
+
+Matrix4x4 identityMatrix() {
+    Matrix4x4 result = { .data = {
+        {1, 0, 0, 0},
+        {0, 1, 0, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1}
+    } };
+    return result;
+}
+
+// Same matrix as translateMatrix -> rotateMatrix X, Y, Z -> scaleMatrix chained
+// through matrixMultiply, built directly instead of with four 4x4 products
+Matrix4x4 composeTransform(Vector3 position, Vector3 rotation, Vector3 scale) {
+    const float toRadians = (float)M_PI / 180.0f;
+    float rx = rotation.x * toRadians, ry = rotation.y * toRadians, rz = rotation.z * toRadians;
+    float cx = cosf(rx), sx = sinf(rx);
+    float cy = cosf(ry), sy = sinf(ry);
+    float cz = cosf(rz), sz = sinf(rz);
+
+    // Rz * Ry * Rx with rotateMatrix's sign convention, as [row][column]
+    float r[3][3] = {
+        { cz * cy, cz * sy * sx + sz * cx, -cz * sy * cx + sz * sx },
+        { -sz * cy, -sz * sy * sx + cz * cx, sz * sy * cx + cz * sx },
+        { sy, -cy * sx, cy * cx }
+    };
+    float s[3] = { scale.x, scale.y, scale.z };
+    float p[3] = { position.x, position.y, position.z };
+
+    Matrix4x4 m = { 0 };
+    for (int row = 0; row < 3; row++) {
+        float translation = 0.0f;
+        for (int column = 0; column < 3; column++) {
+            m.data[column][row] = s[row] * r[row][column];
+            translation += r[row][column] * p[column];
+        }
+        m.data[3][row] = s[row] * translation;
+    }
+    m.data[3][3] = 1.0f;
+    return m;
+}
+
+// Inverse transpose of the upper 3x3, which keeps normals perpendicular under
+// non-uniform scale. That is the cofactor matrix over the determinant.
+Matrix3x3 normalMatrix(const Matrix4x4* model) {
+    const float (*a)[4] = model->data;
+    Matrix3x3 n;
+    n.data[0][0] = a[1][1] * a[2][2] - a[2][1] * a[1][2];
+    n.data[0][1] = a[2][0] * a[1][2] - a[1][0] * a[2][2];
+    n.data[0][2] = a[1][0] * a[2][1] - a[2][0] * a[1][1];
+    n.data[1][0] = a[2][1] * a[0][2] - a[0][1] * a[2][2];
+    n.data[1][1] = a[0][0] * a[2][2] - a[2][0] * a[0][2];
+    n.data[1][2] = a[2][0] * a[0][1] - a[0][0] * a[2][1];
+    n.data[2][0] = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    n.data[2][1] = a[1][0] * a[0][2] - a[0][0] * a[1][2];
+    n.data[2][2] = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+
+    // Only the sign of the determinant matters once the shader renormalizes,
+    // but scale properly when it is usable
+    float det = a[0][0] * n.data[0][0] + a[1][0] * n.data[1][0] + a[2][0] * n.data[2][0];
+    float invDet = fabsf(det) > 1e-12f ? 1.0f / det : 1.0f;
+    for (int column = 0; column < 3; column++) {
+        for (int row = 0; row < 3; row++) {
+            n.data[column][row] *= invDet;
+        }
+    }
+    return n;
+}
+
+// Inverse of an affine transform (column-major, translation in data[3]).
+// Returns false for singular matrices such as a zero scale.
+bool invertAffine(const Matrix4x4* m, Matrix4x4* out) {
+    const float (*a)[4] = m->data;
+    // Cofactors of the upper 3x3, indexed [column][row] like the matrix itself
+    float c00 = a[1][1] * a[2][2] - a[2][1] * a[1][2];
+    float c01 = a[2][1] * a[0][2] - a[0][1] * a[2][2];
+    float c02 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    float det = a[0][0] * c00 + a[1][0] * c01 + a[2][0] * c02;
+    if (fabsf(det) < 1e-12f) return false;
+    float invDet = 1.0f / det;
+
+    Matrix4x4 r = { 0 };
+    r.data[0][0] = c00 * invDet;
+    r.data[0][1] = c01 * invDet;
+    r.data[0][2] = c02 * invDet;
+    r.data[1][0] = (a[2][0] * a[1][2] - a[1][0] * a[2][2]) * invDet;
+    r.data[1][1] = (a[0][0] * a[2][2] - a[2][0] * a[0][2]) * invDet;
+    r.data[1][2] = (a[1][0] * a[0][2] - a[0][0] * a[1][2]) * invDet;
+    r.data[2][0] = (a[1][0] * a[2][1] - a[2][0] * a[1][1]) * invDet;
+    r.data[2][1] = (a[2][0] * a[0][1] - a[0][0] * a[2][1]) * invDet;
+    r.data[2][2] = (a[0][0] * a[1][1] - a[1][0] * a[0][1]) * invDet;
+
+    for (int row = 0; row < 3; row++) {
+        r.data[3][row] = -(r.data[0][row] * a[3][0] + r.data[1][row] * a[3][1] + r.data[2][row] * a[3][2]);
+    }
+    r.data[3][3] = 1.0f;
+    *out = r;
+    return true;
+}
+
+Vector3 transformPoint(const Matrix4x4* m, Vector3 p) {
+    return vector(
+        m->data[0][0] * p.x + m->data[1][0] * p.y + m->data[2][0] * p.z + m->data[3][0],
+        m->data[0][1] * p.x + m->data[1][1] * p.y + m->data[2][1] * p.z + m->data[3][1],
+        m->data[0][2] * p.x + m->data[1][2] * p.y + m->data[2][2] * p.z + m->data[3][2]);
+}
+
+Vector3 transformDirection(const Matrix4x4* m, Vector3 d) {
+    return vector(
+        m->data[0][0] * d.x + m->data[1][0] * d.y + m->data[2][0] * d.z,
+        m->data[0][1] * d.x + m->data[1][1] * d.y + m->data[2][1] * d.z,
+        m->data[0][2] * d.x + m->data[1][2] * d.y + m->data[2][2] * d.z);
+}
+
+// Shared body of the batched transforms; translate is 0 for directions
+static void transformBatch(const Matrix4x4* m, const Vector3* in, Vector3* out, int count, bool translate) {
+    int i = 0;
+#ifdef STELLAI_SIMD_SSE
+    const float (*a)[4] = m->data;
+    float w = translate ? 1.0f : 0.0f;
+    __m128 m00 = _mm_set1_ps(a[0][0]), m01 = _mm_set1_ps(a[0][1]), m02 = _mm_set1_ps(a[0][2]);
+    __m128 m10 = _mm_set1_ps(a[1][0]), m11 = _mm_set1_ps(a[1][1]), m12 = _mm_set1_ps(a[1][2]);
+    __m128 m20 = _mm_set1_ps(a[2][0]), m21 = _mm_set1_ps(a[2][1]), m22 = _mm_set1_ps(a[2][2]);
+    __m128 t0 = _mm_set1_ps(a[3][0] * w), t1 = _mm_set1_ps(a[3][1] * w), t2 = _mm_set1_ps(a[3][2] * w);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        loadVector3x4(in + i, &x, &y, &z);
+        __m128 rx = simdMulAdd(m20, z, simdMulAdd(m10, y, simdMulAdd(m00, x, t0)));
+        __m128 ry = simdMulAdd(m21, z, simdMulAdd(m11, y, simdMulAdd(m01, x, t1)));
+        __m128 rz = simdMulAdd(m22, z, simdMulAdd(m12, y, simdMulAdd(m02, x, t2)));
+        storeVector3x4(out + i, rx, ry, rz);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = translate ? transformPoint(m, in[i]) : transformDirection(m, in[i]);
+    }
+}
+
+void transformPoints(const Matrix4x4* m, const Vector3* in, Vector3* out, int count) {
+    transformBatch(m, in, out, count, true);
+}
+
+void transformDirections(const Matrix4x4* m, const Vector3* in, Vector3* out, int count) {
+    transformBatch(m, in, out, count, false);
+}
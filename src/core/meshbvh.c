@@ -0,0 +1,263 @@
+#include "meshbvh.h"
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    unsigned int node;
+    unsigned int depth;
+} BuildTask;
+
+typedef struct {
+    AABB box;
+    unsigned int count;
+} Bin;
+
+static float halfArea(AABB box) {
+    if (isAABBEmpty(box)) return 0.0f;
+    Vector3 size = vector_sub(box.max, box.min);
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static float axisValue(Vector3 v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+
+// Finds the cheapest binned split of a node. Returns false when no split beats
+// keeping the triangles in one leaf.
+static bool findSplit(const MeshBVH* bvh, const MeshBVHNode* node, const AABB* triangleBoxes, const Vector3* centroids,
+    int* bestAxis, float* bestPosition) {
+    AABB centroidBox = emptyAABB();
+    for (unsigned int i = 0; i < node->count; i++) {
+        expandAABB(&centroidBox, centroids[bvh->triangles[node->first + i]]);
+    }
+
+    float bestCost = halfArea(node->box) * (float)node->count;
+    bool found = false;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float lo = axisValue(centroidBox.min, axis);
+        float hi = axisValue(centroidBox.max, axis);
+        if (hi <= lo) continue;
+
+        Bin bins[MESH_BVH_BINS];
+        for (int b = 0; b < MESH_BVH_BINS; b++) {
+            bins[b].box = emptyAABB();
+            bins[b].count = 0;
+        }
+        float scale = MESH_BVH_BINS / (hi - lo);
+        for (unsigned int i = 0; i < node->count; i++) {
+            unsigned int triangle = bvh->triangles[node->first + i];
+            int b = (int)((axisValue(centroids[triangle], axis) - lo) * scale);
+            if (b >= MESH_BVH_BINS) b = MESH_BVH_BINS - 1;
+            bins[b].count++;
+            bins[b].box = mergeAABB(bins[b].box, triangleBoxes[triangle]);
+        }
+
+        // Sweep from both ends to get the cost of every plane between bins
+        float leftArea[MESH_BVH_BINS - 1], rightArea[MESH_BVH_BINS - 1];
+        unsigned int leftCount[MESH_BVH_BINS - 1], rightCount[MESH_BVH_BINS - 1];
+        AABB leftBox = emptyAABB(), rightBox = emptyAABB();
+        unsigned int leftSum = 0, rightSum = 0;
+        for (int b = 0; b < MESH_BVH_BINS - 1; b++) {
+            leftSum += bins[b].count;
+            leftBox = mergeAABB(leftBox, bins[b].box);
+            leftCount[b] = leftSum;
+            leftArea[b] = halfArea(leftBox);
+
+            rightSum += bins[MESH_BVH_BINS - 1 - b].count;
+            rightBox = mergeAABB(rightBox, bins[MESH_BVH_BINS - 1 - b].box);
+            rightCount[MESH_BVH_BINS - 2 - b] = rightSum;
+            rightArea[MESH_BVH_BINS - 2 - b] = halfArea(rightBox);
+        }
+
+        for (int b = 0; b < MESH_BVH_BINS - 1; b++) {
+            if (leftCount[b] == 0 || rightCount[b] == 0) continue;
+            float cost = leftArea[b] * leftCount[b] + rightArea[b] * rightCount[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                *bestAxis = axis;
+                *bestPosition = lo + (b + 1) / scale;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+bool buildMeshBVH(MeshBVH* bvh, const Vector3* positions, const unsigned int* indices, unsigned int triangleCount) {
+    memset(bvh, 0, sizeof(*bvh));
+    if (triangleCount == 0) return false;
+
+    bvh->nodes = (MeshBVHNode*)malloc((2 * triangleCount - 1) * sizeof(MeshBVHNode));
+    bvh->triangles = (unsigned int*)malloc(triangleCount * sizeof(unsigned int));
+    AABB* triangleBoxes = (AABB*)malloc(triangleCount * sizeof(AABB));
+    Vector3* centroids = (Vector3*)malloc(triangleCount * sizeof(Vector3));
+    BuildTask* tasks = (BuildTask*)malloc(triangleCount * sizeof(BuildTask));
+    if (!bvh->nodes || !bvh->triangles || !triangleBoxes || !centroids || !tasks) {
+        fprintf(stderr, "Failed to allocate triangle BVH.\n");
+        free(triangleBoxes);
+        free(centroids);
+        free(tasks);
+        freeMeshBVH(bvh);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < triangleCount; i++) {
+        AABB box = emptyAABB();
+        expandAABB(&box, positions[indices[i * 3 + 0]]);
+        expandAABB(&box, positions[indices[i * 3 + 1]]);
+        expandAABB(&box, positions[indices[i * 3 + 2]]);
+        triangleBoxes[i] = box;
+        centroids[i] = aabbCenter(box);
+        bvh->triangles[i] = i;
+    }
+    bvh->triangleCount = triangleCount;
+
+    bvh->nodes[0].first = 0;
+    bvh->nodes[0].count = triangleCount;
+    bvh->nodeCount = 1;
+
+    unsigned int taskCount = 0;
+    tasks[taskCount++] = (BuildTask){ 0, 0 };
+    while (taskCount > 0) {
+        BuildTask task = tasks[--taskCount];
+        MeshBVHNode* node = &bvh->nodes[task.node];
+
+        node->box = emptyAABB();
+        for (unsigned int i = 0; i < node->count; i++) {
+            node->box = mergeAABB(node->box, triangleBoxes[bvh->triangles[node->first + i]]);
+        }
+
+        if (node->count <= MESH_BVH_LEAF_SIZE || task.depth >= MESH_BVH_MAX_DEPTH) continue;
+
+        int axis = 0;
+        float position = 0.0f;
+        if (!findSplit(bvh, node, triangleBoxes, centroids, &axis, &position)) continue;
+
+        // Partition the node's triangle range around the split plane
+        unsigned int i = node->first;
+        unsigned int j = node->first + node->count;
+        while (i < j) {
+            if (axisValue(centroids[bvh->triangles[i]], axis) < position) {
+                i++;
+            }
+            else {
+                unsigned int swap = bvh->triangles[i];
+                bvh->triangles[i] = bvh->triangles[--j];
+                bvh->triangles[j] = swap;
+            }
+        }
+        unsigned int leftCount = i - node->first;
+        if (leftCount == 0 || leftCount == node->count) continue;
+
+        unsigned int left = bvh->nodeCount;
+        bvh->nodeCount += 2;
+        bvh->nodes[left].first = node->first;
+        bvh->nodes[left].count = leftCount;
+        bvh->nodes[left + 1].first = i;
+        bvh->nodes[left + 1].count = node->count - leftCount;
+        node->first = left;
+        node->count = 0;
+
+        tasks[taskCount++] = (BuildTask){ left, task.depth + 1 };
+        tasks[taskCount++] = (BuildTask){ left + 1, task.depth + 1 };
+    }
+
+    free(triangleBoxes);
+    free(centroids);
+    free(tasks);
+    return true;
+}
+
+void freeMeshBVH(MeshBVH* bvh) {
+    free(bvh->nodes);
+    free(bvh->triangles);
+    memset(bvh, 0, sizeof(*bvh));
+}
+
+// Moller-Trumbore; back faces count as hits so picking works from inside open meshes
+static bool intersectTriangle(const Ray* ray, Vector3 a, Vector3 b, Vector3 c, float* t) {
+    Vector3 edge1 = vector_sub(b, a);
+    Vector3 edge2 = vector_sub(c, a);
+    Vector3 p = vector_cross(ray->direction, edge2);
+    float det = vector_dot(edge1, p);
+    if (fabsf(det) < 1e-12f) return false;
+
+    float invDet = 1.0f / det;
+    Vector3 s = vector_sub(ray->origin, a);
+    float u = vector_dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    Vector3 q = vector_cross(s, edge1);
+    float v = vector_dot(ray->direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    *t = vector_dot(edge2, q) * invDet;
+    return *t >= 0.0f;
+}
+
+bool intersectMeshBVH(const MeshBVH* bvh, const Vector3* positions, const unsigned int* indices, const Ray* ray,
+    float maxDistance, float* hitDistance, int* hitTriangle) {
+    if (!bvh->nodes || !intersectRayAABB(ray, bvh->nodes[0].box, maxDistance, NULL)) return false;
+
+    float closest = maxDistance;
+    int closestTriangle = -1;
+
+    // Near-first traversal leaves at most one pending sibling per level. Entries
+    // keep their entry distance so siblings behind a closer hit are skipped.
+    struct { unsigned int node; float distance; } stack[MESH_BVH_MAX_DEPTH + 2];
+    int top = 0;
+    stack[top].node = 0;
+    stack[top++].distance = 0.0f;
+    while (top > 0) {
+        top--;
+        if (stack[top].distance > closest) continue;
+        const MeshBVHNode* node = &bvh->nodes[stack[top].node];
+
+        if (node->count > 0) {
+            for (unsigned int i = 0; i < node->count; i++) {
+                unsigned int triangle = bvh->triangles[node->first + i];
+                const unsigned int* tri = &indices[triangle * 3];
+                float t;
+                if (intersectTriangle(ray, positions[tri[0]], positions[tri[1]], positions[tri[2]], &t) && t < closest) {
+                    closest = t;
+                    closestTriangle = (int)triangle;
+                }
+            }
+            continue;
+        }
+
+        unsigned int left = node->first;
+        unsigned int right = node->first + 1;
+        float leftDistance, rightDistance;
+        bool hitLeft = intersectRayAABB(ray, bvh->nodes[left].box, closest, &leftDistance);
+        bool hitRight = intersectRayAABB(ray, bvh->nodes[right].box, closest, &rightDistance);
+        if (hitLeft && hitRight && rightDistance < leftDistance) {
+            // Visit the right child first
+            unsigned int swapNode = left; left = right; right = swapNode;
+            float swapDistance = leftDistance; leftDistance = rightDistance; rightDistance = swapDistance;
+        }
+        else if (!hitLeft) {
+            left = right;
+            leftDistance = rightDistance;
+            hitLeft = hitRight;
+            hitRight = false;
+        }
+
+        if (hitRight) {
+            stack[top].node = right;
+            stack[top++].distance = rightDistance;
+        }
+        if (hitLeft) {
+            stack[top].node = left;
+            stack[top++].distance = leftDistance;
+        }
+    }
+
+    if (closestTriangle < 0) return false;
+    *hitDistance = closest;
+    *hitTriangle = closestTriangle;
+    return true;
+}
@@ -0,0 +1,105 @@
+#include "picking.h"
+#include "ObjectManager.h"
+#include "rendering.h"
+#include "globals.h"
+#include "matrix.h"
+#include <float.h>
+
+// Builds a normalized world-space ray through a window point (origin top-left)
+Ray screenPointToRay(double x, double y, int width, int height, const Matrix4x4* view, const Matrix4x4* proj) {
+    float ndcX = (float)(2.0 * x / width - 1.0);
+    float ndcY = (float)(1.0 - 2.0 * y / height);
+
+    // Direction in view space for a symmetric perspective projection
+    Vector3 viewDir = vector(ndcX / proj->data[0][0], ndcY / proj->data[1][1], -1.0f);
+
+    // The view matrix is rigid, so its inverse rotation is the transpose
+    const float (*v)[4] = view->data;
+    Vector3 right = vector(v[0][0], v[1][0], v[2][0]);
+    Vector3 up = vector(v[0][1], v[1][1], v[2][1]);
+    Vector3 back = vector(v[0][2], v[1][2], v[2][2]);
+    Vector3 translation = vector(v[3][0], v[3][1], v[3][2]);
+
+    Vector3 origin = vector_negate(vector_add(vector_add(
+        vector_scale(right, translation.x), vector_scale(up, translation.y)), vector_scale(back, translation.z)));
+    Vector3 direction = vector_normalize(vector_add(vector_add(
+        vector_scale(right, viewDir.x), vector_scale(up, viewDir.y)), vector_scale(back, viewDir.z)));
+    return makeRay(origin, direction);
+}
+
+typedef struct {
+    PickResult* result;
+    bool hit;
+} PickQuery;
+
+// Tests one object in its local space. The local direction is left unnormalized,
+// so hit distances stay in world units and can be compared across objects.
+static float pickObjectCallback(int index, const Ray* ray, float maxDistance, void* context) {
+    PickQuery* query = (PickQuery*)context;
+    SceneObject* obj = &objectManager.objects[index];
+
+    const Matrix4x4* modelMatrix = &objectManager.worldMatrices[index];
+    Matrix4x4 inverse;
+    float distance;
+    int mesh = -1;
+    int triangle = -1;
+    bool hit = false;
+
+    if (!invertAffine(modelMatrix, &inverse)) {
+        hit = intersectRayAABB(ray, objectManager.worldBounds[index], maxDistance, &distance);
+    }
+    else {
+        Ray localRay = makeRay(transformPoint(&inverse, ray->origin), transformDirection(&inverse, ray->direction));
+        if (obj->object.type == OBJ_MODEL) {
+            const Model* model = &obj->object.data.model;
+            distance = maxDistance;
+            for (unsigned int i = 0; i < model->meshCount; i++) {
+                const Mesh* m = &model->meshes[i];
+                float meshDistance;
+                int meshTriangle = -1;
+                bool meshHit = m->bvh.nodes
+                    ? intersectMeshBVH(&m->bvh, m->positions, m->indices, &localRay, distance, &meshDistance, &meshTriangle)
+                    : intersectRayAABB(&localRay, m->bounds, distance, &meshDistance);
+                if (meshHit && meshDistance <= distance) {
+                    distance = meshDistance;
+                    mesh = (int)i;
+                    triangle = meshTriangle;
+                    hit = true;
+                }
+            }
+        }
+        else {
+            hit = intersectRayAABB(&localRay, getObjectLocalBounds(obj), maxDistance, &distance);
+        }
+    }
+
+    if (!hit || distance > maxDistance) return maxDistance;
+
+    query->hit = true;
+    query->result->object = obj;
+    query->result->objectIndex = index;
+    query->result->mesh = mesh;
+    query->result->triangle = triangle;
+    query->result->distance = distance;
+    query->result->point = vector_add(ray->origin, vector_scale(ray->direction, distance));
+    return distance;
+}
+
+// Closest object along the ray, through the scene tree and then per-mesh triangle BVHs
+bool pickRay(const Ray* ray, float maxDistance, PickResult* result) {
+    PickQuery query = { result, false };
+    updateTransforms();
+    querySpatialRay(&sceneTree, ray, maxDistance, pickObjectCallback, &query);
+    return query.hit;
+}
+
+bool pickScreenPoint(double x, double y, PickResult* result) {
+    int width, height;
+    glfwGetWindowSize(screen.window, &width, &height);
+    if (width <= 0 || height <= 0) return false;
+
+    Matrix4x4 view = getViewMatrix(&camera);
+    Matrix4x4 proj = getSceneProjectionMatrix();
+    Ray ray = screenPointToRay(x, y, width, height, &view, &proj);
+    return pickRay(&ray, FLT_MAX, result);
+}
@@ -0,0 +1,351 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L  // clock_gettime under strict C11
+#endif
+
+#include "profiler.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define THREAD_LOCAL __declspec(thread)
+typedef SRWLOCK Mutex;
+#define MUTEX_INITIALIZER SRWLOCK_INIT
+#define mutexLock(m) AcquireSRWLockExclusive(m)
+#define mutexUnlock(m) ReleaseSRWLockExclusive(m)
+#define publishCount(p, v) InterlockedExchange64((volatile LONG64*)(p), (LONG64)(v))
+#define readCount(p) ((uint64_t)InterlockedCompareExchange64((volatile LONG64*)(p), 0, 0))
+#else
+#include <pthread.h>
+#include <time.h>
+#define THREAD_LOCAL _Thread_local
+typedef pthread_mutex_t Mutex;
+#define MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define mutexLock(m) pthread_mutex_lock(m)
+#define mutexUnlock(m) pthread_mutex_unlock(m)
+#define publishCount(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define readCount(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#endif
+
+#define EVENT_MASK (PROFILER_EVENTS_PER_THREAD - 1)
+
+typedef struct {
+    const char* name;
+    uint64_t start;  // Nanoseconds since initProfiler
+    uint64_t end;
+    unsigned int frame;
+    int depth;
+} ProfileEvent;
+
+// Only the owning thread writes events and bumps written; readers load written
+// first and re-check it afterwards to drop slots that were overwritten meanwhile.
+typedef struct {
+    ProfileEvent* events;
+    volatile uint64_t written;  // 64 bits so the count never wraps
+    int depth;
+    const char* openNames[PROFILER_MAX_DEPTH];
+    uint64_t openStarts[PROFILER_MAX_DEPTH];
+    char name[32];
+    int id;
+} ProfileThread;
+
+static ProfileThread* threads[PROFILER_MAX_THREADS];
+static volatile uint64_t threadCount = 0;
+static Mutex registerLock = MUTEX_INITIALIZER;
+static THREAD_LOCAL ProfileThread* localThread = NULL;
+static volatile uint64_t frameIndex = 0;
+static bool initialized = false;
+
+static ProfileNode summary[PROFILER_MAX_SUMMARY_NODES];
+static int summaryCount = 0;
+static double frameMs = 0.0;
+static uint64_t frameStart = 0;
+
+static uint64_t nowNs() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint64_t epoch = 0;
+
+// Registration is the only locked path and runs once per thread
+static ProfileThread* currentThread() {
+    if (localThread || !initialized) return localThread;
+
+    mutexLock(&registerLock);
+    unsigned int id = (unsigned int)threadCount;
+    ProfileThread* thread = NULL;
+    if (id < PROFILER_MAX_THREADS) {
+        thread = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+        if (thread) {
+            thread->events = (ProfileEvent*)malloc(PROFILER_EVENTS_PER_THREAD * sizeof(ProfileEvent));
+            if (!thread->events) {
+                free(thread);
+                thread = NULL;
+            }
+        }
+        if (thread) {
+            thread->id = (int)id;
+            snprintf(thread->name, sizeof(thread->name), "thread %u", id);
+            threads[id] = thread;
+            publishCount(&threadCount, id + 1);
+        }
+    }
+    mutexUnlock(&registerLock);
+
+    if (!thread) {
+        fprintf(stderr, "Profiler could not register another thread\n");
+    }
+    localThread = thread;
+    return thread;
+}
+
+void initProfiler() {
+    if (initialized) return;
+    epoch = nowNs();
+    frameStart = epoch;
+    frameIndex = 0;
+    summaryCount = 0;
+    frameMs = 0.0;
+    initialized = true;
+    profilerSetThreadName("main");
+}
+
+// Every other thread must have stopped profiling by now
+void shutdownProfiler() {
+    if (!initialized) return;
+    mutexLock(&registerLock);
+    unsigned int count = (unsigned int)threadCount;
+    for (unsigned int i = 0; i < count; i++) {
+        free(threads[i]->events);
+        free(threads[i]);
+        threads[i] = NULL;
+    }
+    publishCount(&threadCount, 0);
+    mutexUnlock(&registerLock);
+    localThread = NULL;
+    summaryCount = 0;
+    initialized = false;
+}
+
+void profilerSetThreadName(const char* name) {
+    ProfileThread* thread = currentThread();
+    if (!thread) return;
+    strncpy(thread->name, name, sizeof(thread->name) - 1);
+    thread->name[sizeof(thread->name) - 1] = '\0';
+}
+
+void profileBegin(const char* name) {
+    ProfileThread* thread = currentThread();
+    if (!thread) return;
+    // Scopes deeper than the stack still nest correctly but are not recorded
+    if (thread->depth < PROFILER_MAX_DEPTH) {
+        thread->openNames[thread->depth] = name;
+        thread->openStarts[thread->depth] = nowNs();
+    }
+    thread->depth++;
+}
+
+void profileEnd() {
+    ProfileThread* thread = localThread;
+    if (!thread || thread->depth == 0) return;
+    int depth = --thread->depth;
+    if (depth >= PROFILER_MAX_DEPTH) return;
+
+    uint64_t index = thread->written;
+    ProfileEvent* event = &thread->events[index & EVENT_MASK];
+    event->name = thread->openNames[depth];
+    event->start = thread->openStarts[depth] - epoch;
+    event->end = nowNs() - epoch;
+    event->frame = (unsigned int)frameIndex;
+    event->depth = depth;
+    publishCount(&thread->written, index + 1);
+}
+
+static int compareEventStart(const void* a, const void* b) {
+    const ProfileEvent* x = (const ProfileEvent*)a;
+    const ProfileEvent* y = (const ProfileEvent*)b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return x->depth - y->depth;  // Parents before children starting on the same tick
+}
+
+// Merges calls with the same name under the same parent, then flattens depth first
+typedef struct {
+    const char* name;
+    int depth;
+    int calls;
+    double ms;
+    int parent;
+    int firstChild;
+    int lastChild;
+    int nextSibling;
+} SummaryBuildNode;
+
+static void flattenSummary(const SummaryBuildNode* nodes, int node) {
+    for (; node >= 0 && summaryCount < PROFILER_MAX_SUMMARY_NODES; node = nodes[node].nextSibling) {
+        ProfileNode* out = &summary[summaryCount++];
+        out->name = nodes[node].name;
+        out->depth = nodes[node].depth;
+        out->calls = nodes[node].calls;
+        out->ms = nodes[node].ms;
+        flattenSummary(nodes, nodes[node].firstChild);
+    }
+}
+
+static void buildSummary(ProfileThread* thread, unsigned int frame) {
+    // The frame's events are the newest ones in the ring
+    uint64_t written = thread->written;
+    unsigned int count = 0;
+    while (count < written && count < PROFILER_EVENTS_PER_THREAD
+        && thread->events[(written - 1 - count) & EVENT_MASK].frame == frame) {
+        count++;
+    }
+
+    summaryCount = 0;
+    if (count == 0) return;
+    ProfileEvent* events = (ProfileEvent*)malloc(count * sizeof(ProfileEvent));
+    SummaryBuildNode* nodes = (SummaryBuildNode*)malloc(PROFILER_MAX_SUMMARY_NODES * sizeof(SummaryBuildNode));
+    if (!events || !nodes) {
+        free(events);
+        free(nodes);
+        return;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        events[i] = thread->events[(written - count + i) & EVENT_MASK];
+    }
+    qsort(events, count, sizeof(ProfileEvent), compareEventStart);
+
+    int nodeCount = 0;
+    int firstRoot = -1, lastRoot = -1;
+    int open[PROFILER_MAX_DEPTH];
+    for (int i = 0; i < PROFILER_MAX_DEPTH; i++) open[i] = -1;
+    for (unsigned int i = 0; i < count; i++) {
+        const ProfileEvent* event = &events[i];
+        int parent = event->depth > 0 ? open[event->depth - 1] : -1;
+        if (event->depth > 0 && parent < 0) continue;  // Parent was dropped
+
+        int first = parent >= 0 ? nodes[parent].firstChild : firstRoot;
+        int node = first;
+        while (node >= 0 && strcmp(nodes[node].name, event->name) != 0) {
+            node = nodes[node].nextSibling;
+        }
+        if (node < 0) {
+            if (nodeCount == PROFILER_MAX_SUMMARY_NODES) {
+                open[event->depth] = -1;
+                continue;
+            }
+            node = nodeCount++;
+            nodes[node] = (SummaryBuildNode){ event->name, event->depth, 0, 0.0, parent, -1, -1, -1 };
+            if (parent >= 0) {
+                if (nodes[parent].lastChild >= 0) nodes[nodes[parent].lastChild].nextSibling = node;
+                else nodes[parent].firstChild = node;
+                nodes[parent].lastChild = node;
+            }
+            else {
+                if (lastRoot >= 0) nodes[lastRoot].nextSibling = node;
+                else firstRoot = node;
+                lastRoot = node;
+            }
+        }
+        nodes[node].calls++;
+        nodes[node].ms += (double)(event->end - event->start) * 1e-6;
+        open[event->depth] = node;
+    }
+
+    flattenSummary(nodes, firstRoot);
+    free(events);
+    free(nodes);
+}
+
+void profilerBeginFrame() {
+    if (!initialized) return;
+    uint64_t now = nowNs();
+    frameMs = (double)(now - frameStart) * 1e-6;
+    frameStart = now;
+
+    unsigned int finished = (unsigned int)frameIndex;
+    publishCount(&frameIndex, (uint64_t)finished + 1);
+    ProfileThread* thread = currentThread();
+    if (thread) buildSummary(thread, finished);
+}
+
+int getProfilerSummary(const ProfileNode** nodes) {
+    *nodes = summary;
+    return summaryCount;
+}
+
+double getProfilerFrameMs() {
+    return frameMs;
+}
+
+static void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        if ((unsigned char)*c >= 0x20) fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool writeChromeTrace(const char* path) {
+    if (!initialized) return false;
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        return false;
+    }
+    ProfileEvent* copy = (ProfileEvent*)malloc(PROFILER_EVENTS_PER_THREAD * sizeof(ProfileEvent));
+    if (!copy) {
+        fclose(file);
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    unsigned int count = (unsigned int)readCount(&threadCount);
+    for (unsigned int t = 0; t < count; t++) {
+        ProfileThread* thread = threads[t];
+        fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": ",
+            first ? "" : ",\n", thread->id);
+        writeJsonString(file, thread->name);
+        fprintf(file, "}}");
+        first = false;
+
+        // Copy first, then drop the slots the writer may have reused meanwhile
+        uint64_t end = readCount(&thread->written);
+        uint64_t begin = end > PROFILER_EVENTS_PER_THREAD ? end - PROFILER_EVENTS_PER_THREAD : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            copy[i - begin] = thread->events[i & EVENT_MASK];
+        }
+        // The writer may already be filling slot after, which held event after - N
+        uint64_t after = readCount(&thread->written);
+        uint64_t valid = after + 1 > PROFILER_EVENTS_PER_THREAD ? after + 1 - PROFILER_EVENTS_PER_THREAD : 0;
+        if (valid < begin) valid = begin;
+
+        for (uint64_t i = valid; i < end; i++) {
+            const ProfileEvent* event = &copy[i - begin];
+            fprintf(file, ",\n{\"name\": ");
+            writeJsonString(file, event->name);
+            fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %u}}",
+                thread->id, (double)event->start * 1e-3, (double)(event->end - event->start) * 1e-3, event->frame);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    free(copy);
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    if (ok) printf("Wrote CPU trace to %s\n", path);
+    return ok;
+}
@@ -0,0 +1,411 @@
+#include "spatial.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SPATIAL_STACK_SIZE 256
+
+static float surfaceArea(AABB box) {
+    Vector3 size = vector_sub(box.max, box.min);
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static bool containsAABB(AABB outer, AABB inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+        && outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+static bool overlapsAABB(AABB a, AABB b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x
+        && a.min.y <= b.max.y && a.max.y >= b.min.y
+        && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+static AABB fattenAABB(AABB box) {
+    Vector3 size = vector_sub(box.max, box.min);
+    Vector3 margin = {
+        size.x * SPATIAL_FAT_MARGIN + SPATIAL_FAT_MIN,
+        size.y * SPATIAL_FAT_MARGIN + SPATIAL_FAT_MIN,
+        size.z * SPATIAL_FAT_MARGIN + SPATIAL_FAT_MIN
+    };
+    return makeAABB(vector_sub(box.min, margin), vector_add(box.max, margin));
+}
+
+void initSpatialTree(SpatialTree* tree) {
+    memset(tree, 0, sizeof(*tree));
+    tree->root = SPATIAL_NULL_NODE;
+    tree->freeList = SPATIAL_NULL_NODE;
+}
+
+void freeSpatialTree(SpatialTree* tree) {
+    free(tree->nodes);
+    initSpatialTree(tree);
+}
+
+static int allocateNode(SpatialTree* tree) {
+    if (tree->freeList == SPATIAL_NULL_NODE) {
+        int newCapacity = tree->nodeCapacity ? tree->nodeCapacity * 2 : 64;
+        SpatialNode* grown = (SpatialNode*)realloc(tree->nodes, newCapacity * sizeof(SpatialNode));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow spatial tree.\n");
+            exit(EXIT_FAILURE);
+        }
+        tree->nodes = grown;
+        // Thread the new nodes onto the free list
+        for (int i = tree->nodeCapacity; i < newCapacity; i++) {
+            tree->nodes[i].parent = (i + 1 < newCapacity) ? i + 1 : SPATIAL_NULL_NODE;
+            tree->nodes[i].height = -1;
+        }
+        tree->freeList = tree->nodeCapacity;
+        tree->nodeCapacity = newCapacity;
+    }
+
+    int node = tree->freeList;
+    tree->freeList = tree->nodes[node].parent;
+    tree->nodes[node].parent = SPATIAL_NULL_NODE;
+    tree->nodes[node].left = SPATIAL_NULL_NODE;
+    tree->nodes[node].right = SPATIAL_NULL_NODE;
+    tree->nodes[node].height = 0;
+    tree->nodes[node].userData = -1;
+    tree->nodeCount++;
+    return node;
+}
+
+static void releaseNode(SpatialTree* tree, int node) {
+    tree->nodes[node].parent = tree->freeList;
+    tree->nodes[node].height = -1;
+    tree->freeList = node;
+    tree->nodeCount--;
+}
+
+static int maxInt(int a, int b) {
+    return a > b ? a : b;
+}
+
+// AVL-style rotation: promotes the taller grandchild when the subtree at a is unbalanced
+static int balance(SpatialTree* tree, int a) {
+    SpatialNode* A = &tree->nodes[a];
+    if (A->height < 2) return a;
+
+    int b = A->left;
+    int c = A->right;
+    SpatialNode* B = &tree->nodes[b];
+    SpatialNode* C = &tree->nodes[c];
+    int diff = C->height - B->height;
+
+    if (diff > 1) {
+        // Rotate C up
+        int f = C->left;
+        int g = C->right;
+        SpatialNode* F = &tree->nodes[f];
+        SpatialNode* G = &tree->nodes[g];
+
+        C->left = a;
+        C->parent = A->parent;
+        A->parent = c;
+        if (C->parent != SPATIAL_NULL_NODE) {
+            if (tree->nodes[C->parent].left == a) tree->nodes[C->parent].left = c;
+            else tree->nodes[C->parent].right = c;
+        }
+        else {
+            tree->root = c;
+        }
+
+        if (F->height > G->height) {
+            C->right = f;
+            A->right = g;
+            G->parent = a;
+            A->box = mergeAABB(B->box, G->box);
+            C->box = mergeAABB(A->box, F->box);
+            A->height = 1 + maxInt(B->height, G->height);
+            C->height = 1 + maxInt(A->height, F->height);
+        }
+        else {
+            C->right = g;
+            A->right = f;
+            F->parent = a;
+            A->box = mergeAABB(B->box, F->box);
+            C->box = mergeAABB(A->box, G->box);
+            A->height = 1 + maxInt(B->height, F->height);
+            C->height = 1 + maxInt(A->height, G->height);
+        }
+        return c;
+    }
+
+    if (diff < -1) {
+        // Rotate B up
+        int d = B->left;
+        int e = B->right;
+        SpatialNode* D = &tree->nodes[d];
+        SpatialNode* E = &tree->nodes[e];
+
+        B->left = a;
+        B->parent = A->parent;
+        A->parent = b;
+        if (B->parent != SPATIAL_NULL_NODE) {
+            if (tree->nodes[B->parent].left == a) tree->nodes[B->parent].left = b;
+            else tree->nodes[B->parent].right = b;
+        }
+        else {
+            tree->root = b;
+        }
+
+        if (D->height > E->height) {
+            B->right = d;
+            A->left = e;
+            E->parent = a;
+            A->box = mergeAABB(C->box, E->box);
+            B->box = mergeAABB(A->box, D->box);
+            A->height = 1 + maxInt(C->height, E->height);
+            B->height = 1 + maxInt(A->height, D->height);
+        }
+        else {
+            B->right = e;
+            A->left = d;
+            D->parent = a;
+            A->box = mergeAABB(C->box, D->box);
+            B->box = mergeAABB(A->box, E->box);
+            A->height = 1 + maxInt(C->height, D->height);
+            B->height = 1 + maxInt(A->height, E->height);
+        }
+        return b;
+    }
+
+    return a;
+}
+
+// Walk back to the root, rebalancing and refitting every ancestor
+static void refitAncestors(SpatialTree* tree, int node) {
+    while (node != SPATIAL_NULL_NODE) {
+        node = balance(tree, node);
+        SpatialNode* n = &tree->nodes[node];
+        n->height = 1 + maxInt(tree->nodes[n->left].height, tree->nodes[n->right].height);
+        n->box = mergeAABB(tree->nodes[n->left].box, tree->nodes[n->right].box);
+        node = n->parent;
+    }
+}
+
+// Descends toward the sibling with the lowest surface area increase
+static void insertLeaf(SpatialTree* tree, int leaf) {
+    if (tree->root == SPATIAL_NULL_NODE) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = SPATIAL_NULL_NODE;
+        return;
+    }
+
+    AABB leafBox = tree->nodes[leaf].box;
+    int index = tree->root;
+    while (tree->nodes[index].height > 0) {
+        SpatialNode* n = &tree->nodes[index];
+        float area = surfaceArea(n->box);
+        float combinedArea = surfaceArea(mergeAABB(n->box, leafBox));
+
+        // Cost of pairing with this node, and the cost pushed down to either child
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        int children[2] = { n->left, n->right };
+        for (int i = 0; i < 2; i++) {
+            SpatialNode* child = &tree->nodes[children[i]];
+            float merged = surfaceArea(mergeAABB(child->box, leafBox));
+            childCost[i] = (child->height == 0 ? merged : merged - surfaceArea(child->box)) + inheritance;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    int sibling = index;
+    int oldParent = tree->nodes[sibling].parent;
+    int newParent = allocateNode(tree);
+    tree->nodes[newParent].parent = oldParent;
+    tree->nodes[newParent].box = mergeAABB(leafBox, tree->nodes[sibling].box);
+    tree->nodes[newParent].height = tree->nodes[sibling].height + 1;
+    tree->nodes[newParent].left = sibling;
+    tree->nodes[newParent].right = leaf;
+    tree->nodes[sibling].parent = newParent;
+    tree->nodes[leaf].parent = newParent;
+
+    if (oldParent != SPATIAL_NULL_NODE) {
+        if (tree->nodes[oldParent].left == sibling) tree->nodes[oldParent].left = newParent;
+        else tree->nodes[oldParent].right = newParent;
+    }
+    else {
+        tree->root = newParent;
+    }
+
+    refitAncestors(tree, tree->nodes[leaf].parent);
+}
+
+static void removeLeaf(SpatialTree* tree, int leaf) {
+    if (leaf == tree->root) {
+        tree->root = SPATIAL_NULL_NODE;
+        return;
+    }
+
+    int parent = tree->nodes[leaf].parent;
+    int grandParent = tree->nodes[parent].parent;
+    int sibling = tree->nodes[parent].left == leaf ? tree->nodes[parent].right : tree->nodes[parent].left;
+
+    if (grandParent != SPATIAL_NULL_NODE) {
+        // The sibling takes the parent's place
+        if (tree->nodes[grandParent].left == parent) tree->nodes[grandParent].left = sibling;
+        else tree->nodes[grandParent].right = sibling;
+        tree->nodes[sibling].parent = grandParent;
+        releaseNode(tree, parent);
+        refitAncestors(tree, grandParent);
+    }
+    else {
+        tree->root = sibling;
+        tree->nodes[sibling].parent = SPATIAL_NULL_NODE;
+        releaseNode(tree, parent);
+    }
+}
+
+int createProxy(SpatialTree* tree, AABB box, int userData) {
+    int leaf = allocateNode(tree);
+    tree->nodes[leaf].box = fattenAABB(box);
+    tree->nodes[leaf].userData = userData;
+    insertLeaf(tree, leaf);
+    tree->leafCount++;
+    return leaf;
+}
+
+void destroyProxy(SpatialTree* tree, int proxy) {
+    if (proxy < 0 || proxy >= tree->nodeCapacity || tree->nodes[proxy].height != 0) return;
+    removeLeaf(tree, proxy);
+    releaseNode(tree, proxy);
+    tree->leafCount--;
+}
+
+// Returns true when the proxy had to be reinserted. Boxes that still fit inside
+// the fat box are a no-op, which makes small edits and drags cheap.
+bool moveProxy(SpatialTree* tree, int proxy, AABB box) {
+    if (proxy < 0 || proxy >= tree->nodeCapacity || tree->nodes[proxy].height != 0) return false;
+
+    AABB fat = tree->nodes[proxy].box;
+    if (containsAABB(fat, box)) {
+        // Still refit when the box shrank a lot, or the tree stays loose forever
+        AABB refit = fattenAABB(box);
+        if (surfaceArea(fat) <= 4.0f * surfaceArea(refit)) return false;
+    }
+
+    removeLeaf(tree, proxy);
+    tree->nodes[proxy].box = fattenAABB(box);
+    insertLeaf(tree, proxy);
+    return true;
+}
+
+void setProxyUserData(SpatialTree* tree, int proxy, int userData) {
+    if (proxy < 0 || proxy >= tree->nodeCapacity || tree->nodes[proxy].height != 0) return;
+    tree->nodes[proxy].userData = userData;
+}
+
+int getSpatialTreeHeight(const SpatialTree* tree) {
+    return tree->root == SPATIAL_NULL_NODE ? 0 : tree->nodes[tree->root].height;
+}
+
+void querySpatialBox(const SpatialTree* tree, AABB box, SpatialQueryCallback callback, void* context) {
+    if (tree->root == SPATIAL_NULL_NODE) return;
+
+    int stack[SPATIAL_STACK_SIZE];
+    int top = 0;
+    stack[top++] = tree->root;
+    while (top > 0) {
+        const SpatialNode* node = &tree->nodes[stack[--top]];
+        if (!overlapsAABB(node->box, box)) continue;
+
+        if (node->height == 0) {
+            if (!callback(node->userData, context)) return;
+        }
+        else if (top + 2 <= SPATIAL_STACK_SIZE) {
+            stack[top++] = node->left;
+            stack[top++] = node->right;
+        }
+    }
+}
+
+// Reports every leaf under a node without testing it again
+static bool reportSubtree(const SpatialTree* tree, int root, SpatialQueryCallback callback, void* context) {
+    int stack[SPATIAL_STACK_SIZE];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const SpatialNode* node = &tree->nodes[stack[--top]];
+        if (node->height == 0) {
+            if (!callback(node->userData, context)) return false;
+        }
+        else if (top + 2 <= SPATIAL_STACK_SIZE) {
+            stack[top++] = node->left;
+            stack[top++] = node->right;
+        }
+    }
+    return true;
+}
+
+// Leaves are reported by their fat boxes, so callers that need exact visibility
+// should test the tight bounds of what comes back
+void querySpatialFrustum(const SpatialTree* tree, const Frustum* frustum, SpatialQueryCallback callback, void* context) {
+    if (tree->root == SPATIAL_NULL_NODE) return;
+
+    int stack[SPATIAL_STACK_SIZE];
+    int top = 0;
+    stack[top++] = tree->root;
+    while (top > 0) {
+        int index = stack[--top];
+        const SpatialNode* node = &tree->nodes[index];
+        FrustumTest test = classifyAABB(frustum, node->box);
+        if (test == FRUSTUM_OUTSIDE) continue;
+
+        if (node->height == 0) {
+            if (!callback(node->userData, context)) return;
+        }
+        else if (test == FRUSTUM_INSIDE) {
+            if (!reportSubtree(tree, index, callback, context)) return;
+        }
+        else if (top + 2 <= SPATIAL_STACK_SIZE) {
+            stack[top++] = node->left;
+            stack[top++] = node->right;
+        }
+    }
+}
+
+// Visits leaves roughly front to back, so callbacks that clip the ray prune most of the tree
+void querySpatialRay(const SpatialTree* tree, const Ray* ray, float maxDistance, SpatialRayCallback callback, void* context) {
+    if (tree->root == SPATIAL_NULL_NODE) return;
+    if (!intersectRayAABB(ray, tree->nodes[tree->root].box, maxDistance, NULL)) return;
+
+    int stack[SPATIAL_STACK_SIZE];
+    int top = 0;
+    stack[top++] = tree->root;
+    while (top > 0) {
+        const SpatialNode* node = &tree->nodes[stack[--top]];
+
+        if (node->height == 0) {
+            // Parents were tested against an older, longer ray; retest the leaf
+            if (!intersectRayAABB(ray, node->box, maxDistance, NULL)) continue;
+            maxDistance = callback(node->userData, ray, maxDistance, context);
+            if (maxDistance < 0.0f) return;
+            continue;
+        }
+
+        float leftDistance, rightDistance;
+        bool hitLeft = intersectRayAABB(ray, tree->nodes[node->left].box, maxDistance, &leftDistance);
+        bool hitRight = intersectRayAABB(ray, tree->nodes[node->right].box, maxDistance, &rightDistance);
+        if (top + 2 > SPATIAL_STACK_SIZE) continue;
+
+        // Push the far child first so the near one is popped next
+        if (hitLeft && hitRight) {
+            bool leftFirst = leftDistance <= rightDistance;
+            stack[top++] = leftFirst ? node->right : node->left;
+            stack[top++] = leftFirst ? node->left : node->right;
+        }
+        else if (hitLeft) {
+            stack[top++] = node->left;
+        }
+        else if (hitRight) {
+            stack[top++] = node->right;
+        }
+    }
+}
@@ -0,0 +1,177 @@
+#include "culling.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULL_SIMD_WIDTH 8
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define CULL_SIMD_WIDTH 4
+#else
+#define CULL_SIMD_WIDTH 1
+#endif
+
+// Gribb/Hartmann plane extraction. viewProj maps world space to clip space and
+// is stored column-major, so row r of the matrix is data[0..3][r].
+Frustum extractFrustum(const Matrix4x4* viewProj) {
+    Frustum frustum;
+    const float (*m)[4] = viewProj->data;
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;  // Left/bottom/near add, right/top/far subtract
+        Vector4 plane = {
+            m[0][3] + sign * m[0][row],
+            m[1][3] + sign * m[1][row],
+            m[2][3] + sign * m[2][row],
+            m[3][3] + sign * m[3][row]
+        };
+        float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        if (length > 0.0f) {
+            plane.x /= length;
+            plane.y /= length;
+            plane.z /= length;
+            plane.w /= length;
+        }
+        frustum.planes[i] = plane;
+    }
+    return frustum;
+}
+
+FrustumTest classifyAABB(const Frustum* frustum, AABB box) {
+    Vector3 center = aabbCenter(box);
+    Vector3 extents = aabbExtents(box);
+    FrustumTest result = FRUSTUM_INSIDE;
+    for (int p = 0; p < 6; p++) {
+        const Vector4* plane = &frustum->planes[p];
+        float distance = plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w;
+        float radius = fabsf(plane->x) * extents.x + fabsf(plane->y) * extents.y + fabsf(plane->z) * extents.z;
+        if (distance + radius < 0.0f) return FRUSTUM_OUTSIDE;
+        if (distance - radius < 0.0f) result = FRUSTUM_INTERSECTS;
+    }
+    return result;
+}
+
+void reserveBoundsSoA(BoundsSoA* bounds, int capacity) {
+    if (capacity <= bounds->capacity) return;
+
+    float** arrays[6] = { &bounds->centerX, &bounds->centerY, &bounds->centerZ, &bounds->extentX, &bounds->extentY, &bounds->extentZ };
+    for (int i = 0; i < 6; i++) {
+        float* grown = (float*)realloc(*arrays[i], capacity * sizeof(float));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow culling bounds.\n");
+            exit(EXIT_FAILURE);
+        }
+        *arrays[i] = grown;
+    }
+    bounds->capacity = capacity;
+}
+
+void freeBoundsSoA(BoundsSoA* bounds) {
+    free(bounds->centerX);
+    free(bounds->centerY);
+    free(bounds->centerZ);
+    free(bounds->extentX);
+    free(bounds->extentY);
+    free(bounds->extentZ);
+    bounds->centerX = bounds->centerY = bounds->centerZ = NULL;
+    bounds->extentX = bounds->extentY = bounds->extentZ = NULL;
+    bounds->count = 0;
+    bounds->capacity = 0;
+}
+
+void setBoundsSoA(BoundsSoA* bounds, int index, AABB box) {
+    Vector3 center = aabbCenter(box);
+    Vector3 extents = aabbExtents(box);
+    bounds->centerX[index] = center.x;
+    bounds->centerY[index] = center.y;
+    bounds->centerZ[index] = center.z;
+    bounds->extentX[index] = extents.x;
+    bounds->extentY[index] = extents.y;
+    bounds->extentZ[index] = extents.z;
+}
+
+// A box is outside when it lies entirely behind any plane: n.c + w + |n|.e < 0
+static unsigned char testBox(const Frustum* frustum, const BoundsSoA* bounds, int i) {
+    for (int p = 0; p < 6; p++) {
+        const Vector4* plane = &frustum->planes[p];
+        float distance = plane->x * bounds->centerX[i] + plane->y * bounds->centerY[i] + plane->z * bounds->centerZ[i] + plane->w;
+        float radius = fabsf(plane->x) * bounds->extentX[i] + fabsf(plane->y) * bounds->extentY[i] + fabsf(plane->z) * bounds->extentZ[i];
+        if (distance + radius < 0.0f) return 0;
+    }
+    return 1;
+}
+
+// Writes 1 to visible[i] for every box intersecting the frustum and returns how many did
+int cullBounds(const Frustum* frustum, const BoundsSoA* bounds, unsigned char* visible) {
+    int i = 0;
+    int visibleCount = 0;
+
+#if CULL_SIMD_WIDTH == 8
+    __m256 signMask = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= bounds->count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(bounds->centerX + i);
+        __m256 cy = _mm256_loadu_ps(bounds->centerY + i);
+        __m256 cz = _mm256_loadu_ps(bounds->centerZ + i);
+        __m256 ex = _mm256_loadu_ps(bounds->extentX + i);
+        __m256 ey = _mm256_loadu_ps(bounds->extentY + i);
+        __m256 ez = _mm256_loadu_ps(bounds->extentZ + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (int p = 0; p < 6; p++) {
+            const Vector4* plane = &frustum->planes[p];
+            __m256 nx = _mm256_set1_ps(plane->x);
+            __m256 ny = _mm256_set1_ps(plane->y);
+            __m256 nz = _mm256_set1_ps(plane->z);
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)),
+                _mm256_add_ps(_mm256_mul_ps(nz, cz), _mm256_set1_ps(plane->w)));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_andnot_ps(signMask, nx), ex),
+                _mm256_mul_ps(_mm256_andnot_ps(signMask, ny), ey)), _mm256_mul_ps(_mm256_andnot_ps(signMask, nz), ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++) {
+            visible[i + lane] = (mask >> lane) & 1;
+            visibleCount += (mask >> lane) & 1;
+        }
+    }
+#elif CULL_SIMD_WIDTH == 4
+    __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= bounds->count; i += 4) {
+        __m128 cx = _mm_loadu_ps(bounds->centerX + i);
+        __m128 cy = _mm_loadu_ps(bounds->centerY + i);
+        __m128 cz = _mm_loadu_ps(bounds->centerZ + i);
+        __m128 ex = _mm_loadu_ps(bounds->extentX + i);
+        __m128 ey = _mm_loadu_ps(bounds->extentY + i);
+        __m128 ez = _mm_loadu_ps(bounds->extentZ + i);
+        __m128 inside = _mm_cmpeq_ps(_mm_setzero_ps(), _mm_setzero_ps());  // All lanes set
+
+        for (int p = 0; p < 6; p++) {
+            const Vector4* plane = &frustum->planes[p];
+            __m128 nx = _mm_set1_ps(plane->x);
+            __m128 ny = _mm_set1_ps(plane->y);
+            __m128 nz = _mm_set1_ps(plane->z);
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(plane->w)));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex),
+                _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)), _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++) {
+            visible[i + lane] = (mask >> lane) & 1;
+            visibleCount += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+    // Scalar tail, and the whole array on targets without SIMD
+    for (; i < bounds->count; i++) {
+        visible[i] = testBox(frustum, bounds, i);
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
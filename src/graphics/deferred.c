@@ -0,0 +1,75 @@
+#include "deferred.h"
+#include "glstate.h"
+#include "headless.h"
+#include "rendertarget.h"
+#include "scenetarget.h"
+#include "shaders.h"
+#include <stdio.h>
+
+static RenderTarget target;
+static GLuint albedoTexture = 0;
+static GLuint normalTexture = 0;
+static GLuint materialTexture = 0;
+static GLuint depthTexture = 0;
+static ShaderProgram lightingProgram;
+
+bool initDeferred() {
+    lightingProgram = loadShader("shaders/deferred/lightingVertex.glsl", "shaders/deferred/lightingFragment.glsl");
+    if (lightingProgram.id == 0) {
+        fprintf(stderr, "Failed to load deferred lighting shader\n");
+        return false;
+    }
+
+    // The object shader writes albedo to location 0 and the rest to 2 and 3;
+    // location 1 belongs to the OIT revealage output
+    createRenderTarget(&target, "G-buffer");
+    albedoTexture = addTargetTexture(&target, GL_COLOR_ATTACHMENT0, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    normalTexture = addTargetTexture(&target, GL_COLOR_ATTACHMENT1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    materialTexture = addTargetTexture(&target, GL_COLOR_ATTACHMENT2, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    // Matches the default framebuffer's depth so the blit in endGBufferPass is legal
+    depthTexture = addTargetTexture(&target, GL_DEPTH_STENCIL_ATTACHMENT, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    const GLenum drawBuffers[4] = { GL_COLOR_ATTACHMENT0, GL_NONE, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(4, drawBuffers);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    invalidateStateCache();
+    return true;
+}
+
+void cleanupDeferred() {
+    deleteRenderTarget(&target);
+    deleteShader(&lightingProgram);
+    albedoTexture = normalTexture = materialTexture = depthTexture = 0;
+}
+
+bool beginGBufferPass(int width, int height) {
+    if (!target.framebuffer || width <= 0 || height <= 0 || !resizeRenderTarget(&target, width, height)) {
+        return false;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    stateDepthMask(GL_TRUE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    return true;
+}
+
+void endGBufferPass() {
+    // Skybox and translucent surfaces test against the opaque depth
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, getSceneFramebuffer());
+    glBlitFramebuffer(0, 0, target.width, target.height, 0, 0, target.width, target.height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, getSceneFramebuffer());
+
+    // Background pixels are discarded, leaving them to the skybox
+    stateDisable(GL_DEPTH_TEST);
+    stateDisable(GL_BLEND);
+    stateUseProgram(lightingProgram.id);
+    stateBindTexture(DEFERRED_UNIT_ALBEDO, GL_TEXTURE_2D, albedoTexture);
+    stateBindTexture(DEFERRED_UNIT_NORMAL, GL_TEXTURE_2D, normalTexture);
+    stateBindTexture(DEFERRED_UNIT_MATERIAL, GL_TEXTURE_2D, materialTexture);
+    stateBindTexture(DEFERRED_UNIT_DEPTH, GL_TEXTURE_2D, depthTexture);
+    drawFullscreenTriangle();
+
+    stateEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,212 @@
+#include "framebuild.h"
+#include "ObjectManager.h"
+#include "globals.h"
+#include "matrix.h"
+#include "lod.h"
+#include "jobs.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// What a candidate turned into
+#define FRAME_QUEUE_NONE        0
+#define FRAME_QUEUE_OPAQUE      1
+#define FRAME_QUEUE_TRANSPARENT 2
+
+static void* growBuffer(void* buffer, size_t elementSize, int count) {
+    void* grown = realloc(buffer, elementSize * count);
+    if (!grown) {
+        fprintf(stderr, "Failed to grow frame build buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    return grown;
+}
+
+// Both sizes only ever grow, so a steady scene allocates nothing per frame
+static void reserveFrameBuild(FrameBuild* build, int objectCapacity, int candidateCount) {
+    if (objectCapacity > build->objectCapacity) {
+        build->instances = (InstanceData*)growBuffer(build->instances, sizeof(InstanceData), objectCapacity);
+        build->lodLevels = (unsigned char*)growBuffer(build->lodLevels, sizeof(unsigned char), objectCapacity);
+        build->objectCapacity = objectCapacity;
+    }
+    if (candidateCount > build->candidateCapacity) {
+        reserveBoundsSoA(&build->bounds, candidateCount);
+        build->candidates = (int*)growBuffer(build->candidates, sizeof(int), candidateCount);
+        build->visible = (unsigned char*)growBuffer(build->visible, sizeof(unsigned char), candidateCount);
+        build->queued = (unsigned char*)growBuffer(build->queued, sizeof(unsigned char), candidateCount);
+        build->keys = (uint64_t*)growBuffer(build->keys, sizeof(uint64_t), candidateCount);
+        build->distances = (float*)growBuffer(build->distances, sizeof(float), candidateCount);
+        build->candidateCapacity = candidateCount;
+    }
+    if (!build->opaque.packets) {
+        initRenderQueue(&build->opaque, objectCapacity);
+    }
+}
+
+static bool collectCandidate(int index, void* context) {
+    FrameBuild* build = (FrameBuild*)context;
+    build->candidates[build->candidateCount++] = index;
+    return true;
+}
+
+// Shader variant bits mirror the branches selected in setShaderUniforms
+static unsigned int shaderVariant(unsigned char flags) {
+    unsigned int variant = 0;
+    if (usePBR && (flags & OBJECT_FLAG_PBR)) variant |= 1u << 0;
+    if (texturesEnabled && (flags & OBJECT_FLAG_TEXTURE) && !(flags & OBJECT_FLAG_PBR)) variant |= 1u << 1;
+    if (colorsEnabled && (flags & OBJECT_FLAG_COLOR)) variant |= 1u << 2;
+    return variant;
+}
+
+static uint64_t buildSortKey(const FrameBuild* build, int index, Vector3 position, int lod) {
+    const ObjectRenderState* state = &objectManager.renderStates[index];
+    unsigned int variant = shaderVariant(state->flags);
+    // Unregistered materials share bucket 0xFF so they still group together
+    int material = (variant & 1u) ? objectManager.materialRefs[index] : 0;
+    unsigned int texture = ((state->flags & OBJECT_FLAG_TEXTURE) && texturesEnabled) ? (unsigned int)state->textureID : 0;
+    float viewDepth = vector_dot(vector_sub(position, build->eye), build->front);
+    float depth = (viewDepth - build->nearPlane) / (build->farPlane - build->nearPlane);
+    return makeSortKey(RENDER_PASS_OPAQUE, variant, material < 0 ? 0xFF : (unsigned int)material, texture, state->vao,
+        (unsigned int)lod, depth);
+}
+
+// Tests one chunk of candidates against the frustum and prepares every visible
+// one for its queue. Chunks touch disjoint candidates and objects, and only
+// read the scene.
+static void buildChunk(int chunk, void* context) {
+    FrameBuild* build = (FrameBuild*)context;
+    int first = chunk * FRAME_BUILD_CHUNK;
+    int last = first + FRAME_BUILD_CHUNK;
+    if (last > build->candidateCount) last = build->candidateCount;
+
+    for (int i = first; i < last; i++) {
+        setBoundsSoA(&build->bounds, i, objectManager.worldBounds[build->candidates[i]]);
+    }
+    BoundsSoA range = {
+        build->bounds.centerX + first, build->bounds.centerY + first, build->bounds.centerZ + first,
+        build->bounds.extentX + first, build->bounds.extentY + first, build->bounds.extentZ + first,
+        last - first, last - first
+    };
+    Matrix4x4 viewProj;
+    matrixMultiplyInto(&build->view, &build->projection, &viewProj);
+    Frustum frustum = extractFrustum(&viewProj);
+    cullBounds(&frustum, &range, build->visible + first);
+
+    float projScale = build->projection.data[1][1];
+    for (int i = first; i < last; i++) {
+        build->queued[i] = FRAME_QUEUE_NONE;
+        if (!build->visible[i]) continue;
+
+        int index = build->candidates[i];
+        // Detail level hysteresis reads last frame's level, written back once the build is done
+        int lod = objectManager.lodLevels[index];
+        int levels = objectManager.renderStates[index].lodCount;
+        if (levels > 1) {
+            float size = projectedSize(objectManager.worldBounds[index], build->eye, projScale) * build->lodScale;
+            lod = selectLOD(size, lod, levels);
+        }
+        build->lodLevels[index] = (unsigned char)lod;
+
+        InstanceData* instance = &build->instances[index];
+        instance->model = objectManager.worldMatrices[index];
+        instance->normal = objectManager.normalMatrices[index];
+        instance->color = objectManager.colors[index];
+
+        Vector3 position = { instance->model.data[3][0], instance->model.data[3][1], instance->model.data[3][2] };
+        if (instance->color.w < 1.0f) {
+            build->queued[i] = FRAME_QUEUE_TRANSPARENT;
+            if (build->sortTransparent) build->distances[i] = vector_length(vector_sub(build->eye, position));
+        }
+        else {
+            build->queued[i] = FRAME_QUEUE_OPAQUE;
+            build->keys[i] = buildSortKey(build, index, position, lod);
+        }
+    }
+}
+
+static void pushTransparent(FrameBuild* build, int object, float distance) {
+    if (build->transparentCount == build->transparentCapacity) {
+        int capacity = build->transparentCapacity ? build->transparentCapacity * 2 : 64;
+        build->transparent = (TransparentDraw*)growBuffer(build->transparent, sizeof(TransparentDraw), capacity);
+        build->transparentCapacity = capacity;
+    }
+    build->transparent[build->transparentCount].object = object;
+    build->transparent[build->transparentCount].distance = distance;
+    build->transparentCount++;
+}
+
+static int compareTransparentDraws(const void* a, const void* b) {
+    float distanceA = ((const TransparentDraw*)a)->distance;
+    float distanceB = ((const TransparentDraw*)b)->distance;
+    return (distanceA < distanceB) - (distanceA > distanceB); // Sort descending
+}
+
+// Runs once after the last chunk: gathers the queues in candidate order and sorts
+// them, the transparent one only for the sorted fallback
+static void completeFrameBuild(void* context) {
+    FrameBuild* build = (FrameBuild*)context;
+    PROFILE_BEGIN("sort");
+    clearRenderQueue(&build->opaque);
+    build->transparentCount = 0;
+    int visible = 0;
+    for (int i = 0; i < build->candidateCount; i++) {
+        if (build->queued[i] == FRAME_QUEUE_NONE) continue;
+        int index = build->candidates[i];
+        objectManager.lodLevels[index] = build->lodLevels[index];
+        visible++;
+        if (build->queued[i] == FRAME_QUEUE_OPAQUE) {
+            pushDraw(&build->opaque, build->keys[i], index);
+        }
+        else {
+            pushTransparent(build, index, build->sortTransparent ? build->distances[i] : 0.0f);
+        }
+    }
+    sortRenderQueue(&build->opaque);
+    if (build->sortTransparent) {
+        qsort(build->transparent, build->transparentCount, sizeof(TransparentDraw), compareTransparentDraws);
+    }
+    build->cullStats.visible = visible;
+    PROFILE_END();
+}
+
+void startFrameBuild(FrameBuild* build) {
+    build->ready = false;
+    build->revision = objectManager.revision;
+    reserveFrameBuild(build, objectManager.capacity, objectManager.count);
+
+    // The tree walk is serial; everything per candidate is split across the workers
+    Matrix4x4 viewProj;
+    matrixMultiplyInto(&build->view, &build->projection, &viewProj);
+    Frustum frustum = extractFrustum(&viewProj);
+    build->candidateCount = 0;
+    querySpatialFrustum(&sceneTree, &frustum, collectCandidate, build);
+    build->bounds.count = build->candidateCount;
+    build->cullStats.tested = objectManager.count;
+
+    int chunks = (build->candidateCount + FRAME_BUILD_CHUNK - 1) / FRAME_BUILD_CHUNK;
+    startParallelFor(chunks, buildChunk, completeFrameBuild, build);
+}
+
+void finishFrameBuild(FrameBuild* build) {
+    waitForJobs();
+    build->ready = true;
+}
+
+bool isFrameBuildCurrent(const FrameBuild* build) {
+    return build->ready && build->revision == objectManager.revision;
+}
+
+void freeFrameBuild(FrameBuild* build) {
+    freeRenderQueue(&build->opaque);
+    freeBoundsSoA(&build->bounds);
+    free(build->transparent);
+    free(build->instances);
+    free(build->lodLevels);
+    free(build->candidates);
+    free(build->visible);
+    free(build->queued);
+    free(build->keys);
+    free(build->distances);
+    memset(build, 0, sizeof(*build));
+}
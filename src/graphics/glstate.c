@@ -0,0 +1,173 @@
+#include "glstate.h"
+#include <string.h>
+
+// Capabilities tracked by stateEnable/stateDisable
+typedef enum {
+    CAP_BLEND,
+    CAP_DEPTH_TEST,
+    CAP_CULL_FACE,
+    CAP_COUNT
+} TrackedCap;
+
+// Cached values are only trusted while their "known" flag is set
+typedef struct {
+    GLuint program;
+    bool programKnown;
+    GLuint vao;
+    bool vaoKnown;
+    GLuint activeUnit;
+    bool activeUnitKnown;
+    GLuint textures[STATE_MAX_TEXTURE_UNITS][3];  // [unit][2D, cube map, buffer]
+    bool texturesKnown[STATE_MAX_TEXTURE_UNITS][3];
+    bool caps[CAP_COUNT];
+    bool capsKnown[CAP_COUNT];
+    GLenum depthFunc;
+    bool depthFuncKnown;
+    GLboolean depthMask;
+    bool depthMaskKnown;
+    GLenum blendSrc;
+    GLenum blendDst;
+    bool blendFuncKnown;
+} GLStateCache;
+
+static GLStateCache cache;
+static GLStateStats currentStats;
+static GLStateStats lastFrameStats;
+
+// Anything that touches GL behind the cache's back (SOIL, ImGui, other contexts)
+// must be followed by this so the next request is forwarded unconditionally.
+void invalidateStateCache() {
+    memset(&cache, 0, sizeof(cache));
+}
+
+void beginStateFrame() {
+    lastFrameStats = currentStats;
+    memset(&currentStats, 0, sizeof(currentStats));
+    invalidateStateCache();
+}
+
+GLStateStats getStateStats() {
+    return lastFrameStats;
+}
+
+// Called next to every GL_TRIANGLES draw with its index or vertex count
+void stateCountDraw(GLsizei vertexCount, GLsizei instanceCount) {
+    currentStats.drawCalls++;
+    currentStats.triangles += (unsigned int)(vertexCount / 3) * (unsigned int)instanceCount;
+}
+
+static bool changed(bool known, bool same) {
+    if (known && same) {
+        currentStats.skipped++;
+        return false;
+    }
+    currentStats.issued++;
+    return true;
+}
+
+static int capIndex(GLenum cap) {
+    switch (cap) {
+    case GL_BLEND: return CAP_BLEND;
+    case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+    case GL_CULL_FACE: return CAP_CULL_FACE;
+    default: return -1;
+    }
+}
+
+static int targetIndex(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_CUBE_MAP: return 1;
+    case GL_TEXTURE_BUFFER: return 2;
+    default: return -1;
+    }
+}
+
+void stateUseProgram(GLuint program) {
+    if (changed(cache.programKnown, cache.program == program)) {
+        glUseProgram(program);
+        cache.program = program;
+        cache.programKnown = true;
+    }
+}
+
+void stateBindVertexArray(GLuint vao) {
+    if (changed(cache.vaoKnown, cache.vao == vao)) {
+        glBindVertexArray(vao);
+        cache.vao = vao;
+        cache.vaoKnown = true;
+    }
+}
+
+void stateBindTexture(GLuint unit, GLenum target, GLuint texture) {
+    int t = targetIndex(target);
+    if (unit >= STATE_MAX_TEXTURE_UNITS || t < 0) {
+        // Untracked binding: forward it and forget what we knew about the unit
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        cache.activeUnit = unit;
+        cache.activeUnitKnown = true;
+        currentStats.issued += 2;
+        return;
+    }
+
+    if (!changed(cache.texturesKnown[unit][t], cache.textures[unit][t] == texture)) {
+        return;
+    }
+    if (!cache.activeUnitKnown || cache.activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cache.activeUnit = unit;
+        cache.activeUnitKnown = true;
+        currentStats.issued++;
+    }
+    glBindTexture(target, texture);
+    cache.textures[unit][t] = texture;
+    cache.texturesKnown[unit][t] = true;
+}
+
+static void setCap(GLenum cap, bool enabled) {
+    int c = capIndex(cap);
+    if (c < 0) {
+        if (enabled) glEnable(cap); else glDisable(cap);
+        currentStats.issued++;
+        return;
+    }
+    if (changed(cache.capsKnown[c], cache.caps[c] == enabled)) {
+        if (enabled) glEnable(cap); else glDisable(cap);
+        cache.caps[c] = enabled;
+        cache.capsKnown[c] = true;
+    }
+}
+
+void stateEnable(GLenum cap) {
+    setCap(cap, true);
+}
+
+void stateDisable(GLenum cap) {
+    setCap(cap, false);
+}
+
+void stateDepthFunc(GLenum func) {
+    if (changed(cache.depthFuncKnown, cache.depthFunc == func)) {
+        glDepthFunc(func);
+        cache.depthFunc = func;
+        cache.depthFuncKnown = true;
+    }
+}
+
+void stateDepthMask(GLboolean flag) {
+    if (changed(cache.depthMaskKnown, cache.depthMask == flag)) {
+        glDepthMask(flag);
+        cache.depthMask = flag;
+        cache.depthMaskKnown = true;
+    }
+}
+
+void stateBlendFunc(GLenum sfactor, GLenum dfactor) {
+    if (changed(cache.blendFuncKnown, cache.blendSrc == sfactor && cache.blendDst == dfactor)) {
+        glBlendFunc(sfactor, dfactor);
+        cache.blendSrc = sfactor;
+        cache.blendDst = dfactor;
+        cache.blendFuncKnown = true;
+    }
+}
@@ -0,0 +1,140 @@
+#include "gputimers.h"
+#include <string.h>
+
+const char* gpuPassNames[GPU_PASS_COUNT] = {
+    "prepass",
+    "skybox",
+    "opaque",
+    "lighting",
+    "transparent",
+    "gui",
+};
+
+typedef struct {
+    GLuint queries[GPU_PASS_COUNT];
+    bool issued[GPU_PASS_COUNT];
+    bool pending;  // Holds issued queries that have not been read back
+} TimerFrame;
+
+static TimerFrame frames[GPU_TIMER_FRAMES];
+static int currentFrame = 0;
+static int activePass = -1;
+static bool initialized = false;
+
+static float history[GPU_TIMER_HISTORY][GPU_PASS_COUNT];
+static int historyNext = 0;
+static int historyCount = 0;
+static GpuTimerStats stats;
+
+void initGpuTimers() {
+    memset(frames, 0, sizeof(frames));
+    memset(history, 0, sizeof(history));
+    memset(&stats, 0, sizeof(stats));
+    for (int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        glGenQueries(GPU_PASS_COUNT, frames[i].queries);
+    }
+    currentFrame = 0;
+    activePass = -1;
+    historyNext = 0;
+    historyCount = 0;
+    initialized = true;
+}
+
+void cleanupGpuTimers() {
+    if (!initialized) return;
+    for (int i = 0; i < GPU_TIMER_FRAMES; i++) {
+        glDeleteQueries(GPU_PASS_COUNT, frames[i].queries);
+    }
+    memset(frames, 0, sizeof(frames));
+    initialized = false;
+}
+
+static void recordFrame(const float* passMs) {
+    memcpy(history[historyNext], passMs, sizeof(history[historyNext]));
+    historyNext = (historyNext + 1) % GPU_TIMER_HISTORY;
+    if (historyCount < GPU_TIMER_HISTORY) historyCount++;
+
+    stats.lastTotalMs = 0.0f;
+    stats.averageTotalMs = 0.0f;
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+        float sum = 0.0f;
+        for (int i = 0; i < historyCount; i++) {
+            sum += history[i][pass];
+        }
+        stats.lastMs[pass] = passMs[pass];
+        stats.averageMs[pass] = sum / historyCount;
+        stats.lastTotalMs += stats.lastMs[pass];
+        stats.averageTotalMs += stats.averageMs[pass];
+    }
+    stats.framesResolved++;
+    stats.available = true;
+}
+
+// False while any of the frame's queries is still in flight
+static bool resolveFrame(TimerFrame* frame) {
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+        if (!frame->issued[pass]) continue;
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(frame->queries[pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+    }
+
+    float passMs[GPU_PASS_COUNT];
+    for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+        GLuint64 elapsed = 0;
+        if (frame->issued[pass]) {
+            glGetQueryObjectui64v(frame->queries[pass], GL_QUERY_RESULT, &elapsed);
+        }
+        passMs[pass] = (float)((double)elapsed * 1e-6);
+    }
+    recordFrame(passMs);
+    frame->pending = false;
+    return true;
+}
+
+void collectGpuTimers() {
+    if (!initialized) return;
+    // Oldest first, stopping at the first unfinished frame so history stays in order
+    for (int i = 1; i <= GPU_TIMER_FRAMES; i++) {
+        TimerFrame* frame = &frames[(currentFrame + i) % GPU_TIMER_FRAMES];
+        if (frame->pending && !resolveFrame(frame)) break;
+    }
+}
+
+void beginGpuTimerFrame() {
+    if (!initialized) return;
+    if (activePass >= 0) endGpuPass();
+    collectGpuTimers();
+
+    currentFrame = (currentFrame + 1) % GPU_TIMER_FRAMES;
+    TimerFrame* frame = &frames[currentFrame];
+    // The GPU is more than a ring behind; reissuing discards the old results
+    if (frame->pending) {
+        stats.framesDropped++;
+    }
+    memset(frame->issued, 0, sizeof(frame->issued));
+    frame->pending = false;
+}
+
+void beginGpuPass(GpuPass pass) {
+    if (!initialized || pass < 0 || pass >= GPU_PASS_COUNT) return;
+    if (activePass >= 0) endGpuPass();
+
+    TimerFrame* frame = &frames[currentFrame];
+    // A pass run twice in one frame keeps only its first interval
+    if (frame->issued[pass]) return;
+    glBeginQuery(GL_TIME_ELAPSED, frame->queries[pass]);
+    frame->issued[pass] = true;
+    frame->pending = true;
+    activePass = pass;
+}
+
+void endGpuPass() {
+    if (activePass < 0) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    activePass = -1;
+}
+
+GpuTimerStats getGpuTimerStats() {
+    return stats;
+}
@@ -0,0 +1,188 @@
+#include "headless.h"
+#include "glstate.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef STELLAI_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+static bool headless = false;
+static GLuint framebuffer = 0;
+static GLuint colorBuffer = 0;
+static GLuint depthBuffer = 0;
+static int frameWidth = 0;
+static int frameHeight = 0;
+
+#ifdef STELLAI_HEADLESS_EGL
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLContext context = EGL_NO_CONTEXT;
+
+// Prefers Mesa's surfaceless platform, which needs neither X11, Wayland nor a DRM device
+static EGLDisplay openDisplay() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (surfaceless != EGL_NO_DISPLAY) return surfaceless;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static bool createContext() {
+    display = openDisplay();
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        fprintf(stderr, "Failed to initialize EGL (0x%x)\n", eglGetError());
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "EGL %d.%d does not provide desktop OpenGL\n", major, minor);
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        fprintf(stderr, "No EGL config supports OpenGL\n");
+        return false;
+    }
+
+    // Same version and profile the windowed path asks GLFW for
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 4,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        fprintf(stderr, "Failed to create an OpenGL 4.4 core context (0x%x)\n", eglGetError());
+        return false;
+    }
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        fprintf(stderr, "EGL cannot make a context current without a surface (0x%x)\n", eglGetError());
+        return false;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        fprintf(stderr, "Failed to initialize GLAD\n");
+        return false;
+    }
+    return true;
+}
+
+static void destroyContext() {
+    if (display == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT) {
+        eglDestroyContext(display, context);
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+}
+#else
+static bool createContext() {
+    fprintf(stderr, "Headless rendering needs a build with STELLAI_HEADLESS_EGL\n");
+    return false;
+}
+
+static void destroyContext() {
+}
+#endif
+
+bool initHeadlessContext(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "Invalid headless frame size %dx%d\n", width, height);
+        return false;
+    }
+    if (!createContext()) {
+        destroyContext();
+        return false;
+    }
+
+    // Stands in for the window's default framebuffer, with the same depth format
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "Headless framebuffer incomplete (0x%x)\n", status);
+        destroyHeadlessContext();
+        return false;
+    }
+
+    // Left bound; every pass that switches away binds getDefaultFramebuffer() again
+    glViewport(0, 0, width, height);
+    frameWidth = width;
+    frameHeight = height;
+    headless = true;
+    return true;
+}
+
+void destroyHeadlessContext() {
+    if (framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
+    framebuffer = colorBuffer = depthBuffer = 0;
+    frameWidth = frameHeight = 0;
+    headless = false;
+    invalidateStateCache();
+    destroyContext();
+}
+
+bool isHeadless() {
+    return headless;
+}
+
+GLuint getDefaultFramebuffer() {
+    return framebuffer;
+}
+
+bool saveHeadlessFrame(const char* path) {
+    if (!headless) return false;
+
+    unsigned char* pixels = (unsigned char*)malloc((size_t)frameWidth * frameHeight * 3);
+    if (!pixels) {
+        fprintf(stderr, "Failed to allocate %dx%d frame readback\n", frameWidth, frameHeight);
+        return false;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, frameWidth, frameHeight, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Could not open %s for writing\n", path);
+        free(pixels);
+        return false;
+    }
+    // GL rows start at the bottom, PPM rows at the top
+    fprintf(file, "P6\n%d %d\n255\n", frameWidth, frameHeight);
+    size_t rowSize = (size_t)frameWidth * 3;
+    for (int y = frameHeight - 1; y >= 0; y--) {
+        fwrite(pixels + y * rowSize, 1, rowSize, file);
+    }
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    free(pixels);
+    return ok;
+}
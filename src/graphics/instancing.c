@@ -0,0 +1,173 @@
+#include "instancing.h"
+#include "geometry.h"
+#include "Camera.h"
+#include "shaders.h"
+#include "glstate.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define INSTANCE_ATTRIB_MODEL 3
+#define INSTANCE_ATTRIB_COLOR 7
+#define INSTANCE_ATTRIB_NORMAL 8
+
+extern ShaderProgram shaderProgram;
+
+// The registry mesh each primitive type is instanced from, with the per-instance
+// attributes attached to its vertex array
+typedef struct {
+    int geometry;
+    GLuint vao;
+    LODChain lods;
+    bool created;
+} InstanceMesh;
+
+static InstanceMesh instanceMeshes[OBJ_MODEL];
+static GLuint instanceVBO = 0;
+
+// CPU staging for the batch being built
+static InstanceData* batch = NULL;
+static int batchCount = 0;
+static int batchCapacity = 0;
+static ObjectType batchType = OBJ_CUBE;
+static int batchLOD = 0;
+
+static void attachInstanceAttributes(GLuint vao) {
+    stateBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (int column = 0; column < 4; column++) {
+        GLuint location = INSTANCE_ATTRIB_MODEL + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(offsetof(InstanceData, model) + column * 4 * sizeof(float)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glEnableVertexAttribArray(INSTANCE_ATTRIB_COLOR);
+    glVertexAttribPointer(INSTANCE_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, color));
+    glVertexAttribDivisor(INSTANCE_ATTRIB_COLOR, 1);
+    for (int column = 0; column < 3; column++) {
+        GLuint location = INSTANCE_ATTRIB_NORMAL + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*)(offsetof(InstanceData, normal) + column * 3 * sizeof(float)));
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    stateBindVertexArray(0);
+}
+
+static InstanceMesh* getInstanceMesh(ObjectType type) {
+    if (type < OBJ_CUBE || type >= OBJ_MODEL) return NULL;
+
+    InstanceMesh* mesh = &instanceMeshes[type];
+    if (mesh->created) return mesh;
+
+    if (instanceVBO == 0) {
+        // Seed one instance so non-instanced draws through the same VAO read valid data
+        InstanceData seed = { identityMatrix(), { 1.0f, 1.0f, 1.0f, 1.0f }, { { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } } } };
+        glGenBuffers(1, &instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData), &seed, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // Same parameters as addObject, so instances and scene objects share one mesh
+    mesh->geometry = acquirePrimitiveGeometry(defaultPrimitiveParams(type));
+    const GeometryEntry* entry = getGeometry(mesh->geometry);
+    if (!entry) return NULL;
+
+    switch (type) {
+    case OBJ_CUBE:
+        mesh->vao = entry->data.cube.vao;
+        mesh->lods = makeSingleLODChain(36);
+        break;
+    case OBJ_SPHERE:
+        mesh->vao = entry->data.sphere.vao;
+        mesh->lods = entry->data.sphere.lods;
+        break;
+    case OBJ_PYRAMID:
+        mesh->vao = entry->data.pyramid.vao;
+        mesh->lods = makeSingleLODChain(18);
+        break;
+    case OBJ_CYLINDER:
+        mesh->vao = entry->data.cylinder.vao;
+        mesh->lods = entry->data.cylinder.lods;
+        break;
+    case OBJ_PLANE:
+        mesh->vao = entry->data.plane.vao;
+        mesh->lods = makeSingleLODChain(6);
+        break;
+    default:
+        return NULL;
+    }
+
+    attachInstanceAttributes(mesh->vao);
+    mesh->created = true;
+    return mesh;
+}
+
+void beginInstanceBatch(ObjectType type, int lod) {
+    batchType = type;
+    batchLOD = lod;
+    batchCount = 0;
+}
+
+void addInstance(const Matrix4x4* model, const Matrix3x3* normal, Vector4 color) {
+    if (batchCount == batchCapacity) {
+        int newCapacity = batchCapacity ? batchCapacity * 2 : 256;
+        InstanceData* grown = (InstanceData*)realloc(batch, newCapacity * sizeof(InstanceData));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow instance batch.\n");
+            return;
+        }
+        batch = grown;
+        batchCapacity = newCapacity;
+    }
+    batch[batchCount].model = *model;
+    batch[batchCount].color = color;
+    batch[batchCount].normal = *normal;
+    batchCount++;
+}
+
+// Upload the batch and draw every instance with a single call
+void flushInstanceBatch() {
+    InstanceMesh* mesh = getInstanceMesh(batchType);
+    if (!mesh || batchCount == 0) {
+        batchCount = 0;
+        return;
+    }
+
+    // Orphan the previous contents so the driver does not stall on in-flight draws
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, batchCount * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, batchCount * sizeof(InstanceData), batch);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    int lod = batchLOD < mesh->lods.count ? batchLOD : mesh->lods.count - 1;
+    const LODLevel* level = &mesh->lods.levels[lod];
+    glUniform1i(shaderProgram.slots[UNIFORM_USE_INSTANCING], 1);
+    stateBindVertexArray(mesh->vao);
+    glDrawElementsInstanced(GL_TRIANGLES, level->indexCount, GL_UNSIGNED_INT,
+        (void*)(level->indexOffset * sizeof(unsigned int)), batchCount);
+    stateCountDraw(level->indexCount, batchCount);
+    glUniform1i(shaderProgram.slots[UNIFORM_USE_INSTANCING], 0);
+
+    batchCount = 0;
+}
+
+void cleanupInstancing() {
+    for (int i = 0; i < OBJ_MODEL; i++) {
+        InstanceMesh* mesh = &instanceMeshes[i];
+        if (!mesh->created) continue;
+        releaseGeometry(mesh->geometry);
+        mesh->created = false;
+    }
+    if (instanceVBO) {
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+    }
+    free(batch);
+    batch = NULL;
+    batchCount = 0;
+    batchCapacity = 0;
+}
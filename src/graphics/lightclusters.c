@@ -0,0 +1,399 @@
+#include "lightclusters.h"
+#include "lightshading.h"
+#include "uniformbuffers.h"
+#include "matrix.h"
+#include "bounds.h"
+#include "glstate.h"
+#include "jobs.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLUSTERS_PER_SLICE (CLUSTER_TILES_X * CLUSTER_TILES_Y)
+#define LIGHT_TEXELS 4  // RGBA32F texels per light in the light buffer
+
+// Which clusters a light can touch, from its view-space bounding sphere
+typedef struct {
+    Vector3 center;
+    float radius;     // Negative for lights that reach everything
+    int tileMinX, tileMaxX;
+    int tileMinY, tileMaxY;
+    int sliceMin, sliceMax;
+    bool visible;
+} ClusterLight;
+
+// Lists for one depth slice, built by one job and merged afterwards
+typedef struct {
+    unsigned int* indices;
+    int count;
+    int capacity;
+    unsigned int offsets[CLUSTERS_PER_SLICE];  // Into indices
+    unsigned int counts[CLUSTERS_PER_SLICE];
+} ClusterSlice;
+
+typedef struct {
+    Matrix4x4 view;
+    Matrix4x4 projection;
+    float nearPlane;
+    float farPlane;
+    int width;
+    int height;
+} ClusterView;
+
+static GLuint lightBuffer, gridBuffer, indexBuffer;
+static GLuint lightTexture, gridTexture, indexTexture;
+static GLsizeiptr indexBufferSize = 0;
+
+static float packedLights[MAX_LIGHTS * LIGHT_TEXELS * 4];
+static int packedLightCount = -1;
+static ClusterLight clusterLights[MAX_LIGHTS];
+static Vector3 lightPositions[MAX_LIGHTS];
+
+static AABB clusterBounds[CLUSTER_COUNT];  // View space, rebuilt when the projection changes
+static ClusterSlice slices[CLUSTER_SLICES];
+static unsigned int grid[CLUSTER_COUNT * 2];  // (offset, count) per cluster
+static unsigned int* indices = NULL;
+static int indexCapacity = 0;
+
+static ClusterView lastView;
+static bool haveLastView = false;
+static bool boundsValid = false;
+static LightClusterStats stats;
+
+static GLuint createBufferTexture(GLuint* buffer, GLsizeiptr size, GLenum format) {
+    GLuint texture;
+    glGenBuffers(1, buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+    glBufferData(GL_TEXTURE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    invalidateStateCache();
+    return texture;
+}
+
+void initLightClusters() {
+    lightTexture = createBufferTexture(&lightBuffer, sizeof(packedLights), GL_RGBA32F);
+    gridTexture = createBufferTexture(&gridBuffer, sizeof(grid), GL_RG32UI);
+    indexBufferSize = 1024 * sizeof(unsigned int);
+    indexTexture = createBufferTexture(&indexBuffer, indexBufferSize, GL_R32UI);
+    packedLightCount = -1;
+    haveLastView = false;
+    boundsValid = false;
+}
+
+void cleanupLightClusters() {
+    GLuint textures[3] = { lightTexture, gridTexture, indexTexture };
+    GLuint buffers[3] = { lightBuffer, gridBuffer, indexBuffer };
+    glDeleteTextures(3, textures);
+    glDeleteBuffers(3, buffers);
+    lightTexture = gridTexture = indexTexture = 0;
+    lightBuffer = gridBuffer = indexBuffer = 0;
+    indexBufferSize = 0;
+
+    for (int i = 0; i < CLUSTER_SLICES; i++) {
+        free(slices[i].indices);
+        slices[i].indices = NULL;
+        slices[i].capacity = 0;
+    }
+    free(indices);
+    indices = NULL;
+    indexCapacity = 0;
+}
+
+// Slice boundaries are spaced so every slice covers the same depth ratio
+static float sliceDepth(const ClusterView* v, int slice) {
+    return v->nearPlane * powf(v->farPlane / v->nearPlane, (float)slice / CLUSTER_SLICES);
+}
+
+static int depthSlice(const ClusterView* v, float depth) {
+    int slice = (int)(logf(depth / v->nearPlane) / logf(v->farPlane / v->nearPlane) * CLUSTER_SLICES);
+    return slice < 0 ? 0 : (slice >= CLUSTER_SLICES ? CLUSTER_SLICES - 1 : slice);
+}
+
+static int tileSize(int pixels, int tiles) {
+    int size = (pixels + tiles - 1) / tiles;
+    return size > 0 ? size : 1;
+}
+
+static int clampTile(int tile, int tiles) {
+    return tile < 0 ? 0 : (tile >= tiles ? tiles - 1 : tile);
+}
+
+// Pixel edge of a tile as an NDC coordinate
+static float tileEdgeNDC(int tile, int size, int pixels) {
+    return 2.0f * (float)(tile * size) / (float)pixels - 1.0f;
+}
+
+static void buildClusterBounds(const ClusterView* v) {
+    float scaleX = v->projection.data[0][0];
+    float scaleY = v->projection.data[1][1];
+    int sizeX = tileSize(v->width, CLUSTER_TILES_X);
+    int sizeY = tileSize(v->height, CLUSTER_TILES_Y);
+
+    for (int slice = 0; slice < CLUSTER_SLICES; slice++) {
+        float depths[2] = { sliceDepth(v, slice), sliceDepth(v, slice + 1) };
+        for (int y = 0; y < CLUSTER_TILES_Y; y++) {
+            float ndcY[2] = { tileEdgeNDC(y, sizeY, v->height), tileEdgeNDC(y + 1, sizeY, v->height) };
+            for (int x = 0; x < CLUSTER_TILES_X; x++) {
+                float ndcX[2] = { tileEdgeNDC(x, sizeX, v->width), tileEdgeNDC(x + 1, sizeX, v->width) };
+                AABB box = makeAABB(vector(0.0f, 0.0f, -depths[1]), vector(0.0f, 0.0f, -depths[0]));
+                box.min.x = box.min.y = INFINITY;
+                box.max.x = box.max.y = -INFINITY;
+                // The tile is a frustum slab, so its corners at either depth bound it
+                for (int d = 0; d < 2; d++) {
+                    for (int e = 0; e < 2; e++) {
+                        float cornerX = ndcX[e] * depths[d] / scaleX;
+                        float cornerY = ndcY[e] * depths[d] / scaleY;
+                        box.min.x = fminf(box.min.x, cornerX);
+                        box.max.x = fmaxf(box.max.x, cornerX);
+                        box.min.y = fminf(box.min.y, cornerY);
+                        box.max.y = fmaxf(box.max.y, cornerY);
+                    }
+                }
+                clusterBounds[(slice * CLUSTER_TILES_Y + y) * CLUSTER_TILES_X + x] = box;
+            }
+        }
+    }
+}
+
+// Conservative tile and slice range of a view-space sphere
+static void boundLight(const ClusterView* v, ClusterLight* light) {
+    if (light->radius < 0.0f) {
+        light->tileMinX = light->tileMinY = light->sliceMin = 0;
+        light->tileMaxX = CLUSTER_TILES_X - 1;
+        light->tileMaxY = CLUSTER_TILES_Y - 1;
+        light->sliceMax = CLUSTER_SLICES - 1;
+        light->visible = true;
+        return;
+    }
+
+    float nearest = -light->center.z - light->radius;
+    float farthest = -light->center.z + light->radius;
+    light->visible = farthest > v->nearPlane && nearest < v->farPlane;
+    if (!light->visible) return;
+
+    float depths[2] = { fmaxf(nearest, v->nearPlane), fminf(farthest, v->farPlane) };
+    light->sliceMin = depthSlice(v, depths[0]);
+    light->sliceMax = depthSlice(v, depths[1]);
+
+    // x / depth is monotonic in depth, so the extremes sit at the depth range ends
+    float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+    for (int d = 0; d < 2; d++) {
+        for (int s = -1; s <= 1; s += 2) {
+            float x = v->projection.data[0][0] * (light->center.x + s * light->radius) / depths[d];
+            float y = v->projection.data[1][1] * (light->center.y + s * light->radius) / depths[d];
+            minX = fminf(minX, x);
+            maxX = fmaxf(maxX, x);
+            minY = fminf(minY, y);
+            maxY = fmaxf(maxY, y);
+        }
+    }
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) {
+        light->visible = false;
+        return;
+    }
+
+    int sizeX = tileSize(v->width, CLUSTER_TILES_X);
+    int sizeY = tileSize(v->height, CLUSTER_TILES_Y);
+    light->tileMinX = clampTile((int)floorf((minX + 1.0f) * 0.5f * v->width / sizeX), CLUSTER_TILES_X);
+    light->tileMaxX = clampTile((int)floorf((maxX + 1.0f) * 0.5f * v->width / sizeX), CLUSTER_TILES_X);
+    light->tileMinY = clampTile((int)floorf((minY + 1.0f) * 0.5f * v->height / sizeY), CLUSTER_TILES_Y);
+    light->tileMaxY = clampTile((int)floorf((maxY + 1.0f) * 0.5f * v->height / sizeY), CLUSTER_TILES_Y);
+}
+
+static bool sphereTouchesBox(Vector3 center, float radius, const AABB* box) {
+    if (radius < 0.0f) return true;
+    float dx = fmaxf(fmaxf(box->min.x - center.x, 0.0f), center.x - box->max.x);
+    float dy = fmaxf(fmaxf(box->min.y - center.y, 0.0f), center.y - box->max.y);
+    float dz = fmaxf(fmaxf(box->min.z - center.z, 0.0f), center.z - box->max.z);
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+// Walks the lights overlapping this slice; with fill false it only counts hits
+static void visitSlice(int slice, ClusterSlice* out, bool fill) {
+    const AABB* bounds = &clusterBounds[slice * CLUSTERS_PER_SLICE];
+    for (int l = 0; l < lightCount; l++) {
+        const ClusterLight* light = &clusterLights[l];
+        if (!light->visible || slice < light->sliceMin || slice > light->sliceMax) continue;
+        for (int y = light->tileMinY; y <= light->tileMaxY; y++) {
+            for (int x = light->tileMinX; x <= light->tileMaxX; x++) {
+                int local = y * CLUSTER_TILES_X + x;
+                if (!sphereTouchesBox(light->center, light->radius, &bounds[local])) continue;
+                if (fill) {
+                    out->indices[out->offsets[local] + out->counts[local]] = (unsigned int)l;
+                }
+                out->counts[local]++;
+            }
+        }
+    }
+}
+
+static void buildSlice(int slice, void* context) {
+    (void)context;
+    ClusterSlice* out = &slices[slice];
+    memset(out->counts, 0, sizeof(out->counts));
+    visitSlice(slice, out, false);
+
+    unsigned int total = 0;
+    for (int i = 0; i < CLUSTERS_PER_SLICE; i++) {
+        out->offsets[i] = total;
+        total += out->counts[i];
+    }
+    if ((int)total > out->capacity) {
+        int capacity = out->capacity ? out->capacity : 256;
+        while (capacity < (int)total) capacity *= 2;
+        unsigned int* grown = (unsigned int*)realloc(out->indices, capacity * sizeof(unsigned int));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow light cluster lists.\n");
+            exit(EXIT_FAILURE);
+        }
+        out->indices = grown;
+        out->capacity = capacity;
+    }
+    out->count = (int)total;
+
+    memset(out->counts, 0, sizeof(out->counts));
+    visitSlice(slice, out, true);
+}
+
+// Light buffer layout, LIGHT_TEXELS texels per light:
+//   position.xyz, range (< 0: unbounded) | direction.xyz, type | color.rgb, intensity | cutOff, outerCutOff
+static bool packLights() {
+    float packed[MAX_LIGHTS * LIGHT_TEXELS * 4];
+    for (int i = 0; i < lightCount; i++) {
+        const Light* light = &lights[i];
+        float* p = &packed[i * LIGHT_TEXELS * 4];
+        float range = light->type == LIGHT_DIRECTIONAL ? -1.0f : lightRange(light);
+        float values[LIGHT_TEXELS * 4] = {
+            light->position.x, light->position.y, light->position.z, range,
+            light->direction.x, light->direction.y, light->direction.z, (float)light->type,
+            light->color.x, light->color.y, light->color.z, light->intensity,
+            light->cutOff, light->outerCutOff, 0.0f, 0.0f
+        };
+        memcpy(p, values, sizeof(values));
+        lightPositions[i] = light->position;
+    }
+
+    size_t size = (size_t)lightCount * LIGHT_TEXELS * 4 * sizeof(float);
+    if (packedLightCount == lightCount && memcmp(packedLights, packed, size) == 0) {
+        return false;
+    }
+    memcpy(packedLights, packed, size);
+    packedLightCount = lightCount;
+    if (size > 0) {
+        glBindBuffer(GL_TEXTURE_BUFFER, lightBuffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, (GLsizeiptr)size, packedLights);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+    return true;
+}
+
+static void uploadClusters(int total) {
+    glBindBuffer(GL_TEXTURE_BUFFER, gridBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(grid), grid);
+
+    GLsizeiptr size = (GLsizeiptr)total * sizeof(unsigned int);
+    glBindBuffer(GL_TEXTURE_BUFFER, indexBuffer);
+    if (size > indexBufferSize) {
+        while (indexBufferSize < size) indexBufferSize *= 2;
+        glBufferData(GL_TEXTURE_BUFFER, indexBufferSize, NULL, GL_DYNAMIC_DRAW);
+    }
+    if (size > 0) {
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, indices);
+    }
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void updateLightClusters(const Matrix4x4* view, const Matrix4x4* projection, float nearPlane, float farPlane, int width, int height) {
+    ClusterView current = { *view, *projection, nearPlane, farPlane, width > 0 ? width : 1, height > 0 ? height : 1 };
+
+    LightGridUniforms uniforms = { 0 };
+    uniforms.clusterDims[0] = CLUSTER_TILES_X;
+    uniforms.clusterDims[1] = CLUSTER_TILES_Y;
+    uniforms.clusterDims[2] = CLUSTER_SLICES;
+    uniforms.clusterDims[3] = lightCount;
+    float logRatio = logf(farPlane / nearPlane);
+    uniforms.clusterDepth[0] = CLUSTER_SLICES / logRatio;
+    uniforms.clusterDepth[1] = CLUSTER_SLICES * logf(nearPlane) / logRatio;
+    uniforms.clusterDepth[2] = nearPlane;
+    uniforms.clusterDepth[3] = farPlane;
+    uniforms.tileSize[0] = (float)tileSize(current.width, CLUSTER_TILES_X);
+    uniforms.tileSize[1] = (float)tileSize(current.height, CLUSTER_TILES_Y);
+    updateLightUniforms(&uniforms);
+
+    bool lightsChanged = packLights();
+    bool projectionChanged = !haveLastView || memcmp(&lastView.projection, &current.projection, sizeof(Matrix4x4)) != 0
+        || lastView.nearPlane != nearPlane || lastView.farPlane != farPlane
+        || lastView.width != current.width || lastView.height != current.height;
+    bool viewChanged = !haveLastView || memcmp(&lastView.view, &current.view, sizeof(Matrix4x4)) != 0;
+    stats.lights = lightCount;
+    stats.rebuilt = lightsChanged || projectionChanged || viewChanged;
+    if (!stats.rebuilt) return;
+
+    if (projectionChanged || !boundsValid) {
+        buildClusterBounds(&current);
+        boundsValid = true;
+    }
+    lastView = current;
+    haveLastView = true;
+
+    // Light spheres in view space, then their tile and slice ranges
+    Vector3 viewPositions[MAX_LIGHTS];
+    transformPoints(view, lightPositions, viewPositions, lightCount);
+    for (int i = 0; i < lightCount; i++) {
+        clusterLights[i].center = viewPositions[i];
+        clusterLights[i].radius = packedLights[i * LIGHT_TEXELS * 4 + 3];
+        boundLight(&current, &clusterLights[i]);
+    }
+
+    // Slices are independent, so each job fills its own lists
+    parallelFor(CLUSTER_SLICES, buildSlice, NULL);
+
+    int total = 0;
+    for (int s = 0; s < CLUSTER_SLICES; s++) {
+        total += slices[s].count;
+    }
+    if (total > indexCapacity) {
+        int capacity = indexCapacity ? indexCapacity : 1024;
+        while (capacity < total) capacity *= 2;
+        unsigned int* grown = (unsigned int*)realloc(indices, capacity * sizeof(unsigned int));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow light cluster indices.\n");
+            exit(EXIT_FAILURE);
+        }
+        indices = grown;
+        indexCapacity = capacity;
+    }
+
+    int base = 0;
+    stats.maxPerCluster = 0;
+    for (int s = 0; s < CLUSTER_SLICES; s++) {
+        const ClusterSlice* slice = &slices[s];
+        if (slice->count > 0) {
+            memcpy(indices + base, slice->indices, slice->count * sizeof(unsigned int));
+        }
+        for (int i = 0; i < CLUSTERS_PER_SLICE; i++) {
+            unsigned int* cell = &grid[(s * CLUSTERS_PER_SLICE + i) * 2];
+            cell[0] = base + slice->offsets[i];
+            cell[1] = slice->counts[i];
+            if ((int)cell[1] > stats.maxPerCluster) stats.maxPerCluster = (int)cell[1];
+        }
+        base += slice->count;
+    }
+    stats.indices = total;
+    uploadClusters(total);
+}
+
+void bindLightClusters() {
+    stateBindTexture(CLUSTER_UNIT_LIGHTS, GL_TEXTURE_BUFFER, lightTexture);
+    stateBindTexture(CLUSTER_UNIT_GRID, GL_TEXTURE_BUFFER, gridTexture);
+    stateBindTexture(CLUSTER_UNIT_INDICES, GL_TEXTURE_BUFFER, indexTexture);
+}
+
+LightClusterStats getLightClusterStats() {
+    return stats;
+}
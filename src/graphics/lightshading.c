@@ -6,8 +6,7 @@
 #include <stdio.h>
 
 #define PI 3.14159265358979323846
-#define DEG_TO_RAD(degrees) ((degrees) * (PI / 180.0))
-extern unsigned int shaderProgram;
+#define DEG_TO_RAD(degrees) ((degrees) * ((float)PI / 180.0f))
 Light lights[MAX_LIGHTS];
 int lightCount = 0;
 
@@ -15,32 +14,13 @@ float clamp(float x, float lower, float upper) {
     return fmax(lower, fmin(x, upper));
 }
 
-void updateShaderLights() {
-    char uniformBuffer[128];
-    GLint lightCountLoc = glGetUniformLocation(shaderProgram, "lightCount");
-    glUniform1i(lightCountLoc, lightCount);
-
-    for (int i = 0; i < lightCount; i++) {
-        sprintf(uniformBuffer, "lights[%d].position", i);
-        glUniform3fv(glGetUniformLocation(shaderProgram, uniformBuffer), 1, (const GLfloat*)&lights[i].position);
-
-        sprintf(uniformBuffer, "lights[%d].color", i);
-        glUniform3fv(glGetUniformLocation(shaderProgram, uniformBuffer), 1, (const GLfloat*)&lights[i].color);
-
-        sprintf(uniformBuffer, "lights[%d].intensity", i);
-        glUniform1f(glGetUniformLocation(shaderProgram, uniformBuffer), lights[i].intensity);
-
-        if (lights[i].type == LIGHT_DIRECTIONAL) {
-            sprintf(uniformBuffer, "lights[%d].direction", i);
-            glUniform3fv(glGetUniformLocation(shaderProgram, uniformBuffer), 1, (const GLfloat*)&lights[i].direction);
-        }
-        else if (lights[i].type == LIGHT_SPOT) {
-            sprintf(uniformBuffer, "lights[%d].cutOff", i);
-            glUniform1f(glGetUniformLocation(shaderProgram, uniformBuffer), lights[i].cutOff);
-            sprintf(uniformBuffer, "lights[%d].outerCutOff", i);
-            glUniform1f(glGetUniformLocation(shaderProgram, uniformBuffer), lights[i].outerCutOff);
-        }
-    }
+// Distance where the shader's 1 / (1 + d^2) falloff, scaled by the brightest
+// channel, drops to LIGHT_CUTOFF. The shader fades lights out to zero there.
+// The shader does not scale by intensity, so intensity only widens the range.
+float lightRange(const Light* light) {
+    float peak = fmaxf(light->color.x, fmaxf(light->color.y, light->color.z)) * light->intensity;
+    float ratio = peak / LIGHT_CUTOFF - 1.0f;
+    return ratio > 0.0f ? sqrtf(ratio) : 0.0f;
 }
 
 void initLightingSystem() {
@@ -54,7 +34,7 @@ void createLight(Vector3 position, Vector3 direction, Vector3 color, float inten
         return;
     }
 
-    Light newLight;
+    Light newLight = { 0 };
     newLight.type = type;
     newLight.position = position;
     newLight.direction = vector_normalize(direction);
@@ -67,8 +47,8 @@ void createLight(Vector3 position, Vector3 direction, Vector3 color, float inten
         newLight.quadratic = 0.032f;
     }
     else if (type == LIGHT_SPOT) {
-        newLight.cutOff = cos(DEG_TO_RAD(12.5f));
-        newLight.outerCutOff = cos(DEG_TO_RAD(15.0f));
+        newLight.cutOff = cosf(DEG_TO_RAD(12.5f));
+        newLight.outerCutOff = cosf(DEG_TO_RAD(15.0f));
     }
 
     lights[lightCount++] = newLight;
@@ -1,5 +1,6 @@
 #include "materials.h"
 #include "textures.h"  
+#include "glstate.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -33,16 +34,11 @@ PBRMaterial loadPBRMaterial(const char* albedo, const char* normal, const char*
 }
 
 void bindPBRMaterial(PBRMaterial material) {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, material.albedoMap);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, material.normalMap);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, material.metallicMap);
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, material.roughnessMap);
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, material.aoMap);
+    stateBindTexture(0, GL_TEXTURE_2D, material.albedoMap);
+    stateBindTexture(1, GL_TEXTURE_2D, material.normalMap);
+    stateBindTexture(2, GL_TEXTURE_2D, material.metallicMap);
+    stateBindTexture(3, GL_TEXTURE_2D, material.roughnessMap);
+    stateBindTexture(4, GL_TEXTURE_2D, material.aoMap);
 }
 
 void cleanupPBRMaterial(PBRMaterial* material) {
@@ -121,3 +117,14 @@ PBRMaterial* getMaterial(const char* name) {
     return NULL; 
 }
 
+// Index of a material in the registry, or -1 for materials that were never added
+int getMaterialIndex(PBRMaterial material) {
+    for (int i = 0; i < materialCount; i++) {
+        if (materials[i].albedoMap == material.albedoMap && materials[i].normalMap == material.normalMap &&
+            materials[i].metallicMap == material.metallicMap && materials[i].roughnessMap == material.roughnessMap &&
+            materials[i].aoMap == material.aoMap) {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,83 @@
+#include "oit.h"
+#include "glstate.h"
+#include "headless.h"
+#include "rendertarget.h"
+#include "scenetarget.h"
+#include "shaders.h"
+#include <stdio.h>
+
+static RenderTarget target;
+static GLuint accumTexture = 0;      // RGBA16F, sum of weighted premultiplied color
+static GLuint revealageTexture = 0;  // R8, product of (1 - alpha)
+static ShaderProgram compositeProgram;
+
+bool initOIT() {
+    compositeProgram = loadShader("shaders/oit/compositeVertex.glsl", "shaders/oit/compositeFragment.glsl");
+    if (compositeProgram.id == 0) {
+        fprintf(stderr, "Failed to load OIT composite shader\n");
+        return false;
+    }
+
+    createRenderTarget(&target, "OIT");
+    accumTexture = addTargetTexture(&target, GL_COLOR_ATTACHMENT0, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    revealageTexture = addTargetTexture(&target, GL_COLOR_ATTACHMENT1, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    // Copy of the opaque depth for testing only; blitted over in beginOITPass
+    addTargetDepthBuffer(&target);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    invalidateStateCache();
+    return true;
+}
+
+void cleanupOIT() {
+    deleteRenderTarget(&target);
+    deleteShader(&compositeProgram);
+    accumTexture = revealageTexture = 0;
+}
+
+bool beginOITPass(int width, int height) {
+    if (!target.framebuffer || width <= 0 || height <= 0 || !resizeRenderTarget(&target, width, height)) {
+        return false;
+    }
+
+    // Translucent fragments behind opaque geometry are rejected by the copied depth
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, getSceneFramebuffer());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+
+    static const GLfloat accumClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    static const GLfloat revealageClear[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glClearBufferfv(GL_COLOR, 0, accumClear);
+    glClearBufferfv(GL_COLOR, 1, revealageClear);
+
+    // Depth is tested but not written, so draw order does not matter
+    stateEnable(GL_DEPTH_TEST);
+    stateDepthFunc(GL_LESS);
+    stateDepthMask(GL_FALSE);
+    stateEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+    return true;
+}
+
+void endOITPass() {
+    glBindFramebuffer(GL_FRAMEBUFFER, getSceneFramebuffer());
+    // glBlendFunci bypassed the cached blend function
+    invalidateStateCache();
+
+    // result = average color * (1 - revealage) + destination * revealage
+    stateBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+    stateDisable(GL_DEPTH_TEST);
+    stateUseProgram(compositeProgram.id);
+    stateBindTexture(OIT_UNIT_ACCUM, GL_TEXTURE_2D, accumTexture);
+    stateBindTexture(OIT_UNIT_REVEALAGE, GL_TEXTURE_2D, revealageTexture);
+    drawFullscreenTriangle();
+
+    stateEnable(GL_DEPTH_TEST);
+    stateDepthMask(GL_TRUE);
+    stateDisable(GL_BLEND);
+}
@@ -9,6 +9,25 @@
 #include "globals.h"
 #include "materials.h"
 #include "gui.h"
+#include "glstate.h"
+#include "renderqueue.h"
+#include "instancing.h"
+#include "geometry.h"
+#include "culling.h"
+#include "framebuild.h"
+#include "uniformbuffers.h"
+#include "lightclusters.h"
+#include "jobs.h"
+#include "oit.h"
+#include "deferred.h"
+#include "scenetarget.h"
+#include "rendertarget.h"
+#include "governor.h"
+#include "lod.h"
+#include "headless.h"
+#include "gputimers.h"
+#include "profiler.h"
+#include <string.h>
 
 // Function prototypes
 static Model* model = NULL;
@@ -17,6 +36,24 @@ static Model* model = NULL;
 static float deltaTime = 0.0f;
 static float lastFrame = 0.0f;
 
+#define NEAR_PLANE 0.1f
+#define FAR_PLANE 100.0f
+
+// Two builds alternate: with pipelining, one is drawn while the workers fill
+// the other from the current scene, so the image trails the scene by a frame
+static FrameBuild frameBuilds[2];
+static int nextBuild = 0;
+static bool oitAvailable = false;
+static bool deferredAvailable = false;
+
+// Object vertex shader with an empty fragment shader, for the depth pre-pass
+static ShaderProgram depthProgram;
+static CullStats cullStats;
+
+CullStats getCullStats() {
+    return cullStats;
+}
+
 void loadResources(int stage, float* progress) {
     switch (stage) {
     case 0:  // Initialization
@@ -43,6 +80,47 @@ void loadResources(int stage, float* progress) {
     }
 }
 
+// Everything after context creation, shared by the windowed and headless paths
+static void initRenderer() {
+    initUniformBuffers();
+    initLightClusters();
+    initJobSystem(0);
+    initGpuTimers();
+    oitAvailable = initOIT();
+    deferredAvailable = initDeferred();
+
+    // Set up shaders and get uniform locations
+    shaderProgram = loadShader("shaders/objects/vertex.glsl", "shaders/objects/fragment.glsl");
+    if (shaderProgram.id == 0) {
+        fprintf(stderr, "Failed to load shaders\n");
+    }
+    depthProgram = loadShader("shaders/objects/vertex.glsl", "shaders/objects/depthFragment.glsl");
+    if (depthProgram.id == 0) {
+        fprintf(stderr, "Failed to load depth pre-pass shader; the pre-pass stays off\n");
+    }
+    stateUseProgram(shaderProgram.id);
+
+    if (glGetUniformBlockIndex(shaderProgram.id, uniformBlockNames[UNIFORM_BLOCK_CAMERA]) == GL_INVALID_INDEX) {
+        fprintf(stderr, "Could not find uniform block '%s'\n", uniformBlockNames[UNIFORM_BLOCK_CAMERA]);
+    }
+
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+
+    // Initialize camera, object manager, and other essential systems
+    initCamera(&camera);
+    initObjectManager();
+
+    // Enable depth testing for 3D rendering
+    stateEnable(GL_DEPTH_TEST);
+
+    // Disable face culling to ensure all faces are rendered
+    stateDisable(GL_CULL_FACE);
+
+    printf("OpenGL Version: %s\n", glGetString(GL_VERSION));
+    printf("GLSL Version: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
+    printf("Renderer: %s\n", glGetString(GL_RENDERER));
+}
+
 void setup() {
     strncpy(screen.title, "C1ue Engine v1.1.0", sizeof(screen.title) - 1);
 
@@ -81,47 +159,46 @@ void setup() {
         fprintf(stderr, "Failed to initialize GLAD\n");
         exit(EXIT_FAILURE);
     }
-    glfwSwapInterval(1);
+    glfwSwapInterval(vsyncEnabled ? 1 : 0);
     setup_imgui(screen.window);
-
-    // Set up shaders and get uniform locations
-    shaderProgram = loadShader("shaders/objects/vertex.glsl", "shaders/objects/fragment.glsl");
-    if (shaderProgram == 0) {
-        fprintf(stderr, "Failed to load shaders\n");
-    }
-    glUseProgram(shaderProgram);
-
-    viewLoc = glGetUniformLocation(shaderProgram, "view");
-    if (viewLoc == -1) {
-        fprintf(stderr, "Could not find uniform variable 'view'\n");
-    }
-
-    projLoc = glGetUniformLocation(shaderProgram, "projection");
-    if (projLoc == -1) {
-        fprintf(stderr, "Could not find uniform variable 'projection'\n");
-    }
-
-    glClearColor(0.0, 0.0, 0.0, 0.0);
     glfwSetInputMode(screen.window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    // Initialize camera, object manager, and other essential systems
-    initCamera(&camera);
-    initObjectManager();
+    initRenderer();
+}
 
-    // Enable depth testing for 3D rendering
-    glEnable(GL_DEPTH_TEST);
+// No window, monitor or GUI: frames go to an offscreen framebuffer of the given size
+bool setupHeadless(int width, int height) {
+    strncpy(screen.title, "C1ue Engine v1.1.0 (headless)", sizeof(screen.title) - 1);
 
-    // Disable face culling to ensure all faces are rendered
-    glDisable(GL_CULL_FACE);
+    if (!initHeadlessContext(width, height)) {
+        fprintf(stderr, "Failed to create headless context\n");
+        return false;
+    }
+    screen.window = NULL;
+    screen.width = width;
+    screen.height = height;
 
-        printf("OpenGL Version: %s\n", glGetString(GL_VERSION));
-    printf("GLSL Version: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
+    initRenderer();
+    return true;
 }
 
 void drawMesh(const Mesh* mesh) {
-    glBindVertexArray(mesh->VAO);
+    stateBindVertexArray(mesh->VAO);
     glDrawElements(GL_TRIANGLES, mesh->numIndices, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    stateCountDraw(mesh->numIndices, 1);
+}
+
+// Levels past the mesh's coarsest draw the coarsest
+void drawMeshLOD(const Mesh* mesh, int level) {
+    if (level <= 0 || mesh->lods.count <= 1) {
+        drawMesh(mesh);
+        return;
+    }
+    if (level >= mesh->lods.count) level = mesh->lods.count - 1;
+    stateBindVertexArray(mesh->VAO);
+    glDrawElements(GL_TRIANGLES, mesh->lods.levels[level].indexCount, GL_UNSIGNED_INT,
+        (void*)(mesh->lods.levels[level].indexOffset * sizeof(unsigned int)));
+    stateCountDraw(mesh->lods.levels[level].indexCount, 1);
 }
 
 void processKeyboardMovements(Camera* camera, float deltaTime) {
@@ -169,114 +246,210 @@ void handleObjectCreation(int key, bool* pressedFlag, ObjectType objType) {
 }
 
 
-void render_scene(const Matrix4x4 viewMatrix, const Matrix4x4 projMatrix) {
+void render_scene() {
     for (int i = 0; i < objectManager.count; i++) {
-        drawObject(&objectManager.objects[i], viewMatrix, projMatrix);
+        drawObject(i);
     }
 }
 
-float distanceFromCamera(SceneObject* obj) {
-    Vector3 diff = vector_sub(camera.Position, obj->position);
-    return vector_length(diff);
-}
 
-int compareObjects(const void* a, const void* b) {
-    SceneObject* objA = *(SceneObject**)a;
-    SceneObject* objB = *(SceneObject**)b;
-    float distanceA = vector_length(vector_sub(camera.Position, objA->position));
-    float distanceB = vector_length(vector_sub(camera.Position, objB->position));
-    return (distanceA < distanceB) - (distanceA > distanceB); // Sort descending
-}
+void setShaderUniforms(int index) {
+    const ObjectRenderState* state = &objectManager.renderStates[index];
+    const Vector4 color = objectManager.colors[index];
+    bool useTexture = (state->flags & OBJECT_FLAG_TEXTURE) != 0;
+    bool useObjectPBR = (state->flags & OBJECT_FLAG_PBR) != 0;
 
-void setShaderUniforms(SceneObject* obj) {
-    glUseProgram(shaderProgram);
-    GLint useTextureLoc = glGetUniformLocation(shaderProgram, "useTexture");
-    GLint usePBRLoc = glGetUniformLocation(shaderProgram, "usePBR");
-    GLint useColorLoc = glGetUniformLocation(shaderProgram, "useColor");
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "inputColor");
+    stateUseProgram(shaderProgram.id);
 
     // Set texture usage
-    glUniform1i(useTextureLoc, texturesEnabled && obj->object.useTexture && !obj->object.usePBR);
+    glUniform1i(shaderProgram.slots[UNIFORM_USE_TEXTURE], texturesEnabled && useTexture && !useObjectPBR);
     // Set PBR usage
-    glUniform1i(usePBRLoc, usePBR && obj->object.usePBR);
+    glUniform1i(shaderProgram.slots[UNIFORM_USE_PBR], usePBR && useObjectPBR);
     // Set color usage
-    glUniform1i(useColorLoc, colorsEnabled && obj->object.useColor);
+    glUniform1i(shaderProgram.slots[UNIFORM_USE_COLOR], colorsEnabled && (state->flags & OBJECT_FLAG_COLOR));
     // Set input color
-    glUniform4f(colorLoc, obj->color.x, obj->color.y, obj->color.z, obj->color.w);
+    glUniform4f(shaderProgram.slots[UNIFORM_INPUT_COLOR], color.x, color.y, color.z, color.w);
 
-    if (obj->object.useTexture && texturesEnabled) {
-        glBindTexture(GL_TEXTURE_2D, obj->object.textureID);
+    if (useTexture && texturesEnabled) {
+        stateBindTexture(0, GL_TEXTURE_2D, state->textureID);
     }
 
-    if (usePBR && obj->object.usePBR) {
-        bindPBRMaterial(obj->object.material);
+    if (usePBR && useObjectPBR) {
+        // Materials outside the registry are only reachable through the editor record
+        int material = objectManager.materialRefs[index];
+        bindPBRMaterial(material >= 0 ? materials[material] : objectManager.objects[index].object.material);
     }
 }
 
-void render() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    Matrix4x4 projMatrix = getProjectionMatrix(45.0f, (float)screen.width / screen.height, 0.1f, 100.0f);
-    Matrix4x4 viewMatrix = getViewMatrix(&camera);
 
-    // Draw skybox first if background is enabled
-    if (backgroundEnabled) {
-        glDepthFunc(GL_LEQUAL);
-        drawSkybox(&camera, &projMatrix);
-        glDepthFunc(GL_LESS);
-    }
-
-    // Use shader program once
-    glUseProgram(shaderProgram);
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &viewMatrix.data[0][0]);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, &projMatrix.data[0][0]);
-    updateShaderLights();
-    glUniform3fv(glGetUniformLocation(shaderProgram, "viewPos"), 1, (const GLfloat*)&camera.Position);
-    glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, (const GLfloat*)&lights[0].position);
-    glUniform3fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, (const GLfloat*)&lights[0].color);
-    glUniform1f(glGetUniformLocation(shaderProgram, "lightIntensity"), lights[0].intensity);
-    glUniform1i(glGetUniformLocation(shaderProgram, "useLighting"), lightingEnabled);
-    glUniform1i(glGetUniformLocation(shaderProgram, "noShading"), !lightingEnabled);
-
-    // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+// Packets sharing everything above depth in the key, detail level included, can go
+// into one instanced draw, as long as the truncated key fields did not alias two
+// different textures or materials
+static bool canInstanceTogether(const DrawPacket* a, const DrawPacket* b) {
+    const ObjectRenderState* stateA = &objectManager.renderStates[a->object];
+    const ObjectRenderState* stateB = &objectManager.renderStates[b->object];
+    if ((a->key >> SORT_KEY_LOD_SHIFT) != (b->key >> SORT_KEY_LOD_SHIFT)) return false;
+    if (stateA->type == OBJ_MODEL || stateA->type != stateB->type) return false;
+    if ((stateA->flags & OBJECT_FLAG_TEXTURE) && stateA->textureID != stateB->textureID) return false;
+    if (stateA->flags & OBJECT_FLAG_PBR) {
+        int materialA = objectManager.materialRefs[a->object];
+        if (materialA != objectManager.materialRefs[b->object]) return false;
+        if (materialA < 0 && memcmp(&objectManager.objects[a->object].object.material,
+            &objectManager.objects[b->object].object.material, sizeof(PBRMaterial)) != 0) return false;
+    }
+    return true;
+}
 
-    // Separate objects into opaque and transparent lists
-    SceneObject* opaqueObjects[MAX_OBJECTS];
-    SceneObject* transparentObjects[MAX_OBJECTS];
-    int opaqueCount = 0;
-    int transparentCount = 0;
+Matrix4x4 getSceneProjectionMatrix() {
+    return getProjectionMatrix(45.0f, (float)screen.width / screen.height, NEAR_PLANE, FAR_PLANE);
+}
 
-    for (int i = 0; i < objectManager.count; i++) {
-        SceneObject* obj = &objectManager.objects[i];
-        if (obj->color.w < 1.0f) {
-            transparentObjects[transparentCount++] = obj;
+// Draws the opaque queue, grouped by program, material, texture and vertex
+// array, front to back within each group. Runs of the same primitive are
+// submitted as a single instanced draw. depthOnly skips the material setup.
+static void drawOpaqueQueue(const FrameBuild* build, bool depthOnly) {
+    const RenderQueue* opaqueQueue = &build->opaque;
+    for (int i = 0; i < opaqueQueue->count;) {
+        int index = opaqueQueue->packets[i].object;
+        if (!depthOnly) {
+            setShaderUniforms(index);
         }
-        else {
-            opaqueObjects[opaqueCount++] = obj;
+
+        if (objectManager.renderStates[index].type == OBJ_MODEL) {
+            drawObjectAt(index, &build->instances[index].model, &build->instances[index].normal, build->lodLevels[index]);
+            i++;
+            continue;
         }
+
+        beginInstanceBatch((ObjectType)objectManager.renderStates[index].type, build->lodLevels[index]);
+        int run = i;
+        do {
+            const InstanceData* instance = &build->instances[opaqueQueue->packets[run].object];
+            addInstance(&instance->model, &instance->normal, instance->color);
+            run++;
+        } while (run < opaqueQueue->count && canInstanceTogether(&opaqueQueue->packets[i], &opaqueQueue->packets[run]));
+        flushInstanceBatch();
+        i = run;
     }
+}
 
-    // Sort transparent objects by distance from the camera (farthest first)
-    qsort(transparentObjects, transparentCount, sizeof(SceneObject*), compareObjects);
+// Lays down the opaque depth with a fragment shader that does nothing
+static void drawDepthPrepass(const FrameBuild* build) {
+    // The draw helpers set their uniforms through shaderProgram, so the depth
+    // program stands in for it while the queue is drawn
+    ShaderProgram objectProgram = shaderProgram;
+    shaderProgram = depthProgram;
+    stateUseProgram(shaderProgram.id);
+    stateEnable(GL_DEPTH_TEST);
+    stateDepthFunc(GL_LESS);
+    stateDepthMask(GL_TRUE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    drawOpaqueQueue(build, true);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    shaderProgram = objectProgram;
+}
 
-    // Render opaque objects first
-    for (int i = 0; i < opaqueCount; i++) {
-        SceneObject* obj = opaqueObjects[i];
-        setShaderUniforms(obj);
-        drawObject(obj, viewMatrix, projMatrix);
+static void drawBackground() {
+    if (backgroundEnabled) {
+        beginGpuPass(GPU_PASS_SKYBOX);
+        stateDepthFunc(GL_LEQUAL);
+        drawSkybox();
+        stateDepthFunc(GL_LESS);
+        endGpuPass();
+    }
+}
+
+// Draws a finished build: skybox, opaque queue, then the transparent draws.
+// With the pre-pass, opaque depth goes first so the skybox and the opaque
+// pass only shade the pixels that end up visible. Deferred, the opaque pass
+// fills the G-buffer and one fullscreen pass lights it; the skybox follows,
+// since it lands on the default framebuffer.
+static void submitFrame(const FrameBuild* build) {
+    bool deferred = deferredEnabled && deferredAvailable && build->opaque.count > 0 &&
+        beginGBufferPass(getSceneWidth(), getSceneHeight());
+    bool prepass = depthPrepassEnabled && depthProgram.id != 0 && build->opaque.count > 0;
+    if (prepass) {
+        PROFILE_BEGIN("prepass");
+        beginGpuPass(GPU_PASS_PREPASS);
+        drawDepthPrepass(build);
+        endGpuPass();
+        PROFILE_END();
     }
 
-    // Render transparent objects last
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Draw skybox first if background is enabled
+    if (!deferred) {
+        drawBackground();
+    }
+
+    stateUseProgram(shaderProgram.id);
+    bindLightClusters();
+
+    // Enable depth testing
+    stateEnable(GL_DEPTH_TEST);
+    stateDepthFunc(GL_LESS);
+
+    // Render opaque objects first. After the pre-pass the depth buffer is
+    // final, so only the nearest fragment of each pixel passes.
+    PROFILE_BEGIN("opaque");
+    beginGpuPass(GPU_PASS_OPAQUE);
+    if (prepass) {
+        stateDepthFunc(GL_EQUAL);
+        stateDepthMask(GL_FALSE);
+    }
+    if (deferred) {
+        glUniform1i(shaderProgram.slots[UNIFORM_GBUFFER_PASS], GL_TRUE);
+    }
+    drawOpaqueQueue(build, false);
+    if (deferred) {
+        glUniform1i(shaderProgram.slots[UNIFORM_GBUFFER_PASS], GL_FALSE);
+    }
+    if (prepass) {
+        stateDepthFunc(GL_LESS);
+        stateDepthMask(GL_TRUE);
+    }
+    endGpuPass();
+    PROFILE_END();
+
+    if (deferred) {
+        PROFILE_BEGIN("lighting");
+        beginGpuPass(GPU_PASS_LIGHTING);
+        endGBufferPass();
+        endGpuPass();
+        PROFILE_END();
+        drawBackground();
+        stateUseProgram(shaderProgram.id);
+    }
+
+    // Render transparent objects last. Weighted blended OIT needs no ordering;
+    // without it they go in the build's order, farthest from the camera first.
+    // The build chose between them; should the OIT targets fail to come up, an
+    // OIT build blends its transparents unsorted for that frame.
+    PROFILE_BEGIN("transparent");
+    int transparentCount = build->transparentCount;
+    if (transparentCount > 0) beginGpuPass(GPU_PASS_TRANSPARENT);
+    bool oit = transparentCount > 0 && !build->sortTransparent && beginOITPass(getSceneWidth(), getSceneHeight());
+    if (oit) {
+        glUniform1i(shaderProgram.slots[UNIFORM_OIT_PASS], GL_TRUE);
+    }
+    else if (transparentCount > 0) {
+        stateEnable(GL_BLEND);
+        stateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
     for (int i = 0; i < transparentCount; i++) {
-        SceneObject* obj = transparentObjects[i];
-        setShaderUniforms(obj);
-        drawObject(obj, viewMatrix, projMatrix);
+        int index = build->transparent[i].object;
+        setShaderUniforms(index);
+        drawObjectAt(index, &build->instances[index].model, &build->instances[index].normal, build->lodLevels[index]);
+    }
+    if (oit) {
+        glUniform1i(shaderProgram.slots[UNIFORM_OIT_PASS], GL_FALSE);
+        endOITPass();
+        stateUseProgram(shaderProgram.id);
     }
-    glDisable(GL_BLEND);
+    else if (transparentCount > 0) {
+        stateDisable(GL_BLEND);
+    }
+    endGpuPass();
+    PROFILE_END();
 
     // Draw model's meshes if loaded
     if (model) {
@@ -286,6 +459,68 @@ void render() {
     }
 }
 
+void render() {
+    PROFILE_BEGIN("render");
+    beginStateFrame();
+    beginUniformFrame();
+    beginGpuTimerFrame();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Recompose whatever moved since last frame; builds only read the scene
+    PROFILE_BEGIN("transforms");
+    updateTransforms();
+    PROFILE_END();
+
+    FrameBuild* next = &frameBuilds[nextBuild];
+    FrameBuild* previous = &frameBuilds[nextBuild ^ 1];
+    nextBuild ^= 1;
+    next->view = getViewMatrix(&camera);
+    next->projection = getSceneProjectionMatrix();
+    next->eye = camera.Position;
+    next->front = camera.Front;
+    next->nearPlane = NEAR_PLANE;
+    next->farPlane = FAR_PLANE;
+    next->lodScale = getLODDetailScale();
+    next->sortTransparent = !(oitEnabled && oitAvailable);
+
+    // Pipelined, this frame draws last frame's build while the workers build
+    // the next one. A removal since then has moved the indices it refers to.
+    bool overlap = pipelineEnabled && getJobWorkerCount() > 0 && isFrameBuildCurrent(previous);
+    const FrameBuild* drawn = overlap ? previous : next;
+    if (!overlap) {
+        PROFILE_BEGIN("build");
+        startFrameBuild(next);
+        finishFrameBuild(next);
+        PROFILE_END();
+    }
+    cullStats = drawn->cullStats;
+
+    // Below full scale the scene goes to a smaller target, stretched to fit at the end
+    beginSceneTarget(screen.width, screen.height, getRenderScale());
+
+    // Per-frame inputs shared by the skybox and object programs, for the
+    // camera the drawn build was culled with. Each block is only re-sent when
+    // its contents differ from the previous frame.
+    updateCameraUniforms(&drawn->view, &drawn->projection, drawn->eye);
+    updateFrameUniforms(lightingEnabled, !lightingEnabled);
+    PROFILE_BEGIN("light clusters");
+    updateLightClusters(&drawn->view, &drawn->projection, NEAR_PLANE, FAR_PLANE, getSceneWidth(), getSceneHeight());
+    PROFILE_END();
+
+    // Light clustering is a parallelFor of its own, so the build starts after it
+    if (overlap) {
+        startFrameBuild(next);
+    }
+    submitFrame(drawn);
+    endSceneTarget();
+    if (overlap) {
+        PROFILE_BEGIN("build wait");
+        finishFrameBuild(next);
+        PROFILE_END();
+    }
+    PROFILE_END();
+}
+
 double calculateDeltaTime() {
     double currentFrameTime = glfwGetTime();
     deltaTime = currentFrameTime - lastFrame;
@@ -302,6 +537,7 @@ void update(double deltaTime) {
         printf("\nExiting...\n");
         exit(EXIT_SUCCESS);
     }
+    PROFILE_BEGIN("update");
 
     handleToggleInput(GLFW_KEY_T, &texturesPressed, &texturesEnabled, "Textures");
     handleToggleInput(GLFW_KEY_L, &colorTogglePressed, &colorsEnabled, "Colors");
@@ -323,6 +559,7 @@ void update(double deltaTime) {
     }
 
     processKeyboardMovements(&camera, deltaTime);
+    PROFILE_END();
 }
 
 void handleMouseInput(GLFWwindow* window, Camera* camera) {
@@ -360,7 +597,26 @@ void handleMouseInput(GLFWwindow* window, Camera* camera) {
 }
 
 void end() {
+    freeFrameBuild(&frameBuilds[0]);
+    freeFrameBuild(&frameBuilds[1]);
+    deleteShader(&depthProgram);
+    cleanupInstancing();
     cleanupObjects();
-    glfwDestroyWindow(screen.window);
-    glfwTerminate();
+    cleanupGeometry();
+    cleanupOIT();
+    cleanupDeferred();
+    cleanupFullscreenTriangle();
+    cleanupSceneTarget();
+    cleanupGpuTimers();
+    cleanupLightClusters();
+    cleanupUniformBuffers();
+    shutdownJobSystem();
+    if (screen.window) {
+        glfwDestroyWindow(screen.window);
+        glfwTerminate();
+        screen.window = NULL;
+    }
+    else {
+        destroyHeadlessContext();
+    }
 }
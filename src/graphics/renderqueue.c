@@ -0,0 +1,105 @@
+#include "renderqueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint64_t makeSortKey(RenderPass pass, unsigned int variant, unsigned int material, unsigned int texture, unsigned int vao, unsigned int lod, float depth) {
+    // Depth is normalized to [0, 1] by the caller; out of range values are clamped
+    if (depth < 0.0f) depth = 0.0f;
+    if (depth > 1.0f) depth = 1.0f;
+    uint64_t depthBits = (uint64_t)(depth * (float)((1u << SORT_KEY_DEPTH_BITS) - 1));
+
+    return ((uint64_t)(pass & 0x3) << SORT_KEY_PASS_SHIFT)
+        | ((uint64_t)(variant & 0xF) << SORT_KEY_VARIANT_SHIFT)
+        | ((uint64_t)(material & 0xFF) << SORT_KEY_MATERIAL_SHIFT)
+        | ((uint64_t)(texture & 0x3FF) << SORT_KEY_TEXTURE_SHIFT)
+        | ((uint64_t)(vao & 0xFFFF) << SORT_KEY_VAO_SHIFT)
+        | ((uint64_t)(lod & 0x3) << SORT_KEY_LOD_SHIFT)
+        | depthBits;
+}
+
+void initRenderQueue(RenderQueue* queue, int capacity) {
+    queue->count = 0;
+    queue->capacity = capacity > 0 ? capacity : 64;
+    queue->packets = (DrawPacket*)malloc(queue->capacity * sizeof(DrawPacket));
+    queue->scratch = (DrawPacket*)malloc(queue->capacity * sizeof(DrawPacket));
+    if (!queue->packets || !queue->scratch) {
+        fprintf(stderr, "Failed to allocate render queue.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void freeRenderQueue(RenderQueue* queue) {
+    free(queue->packets);
+    free(queue->scratch);
+    queue->packets = NULL;
+    queue->scratch = NULL;
+    queue->count = 0;
+    queue->capacity = 0;
+}
+
+void clearRenderQueue(RenderQueue* queue) {
+    queue->count = 0;
+}
+
+void pushDraw(RenderQueue* queue, uint64_t key, int object) {
+    if (queue->count == queue->capacity) {
+        int newCapacity = queue->capacity * 2;
+        DrawPacket* packets = (DrawPacket*)realloc(queue->packets, newCapacity * sizeof(DrawPacket));
+        DrawPacket* scratch = (DrawPacket*)realloc(queue->scratch, newCapacity * sizeof(DrawPacket));
+        if (!packets || !scratch) {
+            fprintf(stderr, "Failed to grow render queue.\n");
+            exit(EXIT_FAILURE);
+        }
+        queue->packets = packets;
+        queue->scratch = scratch;
+        queue->capacity = newCapacity;
+    }
+    queue->packets[queue->count].key = key;
+    queue->packets[queue->count].object = object;
+    queue->count++;
+}
+
+// LSD radix sort, one byte per pass. Passes where every key shares the same
+// byte are skipped, which is most of them for scenes with few materials.
+void sortRenderQueue(RenderQueue* queue) {
+    if (queue->count < 2) return;
+
+    unsigned int histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (int i = 0; i < queue->count; i++) {
+        uint64_t key = queue->packets[i].key;
+        for (int pass = 0; pass < 8; pass++) {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    DrawPacket* src = queue->packets;
+    DrawPacket* dst = queue->scratch;
+    for (int pass = 0; pass < 8; pass++) {
+        unsigned int* counts = histograms[pass];
+        if (counts[(src[0].key >> (pass * 8)) & 0xFF] == (unsigned int)queue->count) {
+            continue;
+        }
+
+        unsigned int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            unsigned int c = counts[b];
+            counts[b] = offset;
+            offset += c;
+        }
+        for (int i = 0; i < queue->count; i++) {
+            dst[counts[(src[i].key >> (pass * 8)) & 0xFF]++] = src[i];
+        }
+
+        DrawPacket* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    // Keep the sorted result in packets; scratch is free for the next frame
+    if (src != queue->packets) {
+        queue->scratch = queue->packets;
+        queue->packets = src;
+    }
+}
@@ -0,0 +1,108 @@
+#include "rendertarget.h"
+#include "glstate.h"
+#include "headless.h"
+#include <stdio.h>
+#include <string.h>
+
+static GLuint emptyVAO = 0;  // Core profile needs a VAO for the fullscreen triangle
+
+void createRenderTarget(RenderTarget* target, const char* name) {
+    memset(target, 0, sizeof(*target));
+    target->name = name;
+    glGenFramebuffers(1, &target->framebuffer);
+}
+
+GLuint addTargetTexture(RenderTarget* target, GLenum attachment, GLenum internalFormat, GLenum format, GLenum type) {
+    if (target->textureCount == RENDER_TARGET_MAX_TEXTURES) {
+        fprintf(stderr, "%s target has no room for another texture\n", target->name);
+        return 0;
+    }
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    invalidateStateCache();
+
+    TargetTexture* slot = &target->textures[target->textureCount++];
+    slot->texture = texture;
+    slot->internalFormat = internalFormat;
+    slot->format = format;
+    slot->type = type;
+    target->width = target->height = 0;
+    return texture;
+}
+
+void addTargetDepthBuffer(RenderTarget* target) {
+    glGenRenderbuffers(1, &target->depthBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target->depthBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    target->width = target->height = 0;
+}
+
+void deleteRenderTarget(RenderTarget* target) {
+    for (int i = 0; i < target->textureCount; i++) {
+        glDeleteTextures(1, &target->textures[i].texture);
+    }
+    if (target->depthBuffer) glDeleteRenderbuffers(1, &target->depthBuffer);
+    if (target->framebuffer) glDeleteFramebuffers(1, &target->framebuffer);
+    memset(target, 0, sizeof(*target));
+    invalidateStateCache();
+}
+
+bool resizeRenderTarget(RenderTarget* target, int width, int height) {
+    if (width == target->width && height == target->height) {
+        return target->complete;
+    }
+
+    for (int i = 0; i < target->textureCount; i++) {
+        const TargetTexture* texture = &target->textures[i];
+        glBindTexture(GL_TEXTURE_2D, texture->texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, texture->internalFormat, width, height, 0, texture->format, texture->type, NULL);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (target->depthBuffer) {
+        glBindRenderbuffer(GL_RENDERBUFFER, target->depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+    invalidateStateCache();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    target->complete = status == GL_FRAMEBUFFER_COMPLETE;
+    if (!target->complete) {
+        fprintf(stderr, "%s framebuffer incomplete (0x%x)\n", target->name, status);
+    }
+
+    target->width = width;
+    target->height = height;
+    return target->complete;
+}
+
+void drawFullscreenTriangle() {
+    if (!emptyVAO) {
+        glGenVertexArrays(1, &emptyVAO);
+    }
+    stateBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    stateCountDraw(3, 1);
+}
+
+void cleanupFullscreenTriangle() {
+    if (emptyVAO) {
+        glDeleteVertexArrays(1, &emptyVAO);
+        emptyVAO = 0;
+        invalidateStateCache();
+    }
+}
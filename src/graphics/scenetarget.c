@@ -0,0 +1,109 @@
+#include "scenetarget.h"
+#include "glstate.h"
+#include "headless.h"
+#include <stdio.h>
+
+static GLuint framebuffer = 0;
+static GLuint colorBuffer = 0;
+static GLuint depthBuffer = 0;   // Same format as the default one, so OIT and deferred can blit depth
+static int targetWidth = 0;
+static int targetHeight = 0;
+static bool targetComplete = false;
+
+// This frame's scene, and the framebuffer it is shown in
+static bool scaled = false;
+static int sceneWidth = 0;
+static int sceneHeight = 0;
+static int outputWidth = 0;
+static int outputHeight = 0;
+
+// Storage is only respecified when the scaled size changes
+static bool resizeTarget(int width, int height) {
+    if (width == targetWidth && height == targetHeight) {
+        return targetComplete;
+    }
+
+    if (!framebuffer) {
+        glGenRenderbuffers(1, &colorBuffer);
+        glGenRenderbuffers(1, &depthBuffer);
+        glGenFramebuffers(1, &framebuffer);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    targetComplete = status == GL_FRAMEBUFFER_COMPLETE;
+    if (!targetComplete) {
+        fprintf(stderr, "Scene framebuffer incomplete (0x%x)\n", status);
+    }
+
+    targetWidth = width;
+    targetHeight = height;
+    return targetComplete;
+}
+
+void beginSceneTarget(int width, int height, float scale) {
+    outputWidth = sceneWidth = width;
+    outputHeight = sceneHeight = height;
+    scaled = false;
+    if (scale >= 1.0f || width <= 0 || height <= 0) {
+        return;
+    }
+
+    int scaledWidth = (int)(width * scale + 0.5f);
+    int scaledHeight = (int)(height * scale + 0.5f);
+    if (scaledWidth < 1) scaledWidth = 1;
+    if (scaledHeight < 1) scaledHeight = 1;
+    if (!resizeTarget(scaledWidth, scaledHeight)) {
+        return;
+    }
+
+    scaled = true;
+    sceneWidth = scaledWidth;
+    sceneHeight = scaledHeight;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, sceneWidth, sceneHeight);
+    stateDepthMask(GL_TRUE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void endSceneTarget() {
+    if (!scaled) return;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, getDefaultFramebuffer());
+    glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, outputWidth, outputHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, getDefaultFramebuffer());
+    glViewport(0, 0, outputWidth, outputHeight);
+    scaled = false;
+}
+
+void cleanupSceneTarget() {
+    if (framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
+    framebuffer = colorBuffer = depthBuffer = 0;
+    targetWidth = targetHeight = 0;
+    targetComplete = false;
+}
+
+GLuint getSceneFramebuffer() {
+    return scaled ? framebuffer : getDefaultFramebuffer();
+}
+
+int getSceneWidth() {
+    return sceneWidth;
+}
+
+int getSceneHeight() {
+    return sceneHeight;
+}
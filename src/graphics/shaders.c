@@ -1,4 +1,9 @@
 #include "shaders.h"
+#include "glstate.h"
+#include "uniformbuffers.h"
+#include "lightclusters.h"
+#include "oit.h"
+#include "deferred.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -54,14 +59,173 @@ bool checkCompileErrors(unsigned int shader, const char* type) {
     return true;
 }
 
+static const char* uniformSlotNames[UNIFORM_SLOT_COUNT] = {
+    "model",
+    "normalMatrix",
+    "inputColor",
+    "useTexture",
+    "useColor",
+    "usePBR",
+    "useInstancing",
+    "oitPass",
+    "gbufferPass",
+};
+
+// Texture units the engine binds each sampler to (see bindPBRMaterial)
+static const struct {
+    const char* name;
+    GLint unit;
+} samplerUnits[] = {
+    { "texture1", 0 },
+    { "skybox", 0 },
+    { "albedoMap", 0 },
+    { "normalMap", 1 },
+    { "metallicMap", 2 },
+    { "roughnessMap", 3 },
+    { "aoMap", 4 },
+    { "clusterLights", CLUSTER_UNIT_LIGHTS },
+    { "clusterGrid", CLUSTER_UNIT_GRID },
+    { "clusterIndices", CLUSTER_UNIT_INDICES },
+    { "oitAccum", OIT_UNIT_ACCUM },
+    { "oitRevealage", OIT_UNIT_REVEALAGE },
+    { "gAlbedo", DEFERRED_UNIT_ALBEDO },
+    { "gNormal", DEFERRED_UNIT_NORMAL },
+    { "gMaterial", DEFERRED_UNIT_MATERIAL },
+    { "gDepth", DEFERRED_UNIT_DEPTH },
+};
+
+GLint findUniform(const ShaderProgram* program, const char* name) {
+    for (int i = 0; i < program->uniformCount; i++) {
+        if (strcmp(program->uniforms[i].name, name) == 0) {
+            return program->uniforms[i].location;
+        }
+    }
+    return -1;
+}
+
+// Enumerate the active uniforms of a linked program and resolve the engine slots
+static void resolveUniforms(ShaderProgram* program) {
+    GLint activeCount = 0;
+    glGetProgramiv(program->id, GL_ACTIVE_UNIFORMS, &activeCount);
+
+    program->uniforms = activeCount > 0 ? (ShaderUniform*)calloc(activeCount, sizeof(ShaderUniform)) : NULL;
+    program->uniformCount = 0;
+    for (GLint i = 0; i < activeCount && program->uniforms; i++) {
+        ShaderUniform* uniform = &program->uniforms[program->uniformCount];
+        GLsizei length = 0;
+        glGetActiveUniform(program->id, (GLuint)i, sizeof(uniform->name), &length, &uniform->size, &uniform->type, uniform->name);
+
+        // Uniform block members have no location and are not set through glUniform*
+        uniform->location = glGetUniformLocation(program->id, uniform->name);
+        if (uniform->location == -1) {
+            continue;
+        }
+
+        // Plain arrays are reported as "name[0]"; store them under "name"
+        char* bracket = strstr(uniform->name, "[0]");
+        if (bracket && bracket[3] == '\0') {
+            *bracket = '\0';
+        }
+        program->uniformCount++;
+    }
+
+    for (int slot = 0; slot < UNIFORM_SLOT_COUNT; slot++) {
+        program->slots[slot] = findUniform(program, uniformSlotNames[slot]);
+    }
+
+    bindUniformBlocks(program->id);
+
+    // Sampler units never change, so set them once here instead of per draw
+    stateUseProgram(program->id);
+    for (size_t i = 0; i < sizeof(samplerUnits) / sizeof(samplerUnits[0]); i++) {
+        GLint location = findUniform(program, samplerUnits[i].name);
+        if (location != -1) {
+            glUniform1i(location, samplerUnits[i].unit);
+        }
+    }
+}
+
+void deleteShader(ShaderProgram* program) {
+    if (program->id) {
+        glDeleteProgram(program->id);
+        program->id = 0;
+    }
+    free(program->uniforms);
+    program->uniforms = NULL;
+    program->uniformCount = 0;
+}
+
+#define SHADER_INCLUDE_DEPTH 4
+
+// Reads a shader and splices in every line of the form #include "path", where
+// path is relative to the working directory like the paths given to
+// loadShader. GLSL has no includes of its own, so sources shared by several
+// programs (shaders/common) go through here.
+static char* readShaderSource(const char* filePath, int depth) {
+    char* source = readFile(filePath);
+    if (!source || depth >= SHADER_INCLUDE_DEPTH) return source;
+
+    const char* directive = "#include \"";
+    size_t directiveLength = strlen(directive);
+    char* line = source;
+    while (line && *line) {
+        char* next = strchr(line, '\n');
+        if (strncmp(line, directive, directiveLength) != 0) {
+            line = next ? next + 1 : NULL;
+            continue;
+        }
+
+        char* pathStart = line + directiveLength;
+        char* pathEnd = strchr(pathStart, '"');
+        if (!pathEnd || (next && pathEnd > next)) {
+            fprintf(stderr, "Malformed #include in %s\n", filePath);
+            free(source);
+            return NULL;
+        }
+        char includePath[256];
+        size_t pathLength = (size_t)(pathEnd - pathStart);
+        if (pathLength >= sizeof(includePath)) pathLength = sizeof(includePath) - 1;
+        memcpy(includePath, pathStart, pathLength);
+        includePath[pathLength] = '\0';
+
+        char* included = readShaderSource(includePath, depth + 1);
+        if (!included) {
+            free(source);
+            return NULL;
+        }
+
+        // source up to the directive, the included text, then the rest
+        size_t before = (size_t)(line - source);
+        const char* rest = next ? next + 1 : "";
+        size_t includedLength = strlen(included);
+        size_t restLength = strlen(rest);
+        char* spliced = (char*)malloc(before + includedLength + 1 + restLength + 1);
+        if (!spliced) {
+            free(included);
+            free(source);
+            return NULL;
+        }
+        memcpy(spliced, source, before);
+        memcpy(spliced + before, included, includedLength);
+        spliced[before + includedLength] = '\n';
+        memcpy(spliced + before + includedLength + 1, rest, restLength + 1);
+        free(included);
+        free(source);
+        source = spliced;
+        line = source + before + includedLength + 1;
+    }
+    return source;
+}
+
 // Function to load and compile shaders, and link them into a program
-unsigned int loadShader(const char* vertexPath, const char* fragmentPath) {
-    char* vShaderCode = readFile(vertexPath);
-    char* fShaderCode = readFile(fragmentPath);
+ShaderProgram loadShader(const char* vertexPath, const char* fragmentPath) {
+    ShaderProgram program = { 0 };
+    char* vShaderCode = readShaderSource(vertexPath, 0);
+    char* fShaderCode = readShaderSource(fragmentPath, 0);
     if (!vShaderCode || !fShaderCode) {
         if (vShaderCode) free(vShaderCode);
         if (fShaderCode) free(fShaderCode);
-        return 0;
+        return program;
     }
 
     unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -71,7 +235,7 @@ unsigned int loadShader(const char* vertexPath, const char* fragmentPath) {
         free(vShaderCode);
         free(fShaderCode);
         glDeleteShader(vertex);
-        return 0;
+        return program;
     }
 
     unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
@@ -82,7 +246,7 @@ unsigned int loadShader(const char* vertexPath, const char* fragmentPath) {
         free(fShaderCode);
         glDeleteShader(vertex);
         glDeleteShader(fragment);
-        return 0;
+        return program;
     }
 
     unsigned int shaderProgram = glCreateProgram();
@@ -95,7 +259,7 @@ unsigned int loadShader(const char* vertexPath, const char* fragmentPath) {
         glDeleteShader(fragment);
         free(vShaderCode);
         free(fShaderCode);
-        return 0;
+        return program;
     }
 
     glDeleteShader(vertex);
@@ -103,5 +267,7 @@ unsigned int loadShader(const char* vertexPath, const char* fragmentPath) {
     free(vShaderCode);
     free(fShaderCode);
 
-    return shaderProgram;
+    program.id = shaderProgram;
+    resolveUniforms(&program);
+    return program;
 }
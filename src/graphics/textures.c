@@ -1,5 +1,7 @@
 #include "textures.h"
 #include "SOIL2/SOIL2.h"
+#include "glstate.h"
+#include "profiler.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -26,6 +28,7 @@ GLuint getTexture(const char* name) {
 
 
 GLuint loadTexture(const char* filename) {
+    PROFILE_BEGIN("loadTexture");
     GLuint textureID = SOIL_load_OGL_texture(
         filename,
         SOIL_LOAD_AUTO,
@@ -35,16 +38,20 @@ GLuint loadTexture(const char* filename) {
 
     if (textureID == 0) {
         fprintf(stderr, "Failed to load texture file %s: %s\n", filename, SOIL_last_result());
+        PROFILE_END();
         return 0;
     }
 
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    // SOIL binds the new texture on whatever unit is active
+    invalidateStateCache();
+    stateBindTexture(0, GL_TEXTURE_2D, textureID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     fprintf(stderr, "Loaded texture %s, ID %u\n", filename, textureID);
+    PROFILE_END();
     return textureID;
 }
 
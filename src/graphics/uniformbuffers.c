@@ -0,0 +1,113 @@
+#include "uniformbuffers.h"
+#include "glstate.h"
+#include <stdio.h>
+#include <string.h>
+
+const char* uniformBlockNames[UNIFORM_BLOCK_COUNT] = {
+    "CameraBlock",
+    "FrameBlock",
+    "LightBlock",
+};
+
+// CPU mirrors of the std140 layouts. Every member is a vec4/mat4 or is padded
+// out to one, so the C layout matches without offset queries.
+typedef struct {
+    Matrix4x4 view;
+    Matrix4x4 projection;
+    Matrix4x4 skyboxView;  // view without its translation
+    Vector4 viewPos;
+} CameraUniforms;
+
+typedef struct {
+    int useLighting;
+    int noShading;
+    int padding[2];
+} FrameUniforms;
+
+static GLuint buffers[UNIFORM_BLOCK_COUNT];
+static CameraUniforms cameraData;
+static FrameUniforms frameData;
+static LightGridUniforms lightData;
+static bool uploaded[UNIFORM_BLOCK_COUNT];  // Mirrors are only trusted once sent
+static UniformBufferStats currentStats;
+static UniformBufferStats lastFrameStats;
+
+static const GLsizeiptr blockSizes[UNIFORM_BLOCK_COUNT] = {
+    sizeof(CameraUniforms),
+    sizeof(FrameUniforms),
+    sizeof(LightGridUniforms),
+};
+
+void initUniformBuffers() {
+    glGenBuffers(UNIFORM_BLOCK_COUNT, buffers);
+    for (int block = 0; block < UNIFORM_BLOCK_COUNT; block++) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffers[block]);
+        glBufferData(GL_UNIFORM_BUFFER, blockSizes[block], NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, block, buffers[block]);
+        uploaded[block] = false;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void cleanupUniformBuffers() {
+    glDeleteBuffers(UNIFORM_BLOCK_COUNT, buffers);
+    memset(buffers, 0, sizeof(buffers));
+    memset(uploaded, 0, sizeof(uploaded));
+}
+
+// Points a linked program's blocks at the shared binding points
+void bindUniformBlocks(GLuint program) {
+    for (int block = 0; block < UNIFORM_BLOCK_COUNT; block++) {
+        GLuint index = glGetUniformBlockIndex(program, uniformBlockNames[block]);
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(program, index, block);
+        }
+    }
+}
+
+// Copies `size` bytes of `data` into the mirror and the buffer if they differ
+static void uploadIfChanged(UniformBlock block, void* mirror, const void* data, size_t size) {
+    if (uploaded[block] && memcmp(mirror, data, size) == 0) {
+        currentStats.skipped++;
+        return;
+    }
+    memcpy(mirror, data, size);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffers[block]);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)size, mirror);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    uploaded[block] = true;
+    currentStats.uploads++;
+}
+
+void updateCameraUniforms(const Matrix4x4* view, const Matrix4x4* projection, Vector3 viewPos) {
+    CameraUniforms data;
+    data.view = *view;
+    data.projection = *projection;
+    data.skyboxView = *view;
+    data.skyboxView.data[3][0] = 0.0f;
+    data.skyboxView.data[3][1] = 0.0f;
+    data.skyboxView.data[3][2] = 0.0f;
+    data.viewPos = vector4(viewPos.x, viewPos.y, viewPos.z, 1.0f);
+    uploadIfChanged(UNIFORM_BLOCK_CAMERA, &cameraData, &data, sizeof(data));
+}
+
+void updateFrameUniforms(bool useLighting, bool noShading) {
+    FrameUniforms data = { 0 };
+    data.useLighting = useLighting;
+    data.noShading = noShading;
+    uploadIfChanged(UNIFORM_BLOCK_FRAME, &frameData, &data, sizeof(data));
+}
+
+void updateLightUniforms(const LightGridUniforms* grid) {
+    uploadIfChanged(UNIFORM_BLOCK_LIGHTS, &lightData, grid, sizeof(*grid));
+}
+
+void beginUniformFrame() {
+    lastFrameStats = currentStats;
+    currentStats.uploads = 0;
+    currentStats.skipped = 0;
+}
+
+UniformBufferStats getUniformBufferStats() {
+    return lastFrameStats;
+}
@@ -4,6 +4,7 @@
 #include "globals.h"
 #include "SceneObject.h"
 #include "ModelLoad.h"
+#include "geometry.h"
 #include <string.h>
 
 // Define the stacks for undo and redo
@@ -16,11 +17,49 @@ int redoTop = -1;
 Action actionHistory[MAX_ACTIONS];
 int historyCount = 0;
 
-void pushUndoAction(Action action) {
+// ADD and REMOVE actions on either stack each hold a reference to their
+// snapshot's geometry, so undo or redo can re-create the object after the
+// scene let go of it. Whatever drops an action from the stacks releases it.
+static int snapshotGeometry(const Action* action) {
+    switch (action->type) {
+    case ACTION_ADD: return action->newState.object.geometry;
+    case ACTION_REMOVE: return action->previousState.object.geometry;
+    default: return -1;
+    }
+}
+
+static void discardAction(const Action* action) {
+    int geometry = snapshotGeometry(action);
+    if (geometry >= 0) {
+        releaseGeometry(geometry);
+    }
+}
+
+static void clearRedoStack() {
+    while (redoTop >= 0) {
+        discardAction(&redoStack[redoTop--]);
+    }
+}
+
+void clearActionStacks() {
+    while (undoTop >= 0) {
+        discardAction(&undoStack[undoTop--]);
+    }
+    clearRedoStack();
+}
+
+// Returns false when the stack is full and the action was not stored
+static bool storeUndoAction(Action action) {
     if (undoTop < MAX_ACTIONS - 1) {
         undoStack[++undoTop] = action;
-        redoTop = -1; // Clear redo stack whenever a new action is performed
+        return true;
     }
+    return false;
+}
+
+bool pushUndoAction(Action action) {
+    clearRedoStack(); // Clear redo stack whenever a new action is performed
+    return storeUndoAction(action);
 }
 
 Action popUndoAction() {
@@ -30,10 +69,12 @@ Action popUndoAction() {
     return (Action) { .type = -1 };
 }
 
-void pushRedoAction(Action action) {
+bool pushRedoAction(Action action) {
     if (redoTop < MAX_ACTIONS - 1) {
         redoStack[++redoTop] = action;
+        return true;
     }
+    return false;
 }
 
 Action popRedoAction() {
@@ -49,26 +90,64 @@ void addToHistory(Action action) {
     }
 }
 
+// Undoing a removal re-creates the object under a new handle; point every
+// recorded action at it so the rest of the history still applies
+static void remapActionHandle(ObjectHandle from, ObjectHandle to) {
+    for (int i = 0; i <= undoTop; i++) {
+        if (undoStack[i].object == from) undoStack[i].object = to;
+    }
+    for (int i = 0; i <= redoTop; i++) {
+        if (redoStack[i].object == from) redoStack[i].object = to;
+    }
+    for (int i = 0; i < historyCount; i++) {
+        if (actionHistory[i].object == from) actionHistory[i].object = to;
+    }
+}
+
+static void restoreObject(Action* action, const SceneObject* state) {
+    ObjectHandle handle = addObjectToManager(*state);
+    remapActionHandle(action->object, handle);
+    action->object = handle;
+}
+
+// Snapshots may predate the object's current tree leaf and hierarchy links;
+// updateObjectInManager keeps the live ones
+static void restoreTransform(ObjectHandle handle, const SceneObject* state) {
+    SceneObject record = *state;
+    record.handle = handle;
+    updateObjectInManager(&record);
+}
+
+static void restoreColor(ObjectHandle handle, Vector4 color) {
+    int index = getObjectIndex(handle);
+    if (index < 0) return;
+    objectManager.objects[index].color = color;
+    syncObject(index);
+}
+
 void undo_last_action() {
     if (undoTop >= 0) {
         Action action = popUndoAction();
         switch (action.type) {
         case ACTION_ADD:
-            removeObject(action.objectIndex);
+            removeObjectByHandle(action.object);
             break;
         case ACTION_REMOVE:
-            addObjectToManager(action.previousState);
+            restoreObject(&action, &action.previousState);
             break;
         case ACTION_TRANSFORM:
-            objectManager.objects[action.objectIndex] = action.previousState;
+            restoreTransform(action.object, &action.previousState);
             break;
         case ACTION_CHANGE_COLOR:
-            objectManager.objects[action.objectIndex].color = action.previousState.color;
+            restoreColor(action.object, action.previousState.color);
             break;
         default:
             break;
         }
-        pushRedoAction(action);
+        // The action's reference moves with it
+        if (!pushRedoAction(action)) {
+            discardAction(&action);
+        }
     }
 }
 
@@ -77,21 +156,24 @@ void redo_last_action() {
         Action action = popRedoAction();
         switch (action.type) {
         case ACTION_ADD:
-            addObjectToManager(action.newState);
+            restoreObject(&action, &action.newState);
             break;
         case ACTION_REMOVE:
-            removeObject(action.objectIndex);
+            removeObjectByHandle(action.object);
             break;
         case ACTION_TRANSFORM:
-            objectManager.objects[action.objectIndex] = action.newState;
+            restoreTransform(action.object, &action.newState);
             break;
         case ACTION_CHANGE_COLOR:
-            objectManager.objects[action.objectIndex].color = action.newState.color;
+            restoreColor(action.object, action.newState.color);
             break;
         default:
             break;
         }
-        pushUndoAction(action);
+        // Keeps the rest of the redo stack, unlike a new action
+        if (!storeUndoAction(action)) {
+            discardAction(&action);
+        }
     }
 }
 
@@ -101,32 +183,25 @@ void removeObjectWithAction(int index) {
     Action action = {
         .type = ACTION_REMOVE,
         .previousState = objectManager.objects[index],
-        .objectIndex = index
+        .object = objectManager.handles[index]
     };
 
-    pushUndoAction(action);
+    // The action keeps the geometry alive so undo can restore the object
+    if (pushUndoAction(action)) {
+        retainGeometry(snapshotGeometry(&action));
+    }
     addToHistory(action);
 
-    // Remove the object
+    // Remove the object; the last object takes its index
     removeObject(index);
 
-    // Adjust selected_object to a valid object if possible
+    // Adjust the selection to a valid object if possible
     if (objectManager.count > 0) {
-        if (index >= objectManager.count) {
-            selected_object = &objectManager.objects[objectManager.count - 1];
-        }
-        else {
-            selected_object = &objectManager.objects[index];
-        }
-    }
-    else {
-        selected_object = NULL;
-    }
-
-    if (selected_object) {
-        printf("New selected object: ID=%d, Index=%d\n", selected_object->id, selected_object - objectManager.objects);
+        selected_handle = objectManager.handles[index < objectManager.count ? index : objectManager.count - 1];
+        printf("New selected object: ID=%d\n", getObject(selected_handle)->id);
     }
     else {
+        selected_handle = INVALID_OBJECT_HANDLE;
         printf("No selected object\n");
     }
 
@@ -138,15 +213,20 @@ void removeObjectWithAction(int index) {
 }
 
 void addObjectWithAction(ObjectType type, bool useTextures, int textureID, bool useColors, Model* model, PBRMaterial material, bool usePBR) {
+    int previousCount = objectManager.count;
     addObject(&camera, type, useTextures, textureID, useColors, model, material, usePBR);
+    if (objectManager.count == previousCount) return;
+
     SceneObject* newObject = &objectManager.objects[objectManager.count - 1]; // Get the last added object
     Action action = {
         .type = ACTION_ADD,
         .newState = *newObject,
-        .objectIndex = objectManager.count - 1
+        .object = newObject->handle
     };
     snprintf(action.description, sizeof(action.description), "Added object of type %d", type);
-    pushUndoAction(action);
+    if (pushUndoAction(action)) {
+        retainGeometry(snapshotGeometry(&action));
+    }
     addToHistory(action);
 }
 
@@ -155,10 +235,10 @@ void transformObjectWithAction(int index, Vector3 position, Vector3 rotation, Ve
     Action action = {
         .type = ACTION_TRANSFORM,
         .previousState = objectManager.objects[index],
-        .objectIndex = index,
+        .object = objectManager.handles[index],
         .newState = objectManager.objects[index]
     };
-    snprintf(action.description, sizeof(action.description), "Transformed object at index %d", index);
+    snprintf(action.description, sizeof(action.description), "Transformed object %d", objectManager.objects[index].id);
     action.newState.position = position;
     action.newState.rotation = rotation;
     action.newState.scale = scale;
@@ -167,6 +247,7 @@ void transformObjectWithAction(int index, Vector3 position, Vector3 rotation, Ve
     objectManager.objects[index].position = position;
     objectManager.objects[index].rotation = rotation;
     objectManager.objects[index].scale = scale;
+    syncObject(index);
 }
 
 void changeColorWithAction(int index, Vector4 color) {
@@ -174,20 +255,21 @@ void changeColorWithAction(int index, Vector4 color) {
     Action action = {
         .type = ACTION_CHANGE_COLOR,
         .previousState = objectManager.objects[index],
-        .objectIndex = index,
+        .object = objectManager.handles[index],
         .newState = objectManager.objects[index]
     };
-    snprintf(action.description, sizeof(action.description), "Changed color of object at index %d", index);
+    snprintf(action.description, sizeof(action.description), "Changed color of object %d", objectManager.objects[index].id);
     action.newState.color = color;
     pushUndoAction(action);
     addToHistory(action);
     objectManager.objects[index].color = color;
+    syncObject(index);
 }
 
 void toggleOptionWithAction(const char* optionName, bool newValue) {
     Action action = {
         .type = ACTION_TOGGLE_OPTION,
-        .objectIndex = -1
+        .object = INVALID_OBJECT_HANDLE
     };
     snprintf(action.description, sizeof(action.description), "Toggled option %s to %s", optionName, newValue ? "true" : "false");
     addToHistory(action);
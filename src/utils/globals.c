@@ -1,11 +1,9 @@
 #include "globals.h"
 
 Screen screen;
-unsigned int shaderProgram;
+ShaderProgram shaderProgram;
 Camera camera;
 
-int viewLoc;
-int projLoc;
 int textureIndex = 0;
 int colorCreation = 1;
 
@@ -28,10 +26,17 @@ bool modelPressed = false;
 bool usePBR = true;
 bool pbrTogglePressed = false;
 bool backgroundEnabled = true;
+bool oitEnabled = true;
+bool pipelineEnabled = true;
+bool depthPrepassEnabled = false;
+bool deferredEnabled = false;
+bool vsyncEnabled = true;
+bool governorEnabled = false;
+float governorTargetMs = 16.6f;
 bool show_change_texture = false;
 bool show_change_material = false;
 bool cameraEnabled = true;
-SceneObject* selected_object = NULL;
+ObjectHandle selected_handle = INVALID_OBJECT_HANDLE;
 // Initialize the model variable
 Model* loadedModel = NULL;
 Mesh* loadedModelMesh = NULL;
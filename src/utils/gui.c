@@ -22,6 +22,15 @@
 #include "background.h"
 #include "actions.h"
 #include "materials.h"
+#include "glstate.h"
+#include "uniformbuffers.h"
+#include "lightclusters.h"
+#include "gputimers.h"
+#include "profiler.h"
+#include "geometry.h"
+#include "picking.h"
+#include "governor.h"
+#include "scenetarget.h"
 
 // ImGui C API declarations (implemented in imgui_bridge.cpp)
 extern void imgui_init(GLFWwindow* window);
@@ -54,6 +63,7 @@ extern void imgui_begin_child(const char* str_id, float width, float height, boo
 extern void imgui_end_child();
 extern void imgui_set_item_default_focus();
 extern bool imgui_is_item_focused();
+extern bool imgui_want_capture_mouse();
 extern void imgui_show_demo_window(bool* p_open);
 
 // StellAI C API declarations
@@ -69,9 +79,10 @@ extern void stellai_render();
 // Global variables for GUI state
 static bool show_material_window = false;
 static bool show_texture_window = false;
-static SceneObject* material_window_obj = NULL;
-static SceneObject* texture_window_obj = NULL;
-extern SceneObject* selected_object;
+static ObjectHandle material_window_handle = INVALID_OBJECT_HANDLE;
+static ObjectHandle texture_window_handle = INVALID_OBJECT_HANDLE;
+// Object waiting for its new parent to be clicked, from the inspector
+static ObjectHandle parent_pick_child = INVALID_OBJECT_HANDLE;
 
 // Clipboard for copy/paste operations
 static SceneObject* clipboard_object = NULL;
@@ -110,25 +121,13 @@ const char* objectTypeName(ObjectType type) {
     }
 }
 
-// Find the index of the selected object in the object manager
-int find_selected_object_index(SceneObject* selected_object) {
-    if (selected_object == NULL) return -1;
-    
-    for (int i = 0; i < objectManager.count; i++) {
-        if (&objectManager.objects[i] == selected_object) {
-            return i;
-        }
-    }
-    return -1; // Not found
-}
-
 // Change texture function
 void change_texture(SceneObject* obj) {
     if (obj == NULL) return;
     
     show_texture_window = true;
     show_change_texture = true;
-    texture_window_obj = obj;
+    texture_window_handle = obj->handle;
 }
 
 // Import model function
@@ -141,51 +140,52 @@ void import_model() {
         return;
     }
 
-    Model* model = loadModel(filePath);
-    if (model) {
+    // Importing a file that is already in the scene reuses its meshes
+    int geometry = acquireModelGeometry(filePath, MODEL_IMPORT_FLAGS);
+    const GeometryEntry* entry = getGeometry(geometry);
+    if (entry) {
         PBRMaterial defaultMaterial = *getMaterial("peacockOre");
-        addObjectWithAction(OBJ_MODEL, false, -1, true, model, defaultMaterial, false);
+        addObjectWithAction(OBJ_MODEL, false, -1, true, (Model*)&entry->data.model, defaultMaterial, false);
     }
+    releaseGeometry(geometry);
 }
 
 // Cut, copy, paste functions
 void cut_object() {
-    if (selected_object) {
-        int index = find_selected_object_index(selected_object);
-        if (index != -1) {
-            // Free previous clipboard if exists
-            if (clipboard_object) {
-                free(clipboard_object);
-            }
-            
-            clipboard_object = (SceneObject*)malloc(sizeof(SceneObject));
-            if (clipboard_object) {
-                *clipboard_object = *selected_object;
-                isCutOperation = true;
-                removeObjectWithAction(index);
-                selected_object = NULL;
-                printf("Cut object at index: %d\n", index);
-            }
+    int index = getObjectIndex(selected_handle);
+    if (index != -1) {
+        // Free previous clipboard if exists
+        if (clipboard_object) {
+            releaseGeometry(clipboard_object->object.geometry);
+            free(clipboard_object);
+        }
+        
+        clipboard_object = (SceneObject*)malloc(sizeof(SceneObject));
+        if (clipboard_object) {
+            *clipboard_object = objectManager.objects[index];
+            retainGeometry(clipboard_object->object.geometry);
+            isCutOperation = true;
+            printf("Cut object ID=%d\n", clipboard_object->id);
+            removeObjectWithAction(index);
+            selected_handle = INVALID_OBJECT_HANDLE;
         }
     }
 }
 
 void copy_object() {
+    SceneObject* selected_object = getObject(selected_handle);
     if (selected_object) {
         // Free previous clipboard if exists
         if (clipboard_object) {
+            releaseGeometry(clipboard_object->object.geometry);
             free(clipboard_object);
         }
         
         clipboard_object = (SceneObject*)malloc(sizeof(SceneObject));
         if (clipboard_object) {
+            // The clipboard keeps the shared geometry alive until it is replaced
             *clipboard_object = *selected_object;
-            if (selected_object->object.type == OBJ_MODEL) {
-                clipboard_object->object.data.model.meshes = (Mesh*)malloc(selected_object->object.data.model.meshCount * sizeof(Mesh));
-                for (unsigned int i = 0; i < selected_object->object.data.model.meshCount; i++) {
-                    clipboard_object->object.data.model.meshes[i] = selected_object->object.data.model.meshes[i];
-                }
-            }
+            retainGeometry(clipboard_object->object.geometry);
             isCutOperation = false;
             printf("Copied object\n");
         }
@@ -195,16 +195,11 @@ void copy_object() {
 void paste_object() {
     if (clipboard_object) {
         SceneObject newObject = *clipboard_object;
-        if (clipboard_object->object.type == OBJ_MODEL) {
-            newObject.object.data.model.meshes = (Mesh*)malloc(clipboard_object->object.data.model.meshCount * sizeof(Mesh));
-            for (unsigned int i = 0; i < clipboard_object->object.data.model.meshCount; i++) {
-                newObject.object.data.model.meshes[i] = clipboard_object->object.data.model.meshes[i];
-            }
-        }
 
         if (isCutOperation) {
             addObjectWithAction(newObject.object.type, newObject.object.useTexture, newObject.object.textureID, newObject.object.useColor,
                 (newObject.object.type == OBJ_MODEL ? &newObject.object.data.model : NULL), newObject.object.material, newObject.object.usePBR);
+            releaseGeometry(clipboard_object->object.geometry);
             free(clipboard_object);
             clipboard_object = NULL;
             isCutOperation = false;
@@ -213,7 +208,9 @@ void paste_object() {
             addObjectWithAction(newObject.object.type, newObject.object.useTexture, newObject.object.textureID, newObject.object.useColor,
                 (newObject.object.type == OBJ_MODEL ? &newObject.object.data.model : NULL), newObject.object.material, newObject.object.usePBR);
         }
-        selected_object = &objectManager.objects[objectManager.count - 1];
+        if (objectManager.count > 0) {
+            selected_handle = objectManager.handles[objectManager.count - 1];
+        }
         printf("Pasted object\n");
     }
 }
@@ -255,6 +252,11 @@ void toggle_theme() {
 // Framebuffer size callback
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
+    // Projection aspect and light cluster tiles follow the framebuffer
+    if (width > 0 && height > 0) {
+        screen.width = width;
+        screen.height = height;
+    }
     windowed_width = width;
     windowed_height = height;
 }
@@ -329,12 +331,10 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     }
     
     if (key == GLFW_KEY_DELETE && action == GLFW_PRESS) {
-        if (selected_object) {
-            int index = find_selected_object_index(selected_object);
-            if (index != -1) {
-                removeObjectWithAction(index);
-                selected_object = NULL;
-            }
+        int index = getObjectIndex(selected_handle);
+        if (index != -1) {
+            removeObjectWithAction(index);
+            selected_handle = INVALID_OBJECT_HANDLE;
         }
     }
     
@@ -463,14 +463,35 @@ void run_loading_screen(GLFWwindow* window) {
 // Object selection function
 void select_object(int index) {
     if (index >= 0 && index < objectManager.count) {
-        selected_object = &objectManager.objects[index];
-        printf("Selected object: ID=%d, Index=%d\n", selected_object->id, index);
+        // While choosing a parent, the click attaches instead of selecting
+        if (parent_pick_child != INVALID_OBJECT_HANDLE) {
+            if (!setObjectParent(parent_pick_child, objectManager.handles[index])) {
+                printf("Cannot parent an object to itself or its descendants.\n");
+            }
+            parent_pick_child = INVALID_OBJECT_HANDLE;
+            return;
+        }
+
+        selected_handle = objectManager.handles[index];
+        printf("Selected object: ID=%d, Index=%d\n", objectManager.objects[index].id, index);
         
         // Show inspector automatically when selecting an object
         show_inspector = true;
     }
 }
 
+// Select whatever is under the cursor, unless the click belongs to a GUI window
+void pick_object_at_cursor(double x, double y) {
+    if (imgui_want_capture_mouse()) return;
+
+    PickResult hit;
+    if (pickScreenPoint(x, y, &hit)) {
+        select_object(hit.objectIndex);
+        printf("Picked object ID=%d at distance %.2f (mesh %d, triangle %d)\n",
+               hit.object->id, hit.distance, hit.mesh, hit.triangle);
+    }
+}
+
 // Toggle object property function
 void toggle_object_property(SceneObject* obj, const char* property) {
     if (obj) {
@@ -505,7 +526,7 @@ void reset_gui() {
     show_change_material = false;
     show_object_creator = false;
     show_stellai = false;
-    selected_object = NULL; 
+    selected_handle = INVALID_OBJECT_HANDLE;
 }
 
 // Render hierarchy window
@@ -526,7 +547,7 @@ void render_hierarchy_window() {
                 char label[128];
                 snprintf(label, sizeof(label), "%s ##%d", objectTypeName(obj->object.type), i);
                 
-                bool is_selected = (selected_object == obj);
+                bool is_selected = (objectManager.handles[i] == selected_handle);
                 
                 if (is_selected) {
                     // Highlight selected object
@@ -539,7 +560,7 @@ void render_hierarchy_window() {
                 }
                 
                 // Right-click context menu
-                if (imgui_is_item_focused() && obj == selected_object) {
+                if (imgui_is_item_focused() && is_selected) {
                     // This would be a popup menu in real ImGui, simplified here
                     imgui_text("  Actions:");
                     
@@ -548,7 +569,7 @@ void render_hierarchy_window() {
                     snprintf(option, sizeof(option), "  Delete ##del%d", i);
                     if (imgui_button(option, 0, 0)) {
                         removeObjectWithAction(i);
-                        selected_object = NULL;
+                        selected_handle = INVALID_OBJECT_HANDLE;
                     }
                     
                     snprintf(option, sizeof(option), "  Duplicate ##dup%d", i);
@@ -608,6 +629,7 @@ void render_hierarchy_window() {
 
 // Render inspector window
 void render_inspector_window() {
+    SceneObject* selected_object = getObject(selected_handle);
     if (selected_object != NULL) {
         bool open = true;
         if (imgui_begin_window("Inspector", &show_inspector, 0)) {
@@ -731,12 +753,12 @@ void render_inspector_window() {
                 // Texture and material selection buttons
                 if (imgui_button("Change Texture...", 150, 0)) {
                     show_change_texture = true;
-                    texture_window_obj = selected_object;
+                    texture_window_handle = selected_handle;
                 }
                 
                 if (usePBR && imgui_button("Change Material...", 150, 0)) {
                     show_change_material = true;
-                    material_window_obj = selected_object;
+                    material_window_handle = selected_handle;
                 }
             }
             
@@ -747,6 +769,31 @@ void render_inspector_window() {
                     toggle_object_property(selected_object, "useLighting");
                 }
                 
+                // Hierarchy
+                SceneObject* parent = getObject(selected_object->parent);
+                char parent_text[128];
+                if (parent) {
+                    snprintf(parent_text, sizeof(parent_text), "Parent: %s (ID: %d)", objectTypeName(parent->object.type), parent->id);
+                }
+                else {
+                    snprintf(parent_text, sizeof(parent_text), "Parent: none");
+                }
+                imgui_text(parent_text);
+
+                if (parent_pick_child == selected_handle) {
+                    imgui_text("Click the new parent in the scene or hierarchy.");
+                    if (imgui_button("Cancel##parent", 150, 0)) {
+                        parent_pick_child = INVALID_OBJECT_HANDLE;
+                    }
+                }
+                else if (imgui_button("Set Parent...", 150, 0)) {
+                    parent_pick_child = selected_handle;
+                }
+
+                if (parent && imgui_button("Detach from Parent", 150, 0)) {
+                    setObjectParent(selected_handle, INVALID_OBJECT_HANDLE);
+                }
+                
                 // If it's a model, show model path
                 if (selected_object->object.type == OBJ_MODEL) {
                     imgui_text("Model Path:");
@@ -758,10 +805,10 @@ void render_inspector_window() {
             
             // Actions section
             if (imgui_button("Delete Object", 150, 30)) {
-                int index = find_selected_object_index(selected_object);
+                int index = getObjectIndex(selected_handle);
                 if (index != -1) {
                     removeObjectWithAction(index);
-                    selected_object = NULL;
+                    selected_handle = INVALID_OBJECT_HANDLE;
                 }
                 imgui_end_window();
                 return;
@@ -774,6 +821,7 @@ void render_inspector_window() {
 
 // Render texture selector window
 void render_texture_selector() {
+    SceneObject* texture_window_obj = getObject(texture_window_handle);
     if (show_change_texture && texture_window_obj != NULL) {
         bool open = true;
         if (imgui_begin_window("Select Texture", &show_change_texture, 0)) {
@@ -808,6 +856,7 @@ void render_texture_selector() {
 
 // Render material selector window
 void render_material_selector() {
+    SceneObject* material_window_obj = getObject(material_window_handle);
     if (show_change_material && material_window_obj != NULL) {
         bool open = true;
         if (imgui_begin_window("Select Material", &show_change_material, 0)) {
@@ -899,6 +948,56 @@ void render_settings_window() {
                     backgroundEnabled = bgEnabled;
                     toggleOptionWithAction("backgroundEnabled", backgroundEnabled);
                 }
+
+                bool oit = oitEnabled;
+                if (imgui_checkbox("Order-Independent Transparency", &oit)) {
+                    oitEnabled = oit;
+                    toggleOptionWithAction("oitEnabled", oitEnabled);
+                }
+
+                // Builds draw lists on the job workers while the previous frame is drawn
+                bool pipeline = pipelineEnabled;
+                if (imgui_checkbox("Pipelined Frames", &pipeline)) {
+                    pipelineEnabled = pipeline;
+                    toggleOptionWithAction("pipelineEnabled", pipelineEnabled);
+                }
+
+                // Worth it when shading is fill-bound: every pixel is shaded once
+                bool prepass = depthPrepassEnabled;
+                if (imgui_checkbox("Depth Pre-Pass", &prepass)) {
+                    depthPrepassEnabled = prepass;
+                    toggleOptionWithAction("depthPrepassEnabled", depthPrepassEnabled);
+                }
+
+                // Opaque objects fill a G-buffer, then each pixel is lit once for its lights
+                bool deferred = deferredEnabled;
+                if (imgui_checkbox("Deferred Shading", &deferred)) {
+                    deferredEnabled = deferred;
+                    toggleOptionWithAction("deferredEnabled", deferredEnabled);
+                }
+
+                // Off, frames are shown as soon as they are done, tearing included
+                bool vsync = vsyncEnabled;
+                if (imgui_checkbox("Vsync", &vsync)) {
+                    vsyncEnabled = vsync;
+                    glfwSwapInterval(vsyncEnabled ? 1 : 0);
+                    toggleOptionWithAction("vsyncEnabled", vsyncEnabled);
+                }
+
+                // Lowers render scale, then detail, while frames run over the target
+                bool governor = governorEnabled;
+                if (imgui_checkbox("Frame Budget Governor", &governor)) {
+                    governorEnabled = governor;
+                    toggleOptionWithAction("governorEnabled", governorEnabled);
+                }
+                if (governorEnabled) {
+                    imgui_slider_float("Target (ms)", &governorTargetMs, 4.0f, 50.0f);
+                    char governor_text[96];
+                    snprintf(governor_text, sizeof(governor_text), "Render scale %.0f%%, detail %.0f%% (level %d/%d)",
+                             getRenderScale() * 100.0f, getLODDetailScale() * 100.0f,
+                             getGovernorLevel(), getGovernorLevelCount() - 1);
+                    imgui_text(governor_text);
+                }
                 
                 if (backgroundEnabled) {
                     if (imgui_button("Change Skybox...", 150, 30)) {
@@ -1021,11 +1120,91 @@ void render_debug_window() {
             float fps = 1.0f / (float)deltaTime;
             snprintf(fps_text, sizeof(fps_text), "FPS: %.1f", fps);
             imgui_text(fps_text);
+
+            GLStateStats stateStats = getStateStats();
+            char state_text[96];
+            snprintf(state_text, sizeof(state_text),
+                     "GL state calls: %u issued, %u skipped",
+                     stateStats.issued, stateStats.skipped);
+            imgui_text(state_text);
+
+            char draw_text[96];
+            snprintf(draw_text, sizeof(draw_text),
+                     "Draw calls: %u, triangles: %u",
+                     stateStats.drawCalls, stateStats.triangles);
+            imgui_text(draw_text);
+
+            UniformBufferStats uniformStats = getUniformBufferStats();
+            char uniform_text[96];
+            snprintf(uniform_text, sizeof(uniform_text),
+                     "Uniform blocks: %u uploaded, %u unchanged",
+                     uniformStats.uploads, uniformStats.skipped);
+            imgui_text(uniform_text);
+
+            LightClusterStats clusterStats = getLightClusterStats();
+            char cluster_text[96];
+            snprintf(cluster_text, sizeof(cluster_text),
+                     "Light clusters: %d refs, max %d per cluster%s",
+                     clusterStats.indices, clusterStats.maxPerCluster, clusterStats.rebuilt ? "" : " (cached)");
+            imgui_text(cluster_text);
+
+            char scale_text[96];
+            snprintf(scale_text, sizeof(scale_text),
+                     "Render scale: %.0f%% (%dx%d), detail %.0f%%%s",
+                     getRenderScale() * 100.0f, getSceneWidth(), getSceneHeight(), getLODDetailScale() * 100.0f,
+                     governorEnabled ? ", governed" : "");
+            imgui_text(scale_text);
+
+            CullStats cull = getCullStats();
+            char cull_text[64];
+            snprintf(cull_text, sizeof(cull_text),
+                     "Frustum culling: %d/%d visible", cull.visible, cull.tested);
+            imgui_text(cull_text);
+
+            char tree_text[64];
+            snprintf(tree_text, sizeof(tree_text),
+                     "Scene tree: %d leaves, height %d", sceneTree.leafCount, getSpatialTreeHeight(&sceneTree));
+            imgui_text(tree_text);
+
+            GpuTimerStats gpuStats = getGpuTimerStats();
+            if (gpuStats.available) {
+                char gpu_text[96];
+                snprintf(gpu_text, sizeof(gpu_text),
+                         "GPU frame: %.2f ms (avg %.2f ms)", gpuStats.lastTotalMs, gpuStats.averageTotalMs);
+                imgui_text(gpu_text);
+                for (int pass = 0; pass < GPU_PASS_COUNT; pass++) {
+                    snprintf(gpu_text, sizeof(gpu_text),
+                             "  %s: %.3f ms", gpuPassNames[pass], gpuStats.averageMs[pass]);
+                    imgui_text(gpu_text);
+                }
+            }
+
+            // CPU scopes of the previous frame, indented by nesting depth
+            const ProfileNode* cpuNodes;
+            int cpuNodeCount = getProfilerSummary(&cpuNodes);
+            char cpu_text[128];
+            snprintf(cpu_text, sizeof(cpu_text), "CPU frame: %.2f ms", getProfilerFrameMs());
+            imgui_text(cpu_text);
+            for (int i = 0; i < cpuNodeCount; i++) {
+                int indent = 2 + cpuNodes[i].depth * 2;
+                if (cpuNodes[i].calls > 1) {
+                    snprintf(cpu_text, sizeof(cpu_text), "%*s%s: %.3f ms (%d calls)",
+                             indent, "", cpuNodes[i].name, cpuNodes[i].ms, cpuNodes[i].calls);
+                }
+                else {
+                    snprintf(cpu_text, sizeof(cpu_text), "%*s%s: %.3f ms",
+                             indent, "", cpuNodes[i].name, cpuNodes[i].ms);
+                }
+                imgui_text(cpu_text);
+            }
+            if (imgui_button("Save CPU trace", 0, 0)) {
+                writeChromeTrace("stellai_trace.json");
+            }
             
             // Scene stats
             char objects_text[64];
             snprintf(objects_text, sizeof(objects_text), 
-                     "Objects: %d/%d", objectManager.count, MAX_OBJECTS);
+                     "Objects: %d (capacity %d)", objectManager.count, objectManager.capacity);
             imgui_text(objects_text);
             
             char lights_text[32];
@@ -1051,6 +1230,7 @@ void render_debug_window() {
             // Selected object info
             imgui_separator();
             
+            SceneObject* selected_object = getObject(selected_handle);
             if (selected_object) {
                 imgui_text("Selected Object:");
                 
@@ -1154,6 +1334,7 @@ void render_controls_window() {
 
 // Main GUI function
 void main_gui() {
+    PROFILE_BEGIN("gui");
     // Start new ImGui frame
     imgui_new_frame();
     
@@ -1187,10 +1368,10 @@ void main_gui() {
                 redo_last_action();
             }
             imgui_separator();
-            if (imgui_menu_item("Cut", "Ctrl+X", false, selected_object != NULL)) {
+            if (imgui_menu_item("Cut", "Ctrl+X", false, getObject(selected_handle) != NULL)) {
                 cut_object();
             }
-            if (imgui_menu_item("Copy", "Ctrl+C", false, selected_object != NULL)) {
+            if (imgui_menu_item("Copy", "Ctrl+C", false, getObject(selected_handle) != NULL)) {
                 copy_object();
             }
             if (imgui_menu_item("Paste", "Ctrl+V", false, clipboard_object != NULL)) {
@@ -1200,8 +1381,8 @@ void main_gui() {
             if (imgui_menu_item("Select All", "Ctrl+A", false, false)) {
                 // Not implemented - would select all objects
             }
-            if (imgui_menu_item("Deselect", "Esc", false, selected_object != NULL)) {
-                selected_object = NULL;
+            if (imgui_menu_item("Deselect", "Esc", false, getObject(selected_handle) != NULL)) {
+                selected_handle = INVALID_OBJECT_HANDLE;
             }
             imgui_end_menu();
         }
@@ -1320,7 +1501,7 @@ void main_gui() {
     }
     
     // Show inspector window
-    if (show_inspector && selected_object != NULL) {
+    if (show_inspector && getObject(selected_handle) != NULL) {
         render_inspector_window();
     }
     
@@ -1345,6 +1526,7 @@ void main_gui() {
     
     // Render ImGui
     imgui_render();
+    PROFILE_END();
 }
 
 // Generate new frame
@@ -0,0 +1,175 @@
+// LOD chain checks. Links no GL: the bundled OBJ files are read the way the
+// importer uploads them (triangulated, one vertex per face corner, positions
+// only) and every model must still simplify into more than one level.
+//
+//   test_lod    run from the repository root; exits non-zero on failure
+
+#include "lod.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    Vector3* positions;
+    unsigned int vertexCount;
+    unsigned int* indices;
+    unsigned int indexCount;
+} TestMesh;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL: "); printf(__VA_ARGS__); printf("\n"); failures++; } \
+} while (0)
+
+static void* growArray(void* data, unsigned int* capacity, unsigned int needed, size_t elementSize) {
+    if (needed <= *capacity) return data;
+    while (*capacity < needed) *capacity = *capacity ? *capacity * 2 : 1024;
+    void* grown = realloc(data, *capacity * elementSize);
+    if (!grown) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    return grown;
+}
+
+// Faces are fanned into triangles and every corner gets its own vertex, as
+// MODEL_IMPORT_FLAGS does without JoinIdenticalVertices.
+static bool loadOBJ(const char* path, TestMesh* mesh) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    Vector3* points = NULL;
+    unsigned int pointCount = 0, pointCapacity = 0;
+    unsigned int vertexCapacity = 0, indexCapacity = 0;
+    memset(mesh, 0, sizeof(*mesh));
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == 'v' && line[1] == ' ') {
+            Vector3 p;
+            if (sscanf(line + 2, "%f %f %f", &p.x, &p.y, &p.z) != 3) continue;
+            points = growArray(points, &pointCapacity, pointCount + 1, sizeof(Vector3));
+            points[pointCount++] = p;
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            int corners[64];
+            int cornerCount = 0;
+            for (char* token = strtok(line + 2, " \t\r\n"); token && cornerCount < 64; token = strtok(NULL, " \t\r\n")) {
+                int index = atoi(token);
+                if (index < 0) index += (int)pointCount + 1;
+                if (index < 1 || index > (int)pointCount) continue;
+                corners[cornerCount++] = index - 1;
+            }
+            for (int i = 1; i + 1 < cornerCount; i++) {
+                int triangle[3] = { corners[0], corners[i], corners[i + 1] };
+                mesh->positions = growArray(mesh->positions, &vertexCapacity, mesh->vertexCount + 3, sizeof(Vector3));
+                mesh->indices = growArray(mesh->indices, &indexCapacity, mesh->indexCount + 3, sizeof(unsigned int));
+                for (int k = 0; k < 3; k++) {
+                    mesh->positions[mesh->vertexCount] = points[triangle[k]];
+                    mesh->indices[mesh->indexCount++] = mesh->vertexCount++;
+                }
+            }
+        }
+    }
+
+    fclose(file);
+    free(points);
+    return mesh->indexCount > 0;
+}
+
+static void testBundledModel(const char* path) {
+    TestMesh mesh;
+    if (!loadOBJ(path, &mesh)) {
+        CHECK(false, "could not read %s", path);
+        return;
+    }
+
+    LODChain chain;
+    buildLODChain(&mesh.indices, mesh.indexCount, mesh.positions, mesh.vertexCount, NULL, 0, &chain);
+
+    printf("%s:", path);
+    for (int i = 0; i < chain.count; i++) printf(" %u", chain.levels[i].indexCount / 3);
+    printf(" triangles\n");
+
+    CHECK(chain.count > 1, "%s kept a single level", path);
+    for (int i = 1; i < chain.count; i++) {
+        CHECK(chain.levels[i].indexCount < chain.levels[i - 1].indexCount,
+            "%s level %d is not coarser than level %d", path, i, i - 1);
+    }
+
+    free(mesh.positions);
+    free(mesh.indices);
+}
+
+// A UV sphere whose last column repeats the first with a different u, and
+// whose poles are one position per column. The copies share positions but not
+// attributes, so no triangle may end up joining the two sides of the seam.
+static void testAttributeSeam(void) {
+    enum { RINGS = 24, SEGMENTS = 48 };
+    const unsigned int columns = SEGMENTS + 1;
+    const unsigned int vertexCount = (RINGS + 1) * columns;
+    Vector3* positions = malloc(vertexCount * sizeof(Vector3));
+    float* uvs = malloc(vertexCount * 2 * sizeof(float));
+    unsigned int* indices = malloc(RINGS * SEGMENTS * 6 * sizeof(unsigned int));
+
+    for (unsigned int r = 0; r <= RINGS; r++) {
+        float theta = 3.14159265f * (float)r / RINGS;
+        for (unsigned int s = 0; s <= SEGMENTS; s++) {
+            float phi = 6.28318531f * (float)(s % SEGMENTS) / SEGMENTS;
+            unsigned int v = r * columns + s;
+            positions[v] = (Vector3){ sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+            if (r == 0 || r == RINGS) positions[v] = (Vector3){ 0.0f, r == 0 ? 1.0f : -1.0f, 0.0f };
+            uvs[v * 2] = (float)s / SEGMENTS;
+            uvs[v * 2 + 1] = (float)r / RINGS;
+        }
+    }
+
+    unsigned int indexCount = 0;
+    for (unsigned int r = 0; r < RINGS; r++) {
+        for (unsigned int s = 0; s < SEGMENTS; s++) {
+            unsigned int a = r * columns + s, b = a + columns;
+            unsigned int quad[6] = { a, b, a + 1, a + 1, b, b + 1 };
+            memcpy(indices + indexCount, quad, sizeof(quad));
+            indexCount += 6;
+        }
+    }
+
+    LODChain chain;
+    buildLODChain(&indices, indexCount, positions, vertexCount, uvs, 2, &chain);
+    CHECK(chain.count > 1, "seamed sphere kept a single level");
+
+    // A triangle straddling the seam has corners near u = 0 and u = 1
+    unsigned int stretched = 0;
+    for (int level = 1; level < chain.count; level++) {
+        const unsigned int* range = indices + chain.levels[level].indexOffset;
+        for (unsigned int i = 0; i < chain.levels[level].indexCount; i += 3) {
+            float minU = 1.0f, maxU = 0.0f;
+            for (int k = 0; k < 3; k++) {
+                float u = uvs[range[i + k] * 2];
+                if (u < minU) minU = u;
+                if (u > maxU) maxU = u;
+            }
+            if (maxU - minU > 0.5f) stretched++;
+        }
+    }
+    CHECK(stretched == 0, "%u simplified triangles stretch across the UV seam", stretched);
+
+    free(positions);
+    free(uvs);
+    free(indices);
+}
+
+int main(void) {
+    testBundledModel("resources/models/HSM0044.obj");
+    testBundledModel("resources/models/House.obj");
+    testAttributeSeam();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All LOD checks passed\n");
+    return 0;
+}